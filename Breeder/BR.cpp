@@ -133,6 +133,12 @@ void BR_CSurf_OnTrackSelection (MediaTrack* track)
 	ExecuteTrackSelAction();
 }
 
+void BR_CSurf_SetTrackListChange ()
+{
+	BR_TcpLayout::Invalidate();
+	BR_TrackItemIndex::Invalidate();
+}
+
 int BR_CSurf_Extended(int call, void* parm1, void* parm2, void* parm3)
 {
 	if (call == CSURF_EXT_RESET)
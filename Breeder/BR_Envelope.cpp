@@ -210,12 +210,13 @@ static void SetEnvPointMouseValue (COMMAND_T* ct)
 			swap(normEndPosition, normStartPosition);
 
 		// Get grid divisions
+		BR_GridSnapshot gridSnapshot;
 		vector<double> savedGridDivs;
-		double gridDivPos = GetPrevGridDiv(GetNextGridDiv(normStartPosition)); // can't just do GetPrevGrid(normStartPosition) because if grid division is right at normStartPosition we would end up with grid division before startPosition
+		double gridDivPos = gridSnapshot.GetPrevGridDiv(gridSnapshot.GetNextGridDiv(normStartPosition)); // can't just do GetPrevGrid(normStartPosition) because if grid division is right at normStartPosition we would end up with grid division before startPosition
 		while (gridDivPos < normEndPosition)
 		{
 			savedGridDivs.push_back(gridDivPos);
-			gridDivPos = GetNextGridDiv(gridDivPos);
+			gridDivPos = gridSnapshot.GetNextGridDiv(gridDivPos);
 		}
 
 		if (savedGridDivs.size() > 0)
@@ -223,7 +224,7 @@ static void SetEnvPointMouseValue (COMMAND_T* ct)
 			// Get possible start point value before deleting points (but only if there are no points between first grid division and division before it)
 			double prevPointVal = -1;
 			double prevPointPos = -1;
-			double prevGridDivPos = GetPrevGridDiv(savedGridDivs.front());
+			double prevGridDivPos = gridSnapshot.GetPrevGridDiv(savedGridDivs.front());
 			if (prevGridDivPos != savedGridDivs.front())
 			{
 				double prevTempoPosition;
@@ -240,7 +241,7 @@ static void SetEnvPointMouseValue (COMMAND_T* ct)
 			// Get possible end point value before deleting points (don't create end point if last grid division point is also last envelope point)
 			double nextPointVal = -1;
 			double nextPointPos = -1;
-			double nextGridDivPos = GetNextGridDiv(savedGridDivs.back());
+			double nextGridDivPos = gridSnapshot.GetNextGridDiv(savedGridDivs.back());
 			if (!g_envMouseEnvelope->ValidateId(g_envMouseEnvelope->Find(nextGridDivPos, GRID_DIV_DELTA)))
 			{
 				if (g_envMouseEnvelope->ValidateId(g_envMouseEnvelope->FindNext(nextGridDivPos)))
@@ -251,7 +252,7 @@ static void SetEnvPointMouseValue (COMMAND_T* ct)
 			}
 
 			// Delete all points between those grid divisions
-			g_envMouseEnvelope->DeletePointsInRange(savedGridDivs.front(), GetNextGridDiv(savedGridDivs.back()) - GRID_DIV_DELTA);
+			g_envMouseEnvelope->DeletePointsInRange(savedGridDivs.front(), gridSnapshot.GetNextGridDiv(savedGridDivs.back()) - GRID_DIV_DELTA);
 
 			// Insert grid division points
 			if (prevPointPos != -1) g_envMouseEnvelope->CreatePoint(g_envMouseEnvelope->CountPoints(), prevPointPos, prevPointVal, g_envMouseEnvelope->GetDefaultShape(), 0, false, true, true);
@@ -322,13 +323,14 @@ static void SetEnvPointMouseValue (COMMAND_T* ct)
 	// In case of tempo freehand drawing we simultaneously add/remove points and edit them (because editing tempo map makes things move and me must not allow any changes to anything in front of mouse cursor)
 	if (user == 3 && isTempo)
 	{
-		// Get grid division info
+		// Get grid division info (tempo map is edited afterwards, so snapshot is used only here)
+		BR_GridSnapshot gridSnapshot;
 		vector<pair<double,double> > savedGridDivs;
-		double gridDivPos = GetPrevGridDiv(GetNextGridDiv(startPosition)); // can't just do GetPrevGrid(startPosition) because if grid division is right at startPosition we would end up with grid division before startPosition
+		double gridDivPos = gridSnapshot.GetPrevGridDiv(gridSnapshot.GetNextGridDiv(startPosition)); // can't just do GetPrevGrid(startPosition) because if grid division is right at startPosition we would end up with grid division before startPosition
 		double prevPointBpm = -1; // if there are no points between previous grid division and first grid
 		if (gridDivPos > 0)       // division at/after mouse, insert one more point on that previous grid division
 		{
-			double prevGridDivPos = GetPrevGridDiv(gridDivPos);
+			double prevGridDivPos = gridSnapshot.GetPrevGridDiv(gridDivPos);
 			double position;
 			if (!GetTempoTimeSigMarker(NULL, FindNextTempoMarker(prevGridDivPos), &position, NULL, NULL, NULL, NULL, NULL, NULL) || position >= gridDivPos - GRID_DIV_DELTA)
 			{
@@ -343,7 +345,7 @@ static void SetEnvPointMouseValue (COMMAND_T* ct)
 		while (gridDivPos < endPosition)
 		{
 			savedGridDivs.push_back(make_pair(gridDivPos, TimeMap_timeToQN_abs(NULL, gridDivPos)));
-			gridDivPos = GetNextGridDiv(gridDivPos);
+			gridDivPos = gridSnapshot.GetNextGridDiv(gridDivPos);
 		}
 
 		// Iterate through all grid divisions and make sure points only exist on those divisions and nowhere else
@@ -954,6 +956,7 @@ void EnvPointsGrid (COMMAND_T* ct)
 		envelope.UnselectAll();
 
 	// Select/insert or save for deletion all the points satisfying criteria
+	BR_GridSnapshot gridSnapshot;
 	double grid = -1, nextGrid = -1;
 	vector<pair<int, int> > pointsToDelete; // store start and end of consequential points
 	for (int i = startId ; i <= endId; ++i)
@@ -963,8 +966,8 @@ void EnvPointsGrid (COMMAND_T* ct)
 
 		while (position > nextGrid)
 		{
-			grid     = GetNextGridDiv(position - (MAX_GRID_DIV/2));
-			nextGrid = GetNextGridDiv(grid);
+			grid     = gridSnapshot.GetNextGridDiv(position - (MAX_GRID_DIV/2));
+			nextGrid = gridSnapshot.GetNextGridDiv(grid);
 		}
 
 		bool doesPointPass = (onGrid) ? (IsEqual(position, grid, GRID_DIV_DELTA)  ||  IsEqual(position, nextGrid, GRID_DIV_DELTA))
@@ -1069,6 +1072,7 @@ void CreateEnvPointsGrid (COMMAND_T* ct)
 		endId = (envelope.ValidateId(endId)) ? (endId) : (startId);
 	}
 
+	BR_GridSnapshot gridSnapshot;
 	vector<double> position, value, bezier;
 	vector<int> shape;
 	bool doPointsBeforeFirstPoint = true;
@@ -1101,7 +1105,7 @@ void CreateEnvPointsGrid (COMMAND_T* ct)
 		while (true)
 		{
 			while (gridLine < previousGridLine + MAX_GRID_DIV)
-				gridLine = GetNextGridDiv(gridLine + (MAX_GRID_DIV/2));
+				gridLine = gridSnapshot.GetNextGridDiv(gridLine + (MAX_GRID_DIV/2));
 
 			// Make sure points are created after time selection only
 			if (gridLine >= tStart)
@@ -677,89 +677,40 @@ double BR_Envelope::ValueAtPosition (double position, bool fastMode /*= false*/)
 			return m_points[this->LastPointAtPos(nextId)].value;
 
 		// Everything else
-		double t1 = m_points[id].position;
-		double t2 = m_points[nextId].position;
-		double v1 = m_points[id].value;
-		double v2 = m_points[nextId].value;
-		if (faderMode)
-		{
-			v1 = this->NormalizedDisplayValue(v1);
-			v2 = this->NormalizedDisplayValue(v2);
-		}
-
-		double returnValue = 0;
-		switch (m_points[id].shape)
-		{
-			case SQUARE:
-			{
-				returnValue = v1;
-			}
-			break;
-
-			case LINEAR:
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue = (!m_tempoMap) ? (v1 + (v2 - v1) * t) : CalculateTempoAtPosition(v1, v2, t1, t2, position);
-			}
-			break;
-
-			case FAST_END:                                 // f(x) = x^3
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue =  v1 + (v2 - v1) * pow(t, 3);
-			}
-			break;
-
-			case FAST_START:                               // f(x) = 1 - (1 - x)^3
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue =  v1 + (v2 - v1) * (1 - pow(1-t, 3));
-			}
-			break;
+		return this->SegmentValue(id, nextId, position, faderMode);
+	}
+}
 
-			case SLOW_START_END:                           // f(x) = x^2 * (3-2x)
-			{
-				double t = (position - t1) / (t2 - t1);
-				returnValue =  v1 + (v2 - v1) * (pow(t, 2) * (3 - 2*t));
-			}
-			break;
+void BR_Envelope::ValuesInRange (double start, double step, int count, double* values)
+{
+	if (count <= 0 || !values)
+		return;
 
-			case BEZIER:
-			{
-				int id0 = (m_sorted) ? (id-1)     : (this->FindPrevious(t1, 0));
-				int id3 = (m_sorted) ? (nextId+1) : (this->FindNext(t2, 0));
-				double t0 = (!this->ValidateId(id0)) ? (t1) : (m_points[id0].position);
-				double v0 = (!this->ValidateId(id0)) ? (v1) : (m_points[id0].value);
-				double t3 = (!this->ValidateId(id3)) ? (t2) : (m_points[id3].position);
-				double v3 = (!this->ValidateId(id3)) ? (v2) : (m_points[id3].value);
-				if (faderMode)
-				{
-					v0 = this->NormalizedDisplayValue(v0);
-					v3 = this->NormalizedDisplayValue(v3);
-				}
+	// Unsorted points or walking backwards, can't do much about it
+	if (!m_sorted || step < 0)
+	{
+		for (int i = 0; i < count; ++i)
+			values[i] = this->ValueAtPosition(start + i * step, true);
+		return;
+	}
 
-				double x1, x2, y1, y2, empty;
-				LICE_Bezier_FindCardinalCtlPts(0.25, t0, t1, t2, v0, v1, v2, &empty, &x1, &empty, &y1);
-				LICE_Bezier_FindCardinalCtlPts(0.25, t1, t2, t3, v1, v2, v3, &x2, &empty, &y2, &empty);
-
-				double tension = m_points[id].bezier;
-				x1 += tension * ((tension > 0) ? (t2-x1) : (x1-t1));
-				x2 += tension * ((tension > 0) ? (t2-x2) : (x2-t1));
-				y1 -= tension * ((tension > 0) ? (y1-v1) : (v2-y1));
-				y2 -= tension * ((tension > 0) ? (y2-v1) : (v2-y2));
-
-				x1 = SetToBounds(x1, t1, t2);
-				x2 = SetToBounds(x2, t1, t2);
-				y1 = SetToBounds(y1, this->MinValueAbs(), this->MaxValueAbs());
-				y2 = SetToBounds(y2, this->MinValueAbs(), this->MaxValueAbs());
-				returnValue = LICE_CBezier_GetY(t1, x1, x2, t2, v1, y1, y2, v2, position);
-			}
-			break;
-		}
+	// Points are sorted so walk through segments forward (same as calling ValueAtPosition() with fastMode for every position)
+	bool faderMode = this->IsScaledToFader();
+	int id = this->FindPrevious(start, m_takeEnvOffset);
+	for (int i = 0; i < count; ++i)
+	{
+		double position = (start + i * step) - m_takeEnvOffset;
+		while (this->ValidateId(id + 1) && m_points[id + 1].position < position)
+			++id;
 
-		if (faderMode)
-			returnValue = this->RealValue(returnValue);
-		return returnValue;
+		if (!this->ValidateId(id))
+			values[i] = (m_points.size()) ? (m_points.front().value) : (this->LaneCenterValue());
+		else if (!this->ValidateId(id + 1))
+			values[i] = m_points[id].value;
+		else if (m_points[id + 1].position == position)
+			values[i] = m_points[this->LastPointAtPos(id + 1)].value;
+		else
+			values[i] = this->SegmentValue(id, id + 1, position, faderMode);
 	}
 }
 
@@ -1443,6 +1394,8 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 		SetConfig("envclicksegmode", envClickSegMode);
 		SetConfig("pooledenvs", pooledenvs);
 		UpdateArrange();
+		if (m_properties.changed && !m_take)
+			BR_TcpLayout::Invalidate(); // lane height or visibility could have changed track's I_WNDH
 		m_update       = false;
 		m_pointsEdited = false;
 		return true;
@@ -1450,6 +1403,94 @@ bool BR_Envelope::Commit (bool force /*=false*/)
 	return false;
 }
 
+double BR_Envelope::SegmentValue (int id, int nextId, double position, bool faderMode)
+{
+	/* no bounds checking - internal function so caller handles before calling */
+	double t1 = m_points[id].position;
+	double t2 = m_points[nextId].position;
+	double v1 = m_points[id].value;
+	double v2 = m_points[nextId].value;
+	if (faderMode)
+	{
+		v1 = this->NormalizedDisplayValue(v1);
+		v2 = this->NormalizedDisplayValue(v2);
+	}
+
+	double returnValue = 0;
+	switch (m_points[id].shape)
+	{
+		case SQUARE:
+		{
+			returnValue = v1;
+		}
+		break;
+
+		case LINEAR:
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue = (!m_tempoMap) ? (v1 + (v2 - v1) * t) : CalculateTempoAtPosition(v1, v2, t1, t2, position);
+		}
+		break;
+
+		case FAST_END:                                 // f(x) = x^3
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue =  v1 + (v2 - v1) * pow(t, 3);
+		}
+		break;
+
+		case FAST_START:                               // f(x) = 1 - (1 - x)^3
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue =  v1 + (v2 - v1) * (1 - pow(1-t, 3));
+		}
+		break;
+
+		case SLOW_START_END:                           // f(x) = x^2 * (3-2x)
+		{
+			double t = (position - t1) / (t2 - t1);
+			returnValue =  v1 + (v2 - v1) * (pow(t, 2) * (3 - 2*t));
+		}
+		break;
+
+		case BEZIER:
+		{
+			int id0 = (m_sorted) ? (id-1)     : (this->FindPrevious(t1, 0));
+			int id3 = (m_sorted) ? (nextId+1) : (this->FindNext(t2, 0));
+			double t0 = (!this->ValidateId(id0)) ? (t1) : (m_points[id0].position);
+			double v0 = (!this->ValidateId(id0)) ? (v1) : (m_points[id0].value);
+			double t3 = (!this->ValidateId(id3)) ? (t2) : (m_points[id3].position);
+			double v3 = (!this->ValidateId(id3)) ? (v2) : (m_points[id3].value);
+			if (faderMode)
+			{
+				v0 = this->NormalizedDisplayValue(v0);
+				v3 = this->NormalizedDisplayValue(v3);
+			}
+
+			double x1, x2, y1, y2, empty;
+			LICE_Bezier_FindCardinalCtlPts(0.25, t0, t1, t2, v0, v1, v2, &empty, &x1, &empty, &y1);
+			LICE_Bezier_FindCardinalCtlPts(0.25, t1, t2, t3, v1, v2, v3, &x2, &empty, &y2, &empty);
+
+			double tension = m_points[id].bezier;
+			x1 += tension * ((tension > 0) ? (t2-x1) : (x1-t1));
+			x2 += tension * ((tension > 0) ? (t2-x2) : (x2-t1));
+			y1 -= tension * ((tension > 0) ? (y1-v1) : (v2-y1));
+			y2 -= tension * ((tension > 0) ? (y2-v1) : (v2-y2));
+
+			x1 = SetToBounds(x1, t1, t2);
+			x2 = SetToBounds(x2, t1, t2);
+			y1 = SetToBounds(y1, this->MinValueAbs(), this->MaxValueAbs());
+			y2 = SetToBounds(y2, this->MinValueAbs(), this->MaxValueAbs());
+			returnValue = LICE_CBezier_GetY(t1, x1, x2, t2, v1, y1, y2, v2, position);
+		}
+		break;
+	}
+
+	if (faderMode)
+		returnValue = this->RealValue(returnValue);
+	return returnValue;
+}
+
 int BR_Envelope::FindFirstPoint ()
 {
 	if (m_points.empty())
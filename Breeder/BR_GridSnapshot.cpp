@@ -0,0 +1,237 @@
+/******************************************************************************
+/ BR_GridSnapshot.cpp
+/
+/ Copyright (c) 2013-2015 Dominik Martin Drzic
+/ http://forum.cockos.com/member.php?u=27094
+/ http://github.com/reaper-oss/sws
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+#include "stdafx.h"
+#include "BR_GridSnapshot.h"
+
+/******************************************************************************
+* Grid snapshot                                                               *
+******************************************************************************/
+double BR_GridSnapshot::GetGridDiv ()
+{
+	return m_gridDiv;
+}
+
+double BR_GridSnapshot::GetNextGridDiv (double position)
+{
+	/* This got a tiny bit complicated, but we're trying to replicate        *
+	*  REAPER behavior as closely as possible...I guess the ultimate test    *
+	*  would be inserting a bunch of really strange time signatures coupled  *
+	*  with possibly even stranger grid divisions, things any sane person    *
+	*  would never use - like 11/7 with grid division of 2/13...haha. As it  *
+	*  stands now, at REAPER v4.7, this function handles it all              */
+
+	if (position < 0)
+		return 0;
+
+	double nextGridPosition = position;
+
+	if (m_gridFrame > 0)
+	{
+		nextGridPosition = this->GetNextFrame(position);
+	}
+	else
+	{
+		// Grid dividing starts again from the measure in which tempo marker is so find location of first measure grid (obvious if grid division spans more measures)
+		int gridDivStartTempo = this->FindPreviousTempoMarker(position);
+		TempoMarker* gridDivStartInfo;
+		if (gridDivStartTempo >= 0)
+		{
+			if (gridDivStartTempo + 1 < m_tempoCount && this->GetTempoMarker(gridDivStartTempo + 1, false).position <= position)
+				gridDivStartTempo += 1;
+			gridDivStartInfo = &this->GetTempoMarker(gridDivStartTempo, true);
+		}
+		else
+		{
+			if (!m_projStart.timeSigLoaded)
+			{
+				this->ReadTimeSig(0, &m_projStart.timeSigMeasure, &m_projStart.num, &m_projStart.den);
+				m_projStart.timeSigLoaded = true;
+			}
+			gridDivStartInfo = &m_projStart;
+			gridDivStartTempo = 0; // if position is right at project start this would be -1 even if first tempo marker exists
+		}
+
+		// Get grid division translated into current time signature
+		int gridDivStartMeasure = gridDivStartInfo->timeSigMeasure;
+		int num                 = gridDivStartInfo->num;
+		int den                 = gridDivStartInfo->den;
+		double gridDiv = (den*m_gridDiv) / 4;
+
+		// How much measures must pass for grid diving to start anew? (again, obvious when grid division spans more measures)
+		int measureStep = (int)(gridDiv/num);
+		if (measureStep == 0) measureStep = 1;
+
+		// Find closest measure to our position, where grid diving starts again
+		int positionMeasure = this->ReadMeasure(position);
+		gridDivStartMeasure += (int)((positionMeasure - gridDivStartMeasure) / measureStep) * measureStep;
+
+		// Finally find next grid position (different cases for measures and beats)
+		if (gridDiv > num)
+		{
+			int gridDivEndMeasure = gridDivStartMeasure + measureStep;
+			double gridDivEnd = this->GetMeasureStart(gridDivEndMeasure);
+
+			// Same as before, existing tempo markers can move end measure grid (where our next grid should be) so find if that's the case
+			if (measureStep > 1)
+			{
+				while (++gridDivStartTempo < m_tempoCount && this->GetTempoMarker(gridDivStartTempo, false).position <= gridDivEnd)
+				{
+					int currentMeasure = this->GetTempoMarker(gridDivStartTempo, true).timeSigMeasure;
+
+					gridDivEndMeasure = currentMeasure + ((currentMeasure == positionMeasure) ? (measureStep) : (0));
+					gridDivEnd = this->GetMeasureStart(gridDivEndMeasure);
+				}
+			}
+
+			nextGridPosition = gridDivEnd;
+		}
+		else
+		{
+			double positionBeats = this->ReadFullBeats(position) - this->GetMeasureStartBeats(gridDivStartMeasure);
+			double nextGridBeats = (int)((positionBeats + gridDiv) / gridDiv) * gridDiv;
+			while (abs(nextGridBeats - positionBeats) < 1E-6) nextGridBeats += gridDiv; // rounding errors, yuck...
+
+			nextGridPosition = this->ReadTime(nextGridBeats, gridDivStartMeasure);
+
+			// Check it didn't pass over into next measure
+			double gridDivEnd = this->GetMeasureStart(gridDivStartMeasure + measureStep);
+			if (nextGridPosition > gridDivEnd)
+				nextGridPosition = gridDivEnd;
+		}
+
+		// Not so perfect fix for this issue: http://forum.cockos.com/project.php?issueid=5263
+		if (nextGridPosition < position)
+		{
+			TempoMarker& marker = this->GetTempoMarker(gridDivStartTempo, false);
+			double offset =  m_gridDiv - fmod(this->TimeToQN(this->GetMeasureStart(marker.measure), false), m_gridDiv);
+
+			double gridLn = this->TimeToQN(marker.position, false);
+			gridLn = this->QNToTime(gridLn - offset - fmod(gridLn, m_gridDiv), false);
+			while (gridLn < position + (MIN_GRID_DIST/2))
+				gridLn = this->QNToTime(this->TimeToQN(gridLn, false) + m_gridDiv, false);
+
+			nextGridPosition = gridLn;
+		}
+	}
+
+	return nextGridPosition;
+}
+
+double BR_GridSnapshot::GetPrevGridDiv (double position)
+{
+	if (position <= 0)
+		return 0;
+
+	double prevGridDivPos = position;
+
+	if (m_gridFrame > 0)
+	{
+		prevGridDivPos = this->GetPrevFrame(position);
+	}
+	else
+	{
+		// GetNextGridDiv is complicated enough, so let's not reinvent it here but reuse it (while less efficient than the real deal, it's really not that slower since GetNextGridDiv() is quite optimized)
+		prevGridDivPos = this->QNToTime(this->TimeToQN(position, true) - 1.5*m_gridDiv, true);
+		while (true)
+		{
+			double tmp = this->GetNextGridDiv(prevGridDivPos);
+			if (tmp >= position)
+				break;
+			else
+				prevGridDivPos = tmp;
+		}
+	}
+	return prevGridDivPos;
+}
+
+double BR_GridSnapshot::GetClosestGridDiv (double position)
+{
+	double gridDiv = 0;
+	if (position > 0)
+	{
+		double prevGridDiv = this->GetPrevGridDiv(position);
+		double nextGridDiv = this->GetNextGridDiv(prevGridDiv);
+		gridDiv = (abs(prevGridDiv - position) <= abs(nextGridDiv - position)) ? (prevGridDiv) : (nextGridDiv);
+	}
+	return gridDiv;
+}
+
+BR_GridSnapshot::TempoMarker& BR_GridSnapshot::GetTempoMarker (int id, bool timeSig)
+{
+	if (id < 0 || id >= m_tempoCount)
+		return m_projStart; // invalid id, don't care much about what we return
+
+	TempoMarker& marker = m_tempoMarkers[id];
+	if (!marker.loaded)
+	{
+		this->ReadTempoMarker(id, &marker.position, &marker.measure);
+		marker.loaded = true;
+	}
+	if (timeSig && !marker.timeSigLoaded)
+	{
+		this->ReadTimeSig(marker.position, &marker.timeSigMeasure, &marker.num, &marker.den);
+		marker.timeSigLoaded = true;
+	}
+	return marker;
+}
+
+int BR_GridSnapshot::FindPreviousTempoMarker (double position)
+{
+	int first = 0;
+	int last = m_tempoCount;
+
+	while (first != last)
+	{
+		int mid = (first + last) / 2;
+		if (this->GetTempoMarker(mid, false).position < position) first = mid + 1;
+		else                                                      last  = mid;
+	}
+	return first - 1;
+}
+
+double BR_GridSnapshot::GetMeasureStart (int measure)
+{
+	map<int,double>::iterator it = m_measureStarts.find(measure);
+	if (it != m_measureStarts.end())
+		return it->second;
+
+	double position = this->ReadTime(0, measure);
+	m_measureStarts[measure] = position;
+	return position;
+}
+
+double BR_GridSnapshot::GetMeasureStartBeats (int measure)
+{
+	map<int,double>::iterator it = m_measureStartBeats.find(measure);
+	if (it != m_measureStartBeats.end())
+		return it->second;
+
+	double beats = this->ReadFullBeats(this->GetMeasureStart(measure));
+	m_measureStartBeats[measure] = beats;
+	return beats;
+}
@@ -0,0 +1,83 @@
+/******************************************************************************
+/ BR_GridSnapshot.h
+/
+/ Copyright (c) 2013-2015 Dominik Martin Drzic
+/ http://forum.cockos.com/member.php?u=27094
+/ http://github.com/reaper-oss/sws
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+#pragma once
+
+/******************************************************************************
+* Constants                                                                   *
+******************************************************************************/
+const double MIN_GRID_DIST = 0.00097;         // 1/256 at 960 BPM (can't set it to more than 1/256 in grid settings, (other actions like Adjust grid can, but things get broken then)
+const double MAX_GRID_DIV  = 1.0 / 256.0 * 4; // 1/256 because things can get broken after that (http://forum.cockos.com/project.php?issueid=5263)
+
+/******************************************************************************
+* Grid snapshot                                                               *
+******************************************************************************/
+// Grid settings and tempo map as they were at construction: tempo markers and measure
+// starts are read once and reused, so construct one per operation that walks the grid
+// (results are the same as with GetNextGridDiv() etc. as long as tempo map and grid don't
+// change during snapshot's lifetime)
+class BR_GridSnapshot
+{
+public:
+	BR_GridSnapshot ();
+	double GetGridDiv ();
+	double GetNextGridDiv (double position);
+	double GetPrevGridDiv (double position);
+	double GetClosestGridDiv (double position);
+
+private:
+	struct TempoMarker
+	{
+		double position;
+		int measure, timeSigMeasure, num, den; // timeSig*: time signature at marker's position
+		bool loaded, timeSigLoaded;
+		TempoMarker () : position(0), measure(0), timeSigMeasure(0), num(4), den(4), loaded(false), timeSigLoaded(false) {}
+	};
+	TempoMarker& GetTempoMarker (int id, bool timeSig);
+	int FindPreviousTempoMarker (double position);
+	double GetMeasureStart (int measure);
+	double GetMeasureStartBeats (int measure);
+
+	/* Project access - these are the only REAPER calls snapshot makes (see BR_Util.cpp), *
+	*  the rest doesn't depend on REAPER so it can be tested against a mock tempo map    */
+	double GetNextFrame (double position);
+	double GetPrevFrame (double position);
+	void ReadTempoMarker (int id, double* position, int* measure);
+	void ReadTimeSig (double position, int* measure, int* num, int* den);
+	int ReadMeasure (double position);
+	double ReadFullBeats (double position);
+	double ReadTime (double beats, int measure); // beats counted from measure start
+	double TimeToQN (double position, bool abs);
+	double QNToTime (double qn, bool abs);
+
+	int m_gridFrame;
+	double m_gridDiv;
+	int m_tempoCount;
+	vector<TempoMarker> m_tempoMarkers; // loaded on demand
+	TempoMarker m_projStart;            // time signature at project start
+	map<int,double> m_measureStarts, m_measureStartBeats;
+};
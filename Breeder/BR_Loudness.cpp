@@ -33,8 +33,20 @@
 #include "../SnM/SnM_Util.h"
 #include "../SnM/SnM.h"
 #include "../libebur128/ebur128.h"
+#include "../Utility/Base64.h"
 #include "../reaper/localize.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define BR_LOUDNESS_SSE2
+#endif
+
+#ifdef _WIN32
+	#include <sys/utime.h>
+#else
+	#include <utime.h>
+#endif
+
 /******************************************************************************
 * Constants                                                                   *
 ******************************************************************************/
@@ -48,6 +60,11 @@ const char* const PROJ_OBJECT_KEY_MEASUREMENTS = "MEASUREMENTS";
 const char* const PROJ_OBJECT_KEY_STATUS       = "STATUS";
 const char* const PROJ_OBJECT_KEY_SHORT_TERM   = "PT_SHORT_TERM";
 const char* const PROJ_OBJECT_KEY_MOMENTARY    = "PT_MOMENTARY";
+const char* const PROJ_OBJECT_KEY_SHORT_TERM_F = "PT_SHORT_TERM_F32";
+const char* const PROJ_OBJECT_KEY_MOMENTARY_F  = "PT_MOMENTARY_F32";
+
+const char* const LOUDNESS_CACHE_PATH          = "%s/SWS_LoudnessCache";
+const char* const LOUDNESS_CACHE_FILE          = "%s/SWS_LoudnessCache/%s.bin";
 
 const char* const LOUDNESS_KEY         = "BR - AnalyzeLoudness";
 const char* const LOUDNESS_WND         = "BR - AnalyzeLoudness WndPos" ;
@@ -62,6 +79,14 @@ const char* const EXPORT_FORMAT_RECENT = "BR - LoudnessExportFormat_Pattern_";
 
 const int EXPORT_FORMAT_RECENT_MAX      = 10;
 const int VERSION                       = 1;
+const int PACKED_VALUES_LINE_LEN        = 256; // base64 chars per project line (multiple of 4 so lines can be concatenated back)
+const int CACHE_VERSION                 = 2;                // 2: curves stored as float32
+const int CACHE_MAX_SIZE                = 64 * 1024 * 1024; // bytes, least recently used entries get removed after that
+
+// Loudness cache entry flags
+const int CACHE_INTEGRATED_ONLY         = 1;
+const int CACHE_TRUE_PEAK_ANALYZED      = 2;
+const int CACHE_HIGH_PRECISION          = 4;
 
 // Export format wildcards
 static const struct
@@ -178,6 +203,194 @@ SNM_WindowManager<BR_AnalyzeLoudnessWnd>                              g_loudness
 static SWSProjConfig<WDL_PtrList_DeleteOnDestroy<BR_LoudnessObject> > g_analyzedObjects; // no WDL_PtrList_DOD here (abort analysis)
 static HWND                                                           g_normalizeWnd = NULL;
 
+/******************************************************************************
+* Analysis helpers                                                            *
+******************************************************************************/
+static void MultiplySamples (double* samples, const double* gain, int count)
+{
+	int i = 0;
+#ifdef BR_LOUDNESS_SSE2
+	for (; i + 1 < count; i += 2)
+		_mm_storeu_pd(samples + i, _mm_mul_pd(_mm_loadu_pd(samples + i), _mm_loadu_pd(gain + i)));
+#endif
+	for (; i < count; ++i)
+		samples[i] *= gain[i];
+}
+
+static void MultiplyByEnvelope (BR_Envelope& envelope, double position, double step, int frames, double* gain, vector<double>& envValues)
+{
+	// Evaluate the whole block in one walk through envelope segments (caller keeps envValues around so it doesn't get reallocated for every block)
+	if (frames <= 0)
+		return;
+	envValues.resize(frames);
+	envelope.ValuesInRange(position, step, frames, &envValues[0]);
+	MultiplySamples(gain, &envValues[0], frames);
+}
+
+/******************************************************************************
+* Project state helpers                                                       *
+******************************************************************************/
+static void PackValues (const vector<double>& values, unsigned char* p)
+{
+	// Little-endian float32, p must hold 4 bytes per value
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		union { float f; unsigned int i; } value;
+		value.f = (float)values[i];
+		*p++ = (unsigned char)(value.i);
+		*p++ = (unsigned char)(value.i >> 8);
+		*p++ = (unsigned char)(value.i >> 16);
+		*p++ = (unsigned char)(value.i >> 24);
+	}
+}
+
+static void UnpackValues (const unsigned char* p, vector<double>& values)
+{
+	// Reads values.size() values written by PackValues()
+	for (size_t i = 0; i < values.size(); ++i, p += 4)
+	{
+		union { float f; unsigned int i; } value;
+		value.i = (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+		values[i] = value.f;
+	}
+}
+
+static void SavePackedValues (ProjectStateContext* ctx, const char* key, const vector<double>& values)
+{
+	// Values are stored as little-endian float32 encoded in base64 and split into lines of fixed length. Compared to
+	// writing them with %lf this takes less than half the space and loading doesn't have to tokenize every value
+	if (values.empty())
+		return;
+
+	WDL_TypedBuf<unsigned char> packed;
+	PackValues(values, packed.Resize((int)values.size() * 4, false));
+
+	Base64 base64;
+	const char* encoded = base64.Encode((const char*)packed.Get(), packed.GetSize());
+	int len = (int)strlen(encoded);
+	for (int i = 0; i < len; i += PACKED_VALUES_LINE_LEN)
+		ctx->AddLine("%s %.*s", key, SetToBounds(len - i, 0, PACKED_VALUES_LINE_LEN), encoded + i);
+}
+
+static bool ReadPackedValuesLine (const char* line, const char* key, WDL_FastString* encoded)
+{
+	// Appends base64 data to encoded if the line belongs to key (whitespace before key, as indented by some contexts, is skipped)
+	while (*line == ' ' || *line == '\t')
+		++line;
+
+	size_t keyLen = strlen(key);
+	if (strncmp(line, key, keyLen) || line[keyLen] != ' ')
+		return false;
+
+	line += keyLen + 1;
+	int len = (int)strlen(line);
+	while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == '\n' || line[len - 1] == ' '))
+		--len;
+	encoded->Append(line, len);
+	return true;
+}
+
+static void RestorePackedValues (const WDL_FastString& encoded, vector<double>& values)
+{
+	if (!encoded.GetLength())
+		return;
+
+	Base64 base64;
+	int size = 0;
+	const unsigned char* p = (const unsigned char*)base64.Decode(encoded.Get(), &size);
+	if (!p)
+		return;
+
+	values.resize(size / 4);
+	UnpackValues(p, values);
+}
+
+static void RestoreTextValues (LineParser& lp, vector<double>& values)
+{
+	// Projects saved by older versions: up to 10 values per line written with %lf
+	for (int i = 1; i < lp.getnumtokens(); ++i)
+		values.push_back(lp.gettoken_float(i));
+}
+
+/******************************************************************************
+* Loudness cache helpers                                                      *
+******************************************************************************/
+struct BR_LoudnessCacheFile
+{
+	WDL_FastString fn;
+	long long size;
+	time_t lastUse;
+	bool operator< (const BR_LoudnessCacheFile& file) const { return lastUse < file.lastUse; }
+};
+
+static void AppendCacheKeyEnvelope (WDL_FastString& state, BR_Envelope& envelope, double itemPos)
+{
+	// Take envelope points use project time, hash them relative to item so moving the item doesn't invalidate the cache
+	state.AppendFormatted(128, " ENV %d %d", envelope.IsActive(), envelope.CountPoints());
+	for (int i = 0; i < envelope.CountPoints(); ++i)
+	{
+		double position, value, bezier; int shape;
+		envelope.GetPoint(i, &position, &value, &shape, &bezier);
+		state.AppendFormatted(128, " %.14g %.14g %d %.14g", position - itemPos, value, shape, bezier);
+	}
+}
+
+static bool TouchLoudnessCacheFile (const char* fn)
+{
+	#ifdef _WIN32
+		wchar_t wfn[SNM_MAX_PATH];
+		if (!MultiByteToWideChar(CP_UTF8, 0, fn, -1, wfn, SNM_MAX_PATH))
+			return false;
+		return _wutime(wfn, NULL) == 0;
+	#else
+		return utime(fn, NULL) == 0;
+	#endif
+}
+
+static void TrimLoudnessCache (const char* path)
+{
+	// Cache files get touched on every hit so modification time tells when they were last used, remove the
+	// least recently used ones until the cache fits in CACHE_MAX_SIZE. Called from analysis threads, so only
+	// one of them scans and deletes at a time
+	static SWS_Mutex s_mutex;
+	SWS_SectionLock lock(&s_mutex);
+
+	vector<BR_LoudnessCacheFile> files;
+	long long totalSize = 0;
+
+	WDL_DirScan dir;
+	if (!dir.First(path))
+	{
+		do
+		{
+			if (dir.GetCurrentIsDirectory())
+				continue;
+
+			BR_LoudnessCacheFile file;
+			dir.GetCurrentFullFN(&file.fn);
+			struct stat s;
+			if (statUTF8(file.fn.Get(), &s) == 0)
+			{
+				file.size    = (long long)s.st_size;
+				file.lastUse = s.st_mtime;
+				totalSize += file.size;
+				files.push_back(file);
+			}
+		}
+		while (!dir.Next());
+	}
+
+	if (totalSize <= CACHE_MAX_SIZE)
+		return;
+
+	std::sort(files.begin(), files.end());
+	for (size_t i = 0; i < files.size() && totalSize > CACHE_MAX_SIZE; ++i)
+	{
+		if (SNM_DeleteFile(files[i].fn.Get(), false))
+			totalSize -= files[i].size;
+	}
+}
+
 /******************************************************************************
 * Loudness object                                                             *
 ******************************************************************************/
@@ -270,6 +483,13 @@ bool BR_LoudnessObject::Analyze (bool integratedOnly, bool doTruePeak, bool doHi
 		if (analyzed && doTruePeak && !this->GetTruePeakAnalyzeStatus())
 			analyzed = false;
 
+		if (!analyzed && this->LoadFromCache(integratedOnly, doTruePeak, doHighPrecisionMode))
+		{
+			this->SetRunning(false);
+			this->SetProgress(1);
+			analyzed = true;
+		}
+
 		if (!analyzed)
 		{
 			this->SetRunning(true);
@@ -434,36 +654,8 @@ void BR_LoudnessObject::SaveObject (ProjectStateContext* ctx)
 		ctx->AddLine("%s %lf %lf %lf %lf %lf %lf", PROJ_OBJECT_KEY_MEASUREMENTS, integrated, range, truePeak, truePeakPos, shortTermMax, momentaryMax);
 		ctx->AddLine("%s %d %d %d %d %d %d", PROJ_OBJECT_KEY_STATUS, this->GetDoTruePeak(), this->GetTruePeakAnalyzeStatus(), this->GetAnalyzedStatus(), this->GetIntegratedOnly(), VERSION, this->GetDoHighPrecisionMode());
 
-		int count = 0;
-		WDL_FastString string;
-
-		for (size_t i = 0; i < shortTermValues.size(); ++i)
-		{
-			string.AppendFormatted(512, " %lf", shortTermValues[i]);
-			++count;
-
-			if (count == 10 || i == shortTermValues.size() - 1)
-			{
-				ctx->AddLine("%s %s", PROJ_OBJECT_KEY_SHORT_TERM, string.Get());
-				string.DeleteSub(0, string.GetLength());
-				count = 0;
-			}
-		}
-
-		count = 0;
-		string.DeleteSub(0, string.GetLength());
-		for (size_t i = 0; i < momentaryValues.size(); ++i)
-		{
-			string.AppendFormatted(512, " %lf", momentaryValues[i]);
-			++count;
-
-			if (count == 10 || i == momentaryValues.size() - 1)
-			{
-				ctx->AddLine("%s %s", PROJ_OBJECT_KEY_MOMENTARY, string.Get());
-				string.DeleteSub(0, string.GetLength());
-				count = 0;
-			}
-		}
+		SavePackedValues(ctx, PROJ_OBJECT_KEY_SHORT_TERM_F, shortTermValues);
+		SavePackedValues(ctx, PROJ_OBJECT_KEY_MOMENTARY_F,  momentaryValues);
 		ctx->AddLine(">");
 	}
 }
@@ -481,11 +673,18 @@ bool BR_LoudnessObject::RestoreObject (ProjectStateContext* ctx)
 	double momentaryMax = NEGATIVE_INF;
 	vector<double> shortTermValues;
 	vector<double> momentaryValues;
+	WDL_FastString shortTermPacked, momentaryPacked;
 
-	char line[256];
+	char line[512];
 	LineParser lp(false);
-	while(!ctx->GetLine(line, sizeof(line)) && !lp.parse(line))
+	while(!ctx->GetLine(line, sizeof(line)))
 	{
+		// Check for packed curves first so they don't go through LineParser
+		if (ReadPackedValuesLine(line, PROJ_OBJECT_KEY_SHORT_TERM_F, &shortTermPacked)) continue;
+		if (ReadPackedValuesLine(line, PROJ_OBJECT_KEY_MOMENTARY_F,  &momentaryPacked)) continue;
+
+		if (lp.parse(line))
+			break;
 		if (!strcmp(lp.gettoken_str(0), ">"))
 			break;
 
@@ -517,31 +716,15 @@ bool BR_LoudnessObject::RestoreObject (ProjectStateContext* ctx)
 		}
 		else if (!strcmp(lp.gettoken_str(0), PROJ_OBJECT_KEY_SHORT_TERM))
 		{
-			if (lp.getnumtokens() > 1)  shortTermValues.push_back(lp.gettoken_float(1));
-			if (lp.getnumtokens() > 2)  shortTermValues.push_back(lp.gettoken_float(2));
-			if (lp.getnumtokens() > 3)  shortTermValues.push_back(lp.gettoken_float(3));
-			if (lp.getnumtokens() > 4)  shortTermValues.push_back(lp.gettoken_float(4));
-			if (lp.getnumtokens() > 5)  shortTermValues.push_back(lp.gettoken_float(5));
-			if (lp.getnumtokens() > 6)  shortTermValues.push_back(lp.gettoken_float(6));
-			if (lp.getnumtokens() > 7)  shortTermValues.push_back(lp.gettoken_float(7));
-			if (lp.getnumtokens() > 8)  shortTermValues.push_back(lp.gettoken_float(8));
-			if (lp.getnumtokens() > 9)  shortTermValues.push_back(lp.gettoken_float(9));
-			if (lp.getnumtokens() > 10) shortTermValues.push_back(lp.gettoken_float(10));
+			RestoreTextValues(lp, shortTermValues);
 		}
 		else if (!strcmp(lp.gettoken_str(0), PROJ_OBJECT_KEY_MOMENTARY))
 		{
-			if (lp.getnumtokens() > 1)  momentaryValues.push_back(lp.gettoken_float(1));
-			if (lp.getnumtokens() > 2)  momentaryValues.push_back(lp.gettoken_float(2));
-			if (lp.getnumtokens() > 3)  momentaryValues.push_back(lp.gettoken_float(3));
-			if (lp.getnumtokens() > 4)  momentaryValues.push_back(lp.gettoken_float(4));
-			if (lp.getnumtokens() > 5)  momentaryValues.push_back(lp.gettoken_float(5));
-			if (lp.getnumtokens() > 6)  momentaryValues.push_back(lp.gettoken_float(6));
-			if (lp.getnumtokens() > 7)  momentaryValues.push_back(lp.gettoken_float(7));
-			if (lp.getnumtokens() > 8)  momentaryValues.push_back(lp.gettoken_float(8));
-			if (lp.getnumtokens() > 9)  momentaryValues.push_back(lp.gettoken_float(9));
-			if (lp.getnumtokens() > 10) momentaryValues.push_back(lp.gettoken_float(10));
+			RestoreTextValues(lp, momentaryValues);
 		}
 	}
+	RestorePackedValues(shortTermPacked, shortTermValues);
+	RestorePackedValues(momentaryPacked, momentaryValues);
 	this->SetAnalyzeData(integrated, range, truePeak, truePeakPos, shortTermMax, momentaryMax, shortTermValues, momentaryValues);
 
 	if (this->IsTargetValid())
@@ -1069,6 +1252,25 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 	int processedSamples = 0;
 	double sampleTimeLen = 1.0 / data.samplerate; // NF fix: 1 / data.samplerate (int / int) always resulted in 0.0
 	double currentTime   = data.audioStart;
+
+	// Volume and pan correction gain curves (pan gain is per channel, takes have no pan law!)
+	vector<double> frameGain, sampleGain, envValues;
+	vector<double> channelGain(data.channels, 1.0);
+	if (doPan)
+	{
+		for (int ch = 0; ch < data.channels; ++ch)
+		{
+			if      (data.pan > 0 && ch % 2 == 0) channelGain[ch] = 1 - data.pan;
+			else if (data.pan < 0 && ch % 2 == 1) channelGain[ch] = 1 + data.pan;
+		}
+	}
+
+	// Samples are read from the accessor in big chunks (reused between reads) and then fed to ebur128 in momentary/short-term sized blocks
+	vector<double> readBuf;
+	int readAheadCount = sampleCount * refreshRateinHz * 5; // 5 s
+	int readCount      = 0;
+	int readOffset     = 0;
+
 	int i = 0;
 	int momentaryFilled = 1;
 	while (currentTime < data.audioEnd && !_this->GetKillFlag())
@@ -1083,8 +1285,17 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 		}
 
 		// Get new 200 ms (10 ms in high precision mode) of samples
-		double* buf = new double[bufSz];
-		GetAudioAccessorSamples(data.audio, data.samplerate, data.channels, currentTime, sampleCount, buf);
+		if (readOffset + sampleCount > readCount)
+		{
+			int remainingCount = (int)(data.samplerate * (data.audioEnd - currentTime));
+			readCount  = SetToBounds(remainingCount, sampleCount, readAheadCount);
+			readOffset = 0;
+
+			readBuf.resize(readCount * data.channels + 1);
+			GetAudioAccessorSamples(data.audio, data.samplerate, data.channels, currentTime, readCount, &readBuf[0]);
+		}
+		double* buf = &readBuf[0] + readOffset * data.channels;
+		readOffset += sampleCount;
 
 		if (correctForVolAndPanVolEnvs)
 		{
@@ -1100,49 +1311,27 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 			}
 		
 			// Correct for volume and pan/volume envelopes
-			int currentChannel = 1;
-			double sampleTime = currentTime;
-
-			for (int j = 0; j < nrSamplesToCorrect; ++j)
+			int framesToCorrect = (nrSamplesToCorrect + data.channels - 1) / data.channels;
+			if (framesToCorrect > 0)
 			{
-				double adjust = 1;
-
-				// Volume envelopes
-				if (doVolPreFXEnv) adjust *= data.volEnvPreFX.ValueAtPosition(sampleTime, true);
-				
-				if (doVolEnv) 
+				// Volume fader and envelopes (per frame)
+				frameGain.assign(framesToCorrect, data.volume);
+				if (doVolPreFXEnv) MultiplyByEnvelope(data.volEnvPreFX, currentTime, sampleTimeLen, framesToCorrect, &frameGain[0], envValues);
+				if (doVolEnv)      MultiplyByEnvelope(data.volEnv, (_this->m_track) ? currentTime : currentTime + itemPos, sampleTimeLen, framesToCorrect, &frameGain[0], envValues);
+
+				// Pan fader (per channel)
+				sampleGain.resize(framesToCorrect * data.channels);
+				for (int j = 0; j < framesToCorrect; ++j)
 				{
-					if (_this->m_track)
-						adjust *= data.volEnv.ValueAtPosition(sampleTime, true);
-					else
-						adjust *= data.volEnv.ValueAtPosition(sampleTime + itemPos, true);
+					for (int ch = 0; ch < data.channels; ++ch)
+						sampleGain[j * data.channels + ch] = frameGain[j] * channelGain[ch];
 				}
 
-				// Volume fader
-				adjust *= data.volume;
-
-				// Pan fader (takes only)
-				if (doPan)
-				{
-					if (data.pan > 0 && (currentChannel % 2 == 1))
-						adjust *= 1 - data.pan;                         // takes have no pan law!
-					else if (data.pan < 0 && (currentChannel % 2 == 0))
-						adjust *= 1 + data.pan;
-				}
-
-				buf[j] *= adjust;
-
-				if (++currentChannel > data.channels)
-					currentChannel = 1;
-
-				double nextSampleTime = (currentChannel + 1 > data.channels) ? (sampleTime + sampleTimeLen) : (-1);
-				if (nextSampleTime != -1)
-					sampleTime = nextSampleTime;
+				MultiplySamples(buf, &sampleGain[0], nrSamplesToCorrect);
 			}
 		}
 
 		ebur128_add_frames_double(loudnessState, buf, sampleCount);
-		delete[] buf;
 
 		if (!integratedOnly && !skipIntervals)
 		{
@@ -1224,10 +1413,11 @@ unsigned WINAPI BR_LoudnessObject::AnalyzeData (void* loudnessObject)
 	if (!_this->GetKillFlag())
 	{
 		_this->SetAnalyzeData(integrated, range, truePeak, truePeakPos, shortTermMax, momentaryMax, shortTermValues, momentaryValues);
-		_this->SetProgress(1);
-		_this->SetRunning(false);
 		if (!integratedOnly)
 			_this->SetAnalyzedStatus(true);
+		_this->SaveToCache();
+		_this->SetProgress(1);
+		_this->SetRunning(false);
 	}
 
 	return 0;
@@ -1294,6 +1484,7 @@ int BR_LoudnessObject::CheckSetAudioData ()
 		audioData.pan          = pan;
 		audioData.volEnv       = volEnv;
 		audioData.volEnvPreFX  = volEnvPreFX;
+		this->GetCacheKey(audioData, audioData.cacheKey);
 
 		this->SetAudioData(audioData);
 
@@ -1305,6 +1496,148 @@ int BR_LoudnessObject::CheckSetAudioData ()
 		return 1;
 }
 
+bool BR_LoudnessObject::GetCacheKey (const BR_LoudnessObject::AudioData& audioData, char* key)
+{
+	key[0] = 0;
+
+	// Track accessors include FX, sends, receives etc. so only takes playing plain source files (no sections, no take FX) are cached
+	MediaItem_Take* take = this->GetTake();
+	if (this->GetTrack() || !take || TakeFX_GetCount(take) > 0)
+		return false;
+
+	PCM_source* source = GetMediaItemTake_Source(take);
+	if (!source || source->GetSource() || !source->GetFileName() || !strlen(source->GetFileName()))
+		return false;
+
+	struct stat s;
+	if (statUTF8(source->GetFileName(), &s) != 0)
+		return false;
+
+	MediaItem* item = this->GetItem();
+	double itemPos = GetMediaItemInfo_Value(item, "D_POSITION");
+
+	// Source file identity
+	WDL_FastString state;
+	state.SetFormatted(SNM_MAX_PATH + 64, "%s %lld %lld", source->GetFileName(), (long long)s.st_size, (long long)s.st_mtime);
+
+	// Everything that changes accessor output or gets corrected in AnalyzeData()
+	state.AppendFormatted(512, " %.14g %.14g %.14g %.14g %.14g %d %d", GetMediaItemInfo_Value(item, "D_LENGTH"), GetMediaItemTakeInfo_Value(take, "D_STARTOFFS"), GetMediaItemTakeInfo_Value(take, "D_PLAYRATE"), GetMediaItemTakeInfo_Value(take, "D_PITCH"), GetMediaItemTakeInfo_Value(take, "B_PPITCH"), (int)GetMediaItemTakeInfo_Value(take, "I_PITCHMODE"), (int)GetMediaItemInfo_Value(item, "B_LOOPSRC"));
+	state.AppendFormatted(512, " %.14g %.14g %d %d %d %.14g %.14g %.14g", audioData.audioStart, audioData.audioEnd, audioData.channels, audioData.channelMode, audioData.samplerate, audioData.volume, audioData.pan, GetMediaItemTakeInfo_Value(take, "D_PANLAW"));
+	state.AppendFormatted(512, " FADE %.14g %.14g %d %.14g %.14g %.14g %d %.14g", GetMediaItemInfo_Value(item, "D_FADEINLEN"), GetMediaItemInfo_Value(item, "D_FADEINLEN_AUTO"), (int)GetMediaItemInfo_Value(item, "C_FADEINSHAPE"), GetMediaItemInfo_Value(item, "D_FADEINDIR"), GetMediaItemInfo_Value(item, "D_FADEOUTLEN"), GetMediaItemInfo_Value(item, "D_FADEOUTLEN_AUTO"), (int)GetMediaItemInfo_Value(item, "C_FADEOUTSHAPE"), GetMediaItemInfo_Value(item, "D_FADEOUTDIR"));
+
+	int stretchMarkers = GetTakeNumStretchMarkers(take);
+	state.AppendFormatted(128, " SM %d", stretchMarkers);
+	for (int i = 0; i < stretchMarkers; ++i)
+	{
+		double position, srcPosition;
+		GetTakeStretchMarker(take, i, &position, &srcPosition);
+		state.AppendFormatted(128, " %.14g %.14g %.14g", position, srcPosition, GetTakeStretchMarkerSlope(take, i));
+	}
+
+	// Take envelopes that change accessor output
+	BR_Envelope volEnv = audioData.volEnv;
+	BR_Envelope panEnv(take, PAN), muteEnv(take, MUTE), pitchEnv(take, PITCH);
+	AppendCacheKeyEnvelope(state, volEnv, itemPos);
+	AppendCacheKeyEnvelope(state, panEnv, itemPos);
+	AppendCacheKeyEnvelope(state, muteEnv, itemPos);
+	AppendCacheKeyEnvelope(state, pitchEnv, itemPos);
+
+	GetHashString(state.Get(), key);
+	return true;
+}
+
+bool BR_LoudnessObject::LoadFromCache (bool integratedOnly, bool doTruePeak, bool doHighPrecisionMode)
+{
+	BR_LoudnessObject::AudioData data = this->GetAudioData();
+	if (!strlen(data.cacheKey))
+		return false;
+
+	WDL_FastString fn;
+	fn.SetFormatted(SNM_MAX_PATH, LOUDNESS_CACHE_FILE, GetResourcePath(), data.cacheKey);
+
+	WDL_HeapBuf* hb = LoadBin(fn.Get());
+	if (!hb)
+		return false;
+
+	bool loaded = false;
+	const int headerSz = 4 * sizeof(int) + 6 * sizeof(double);
+	if (hb->GetSize() >= headerSz)
+	{
+		const char* p = (const char*)hb->Get();
+		int version, flags, shortTermCount, momentaryCount;
+		double measurements[6];
+		memcpy(&version,        p, sizeof(int));          p += sizeof(int);
+		memcpy(&flags,          p, sizeof(int));          p += sizeof(int);
+		memcpy(measurements,    p, sizeof(measurements)); p += sizeof(measurements);
+		memcpy(&shortTermCount, p, sizeof(int));          p += sizeof(int);
+		memcpy(&momentaryCount, p, sizeof(int));          p += sizeof(int);
+
+		bool validSize = shortTermCount >= 0 && momentaryCount >= 0 && hb->GetSize() == headerSz + (shortTermCount + momentaryCount) * 4;
+		bool cachedIntegratedOnly = !!(flags & CACHE_INTEGRATED_ONLY);
+		bool cachedTruePeak       = !!(flags & CACHE_TRUE_PEAK_ANALYZED);
+		bool cachedHighPrecision  = !!(flags & CACHE_HIGH_PRECISION);
+
+		// Integrated loudness doesn't depend on precision mode, everything else has to match what's requested
+		bool usable = integratedOnly || (!cachedIntegratedOnly && cachedHighPrecision == doHighPrecisionMode && (!doTruePeak || cachedTruePeak));
+
+		if (version == CACHE_VERSION && validSize && usable)
+		{
+			vector<double> shortTermValues(shortTermCount), momentaryValues(momentaryCount);
+			UnpackValues((const unsigned char*)p, shortTermValues);
+			UnpackValues((const unsigned char*)p + shortTermCount * 4, momentaryValues);
+
+			this->SetAnalyzeData(measurements[0], measurements[1], measurements[2], measurements[3], measurements[4], measurements[5], shortTermValues, momentaryValues);
+			this->SetIntegratedOnly(cachedIntegratedOnly);
+			this->SetTruePeakAnalyzed(cachedTruePeak);
+			this->SetAnalyzedStatus(!cachedIntegratedOnly);
+			loaded = true;
+		}
+	}
+
+	// Mark entry as recently used for TrimLoudnessCache()
+	if (loaded)
+		TouchLoudnessCacheFile(fn.Get());
+	delete hb;
+	return loaded;
+}
+
+void BR_LoudnessObject::SaveToCache ()
+{
+	BR_LoudnessObject::AudioData data = this->GetAudioData();
+	if (!strlen(data.cacheKey))
+		return;
+
+	double measurements[6];
+	vector<double> shortTermValues, momentaryValues;
+	this->GetAnalyzeData(&measurements[0], &measurements[1], &measurements[2], &measurements[3], &measurements[4], &measurements[5], &shortTermValues, &momentaryValues);
+
+	int version        = CACHE_VERSION;
+	int flags          = (this->GetIntegratedOnly() ? CACHE_INTEGRATED_ONLY : 0) | (this->GetTruePeakAnalyzeStatus() ? CACHE_TRUE_PEAK_ANALYZED : 0) | (this->GetDoHighPrecisionMode() ? CACHE_HIGH_PRECISION : 0);
+	int shortTermCount = (int)shortTermValues.size();
+	int momentaryCount = (int)momentaryValues.size();
+
+	WDL_HeapBuf hb;
+	char* p = (char*)hb.Resize(4 * sizeof(int) + sizeof(measurements) + (shortTermCount + momentaryCount) * 4, false);
+	if (!p)
+		return;
+
+	memcpy(p, &version,        sizeof(int));          p += sizeof(int);
+	memcpy(p, &flags,          sizeof(int));          p += sizeof(int);
+	memcpy(p, measurements,    sizeof(measurements)); p += sizeof(measurements);
+	memcpy(p, &shortTermCount, sizeof(int));          p += sizeof(int);
+	memcpy(p, &momentaryCount, sizeof(int));          p += sizeof(int);
+	PackValues(shortTermValues, (unsigned char*)p);
+	PackValues(momentaryValues, (unsigned char*)p + shortTermCount * 4);
+
+	WDL_FastString path, fn;
+	path.SetFormatted(SNM_MAX_PATH, LOUDNESS_CACHE_PATH, GetResourcePath());
+	fn.SetFormatted(SNM_MAX_PATH, LOUDNESS_CACHE_FILE, GetResourcePath(), data.cacheKey);
+	if (!FileOrDirExists(path.Get()))
+		CreateDirectory(path.Get(), NULL);
+	if (SaveBin(fn.Get(), &hb))
+		TrimLoudnessCache(path.Get());
+}
+
 void BR_LoudnessObject::SetAudioData (const BR_LoudnessObject::AudioData& audioData)
 {
 	SWS_SectionLock lock(&m_mutex);
@@ -1544,6 +1877,7 @@ volume       (0),
 pan          (0)
 {
 	memset(audioHash, 0, 128);
+	memset(cacheKey, 0, 41);
 }
 
 /******************************************************************************
@@ -2235,12 +2569,11 @@ void BR_AnalyzeLoudnessView::OnItemSortEnd ()
 ******************************************************************************/
 BR_AnalyzeLoudnessWnd::BR_AnalyzeLoudnessWnd () :
 SWS_DockWnd(IDD_BR_LOUDNESS_ANALYZER, __LOCALIZE("Loudness", "sws_DLG_174"), "", SWSGetCommandID(AnalyzeLoudness)),
-m_objectsLen        (0),
-m_currentObjectId   (0),
-m_analyzeInProgress (false),
-m_list              (NULL),
-m_normalizeWnd      (NULL),
-m_exportFormatWnd   (NULL)
+m_objectsLen         (0),
+m_finishedObjectsLen (0),
+m_list               (NULL),
+m_normalizeWnd       (NULL),
+m_exportFormatWnd    (NULL)
 {
 	m_id.Set(LOUDNESS_WND);
 	Init(); // Must call SWS_DockWnd::Init() to restore parameters and open the window if necessary
@@ -2337,8 +2670,8 @@ void BR_AnalyzeLoudnessWnd::AbortAnalyze ()
 			m_analyzeQueue.Delete(i--, false);
 	}
 	m_analyzeQueue.Empty(true);
-	m_objectsLen      = 0;
-	m_currentObjectId = 0;
+	m_objectsLen         = 0;
+	m_finishedObjectsLen = 0;
 }
 
 void BR_AnalyzeLoudnessWnd::AbortReanalyze ()
@@ -2346,8 +2679,19 @@ void BR_AnalyzeLoudnessWnd::AbortReanalyze ()
 	SetAnalyzing(false, true);
 
 	m_reanalyzeQueue.Empty(false);
-	m_objectsLen      = 0;
-	m_currentObjectId = 0;
+	m_objectsLen         = 0;
+	m_finishedObjectsLen = 0;
+}
+
+void BR_AnalyzeLoudnessWnd::AbortRunningObjects ()
+{
+	// Objects that stay in the list won't get destroyed (and thus stopped) when leaving the queue, so stop them here
+	for (int i = 0; i < m_runningObjects.GetSize(); ++i)
+	{
+		if (BR_LoudnessObject* object = m_runningObjects.Get(i))
+			object->AbortAnalyze();
+	}
+	m_runningObjects.Empty(false);
 }
 
 void BR_AnalyzeLoudnessWnd::SetAnalyzing (const bool analyzing, const bool reanalyze)
@@ -2361,11 +2705,80 @@ void BR_AnalyzeLoudnessWnd::SetAnalyzing (const bool analyzing, const bool reana
 
 	if (analyzing)
 		SetTimer(m_hwnd, timer, ANALYZE_TIMER_FREQ, NULL);
-	else {
+	else
+	{
 		KillTimer(m_hwnd, timer);
+		this->AbortRunningObjects();
+	}
+}
+
+bool BR_AnalyzeLoudnessWnd::ProcessQueue (WDL_PtrList<BR_LoudnessObject>* queue, bool addToList, double* progress)
+{
+	// Forget about started objects that got removed from the queue in the meantime (i.e. user deleted them from the list)
+	for (int i = 0; i < m_runningObjects.GetSize(); ++i)
+	{
+		if (queue->Find(m_runningObjects.Get(i)) == -1)
+			m_runningObjects.Delete(i--, false);
+	}
+
+	// Objects can finish in any order, but they leave the queue (and enter the list) only from the front so the list order stays the same
+	bool update = false;
+	while (queue->GetSize())
+	{
+		BR_LoudnessObject* object = queue->Get(0);
+		if (object)
+		{
+			int runningId = m_runningObjects.Find(object);
+			if (runningId == -1 || object->IsRunning())
+				break;
+
+			// Sometimes the analyzed object can already be in the list (if option to clear list upon analyzing is disabled)
+			if (addToList && g_analyzedObjects.Get()->Find(object) == -1)
+				g_analyzedObjects.Get()->Add(object);
+
+			m_finishedObjectsLen += object->GetAudioLength();
+			m_runningObjects.Delete(runningId, false);
+			update = true;
+		}
+		queue->Delete(0, false);
+	}
+	if (update)
+		this->Update();
+
+	if (!queue->GetSize())
+		return false;
+
+	// Start next objects in the queue, keeping at most analyzeThreads objects running at once
+	int maxRunning = (m_properties.analyzeThreads > 0) ? m_properties.analyzeThreads : SWS_GetNumCPUs();
+	int running = 0;
+	for (int i = 0; i < m_runningObjects.GetSize(); ++i)
+	{
+		if (m_runningObjects.Get(i)->IsRunning())
+			++running;
+	}
 
-		m_analyzeInProgress = false;
+	for (int i = 0; i < queue->GetSize() && running < maxRunning; ++i)
+	{
+		BR_LoudnessObject* object = queue->Get(i);
+		if (object && m_runningObjects.Find(object) == -1)
+		{
+			object->Analyze(false, m_properties.doTruePeak, m_properties.doHighPrecisionMode);
+			m_runningObjects.Add(object);
+			if (object->IsRunning()) // already analyzed objects don't start the analysis thread
+				++running;
+		}
 	}
+
+	// Aggregate progress of everything that was started but didn't leave the queue yet
+	double currentLen = 0;
+	for (int i = 0; i < m_runningObjects.GetSize(); ++i)
+	{
+		BR_LoudnessObject* object = m_runningObjects.Get(i);
+		currentLen += object->GetAudioLength() * (object->IsRunning() ? object->GetProgress() : 1);
+	}
+	WritePtr(progress, (m_finishedObjectsLen + currentLen) / m_objectsLen);
+
+	return true;
 }
 
 void BR_AnalyzeLoudnessWnd::ClearList ()
@@ -3316,6 +3729,7 @@ void BR_AnalyzeLoudnessWnd::OnCommand (WPARAM wParam, LPARAM lParam)
 			int x = 0;
 			while (BR_LoudnessObject* listItem = (BR_LoudnessObject*)m_list->EnumSelected(&x))
 			{
+				m_runningObjects.Delete(m_runningObjects.Find(listItem), false);
 				m_reanalyzeQueue.Delete(m_reanalyzeQueue.Find(listItem), false);
 				m_analyzeQueue.Delete(m_analyzeQueue.Find(listItem), true);
 
@@ -3540,118 +3954,40 @@ void BR_AnalyzeLoudnessWnd::OnCommand (WPARAM wParam, LPARAM lParam)
 
 void BR_AnalyzeLoudnessWnd::OnTimer (WPARAM wParam)
 {
-	static BR_LoudnessObject* s_currentObject      = NULL;
-	static double             s_currentObjectLen   = 0;
-	static double             s_finishedObjectsLen = 0;
-
 	if (wParam == ANALYZE_TIMER)
 	{
-		if (!m_analyzeInProgress)
+		double progress = 1;
+		if (this->ProcessQueue(&m_analyzeQueue, true, &progress))
 		{
-			// New analyze task began, reset variables
-			if (m_currentObjectId == 0)
-				s_finishedObjectsLen = 0;
-
-			if (!m_analyzeQueue.GetSize())
-			{
-				// Make sure list view isn't populated with invalid items (i.e. user could have deleted them during analysis)
-				for (int i = 0; i < g_analyzedObjects.Get()->GetSize(); ++i)
-				{
-					if (BR_LoudnessObject* object = g_analyzedObjects.Get()->Get(i))
-					{
-						if (!object->IsTargetValid())
-							g_analyzedObjects.Get()->Delete(i--, true);
-					}
-				}
-
-				this->Update();
-				SetAnalyzing(false, false);
-
-				return;
-			}
-			else
-			{
-				if ((s_currentObject = m_analyzeQueue.Get(0)))
-				{
-					s_currentObjectLen = s_currentObject->GetAudioLength();
-					s_currentObject->Analyze(false, m_properties.doTruePeak, m_properties.doHighPrecisionMode);
-					m_analyzeInProgress = true;
-				}
-				else
-					m_analyzeQueue.Delete(0, true);
-				++m_currentObjectId;
-			}
+			SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
 		}
 		else
 		{
-			// Make sure our object is still here
-			double progress = 1;
-			if (m_analyzeQueue.Find(s_currentObject) != -1 && s_currentObject->IsRunning())
-				progress = (s_finishedObjectsLen + s_currentObjectLen * s_currentObject->GetProgress()) / m_objectsLen;
-			else
+			// Make sure list view isn't populated with invalid items (i.e. user could have deleted them during analysis)
+			for (int i = 0; i < g_analyzedObjects.Get()->GetSize(); ++i)
 			{
-				if (m_analyzeQueue.Find(s_currentObject) != -1)
+				if (BR_LoudnessObject* object = g_analyzedObjects.Get()->Get(i))
 				{
-					// Sometimes the analyzed object can already be in the list (if option to clear list upon analyzing is disabled)
-					if (g_analyzedObjects.Get()->Find(s_currentObject) == -1)
-						g_analyzedObjects.Get()->Add(s_currentObject);
-					m_analyzeQueue.Delete(m_analyzeQueue.Find(s_currentObject), false);
-					this->Update();
+					if (!object->IsTargetValid())
+						g_analyzedObjects.Get()->Delete(i--, true);
 				}
-
-				s_finishedObjectsLen += s_currentObjectLen;
-				progress = s_finishedObjectsLen / m_objectsLen;
-
-				m_analyzeInProgress = false;
 			}
-			SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
+
+			this->Update();
+			SetAnalyzing(false, false);
 		}
 	}
 	else if (wParam == REANALYZE_TIMER)
 	{
-		if (!m_analyzeInProgress)
+		double progress = 1;
+		if (this->ProcessQueue(&m_reanalyzeQueue, false, &progress))
 		{
-			// New analyze task began, reset variables
-			if (m_currentObjectId == 0)
-				s_finishedObjectsLen = 0;
-
-			if (!m_reanalyzeQueue.GetSize())
-			{
-				this->Update();
-				SetAnalyzing(false, true);
-				return;
-			}
-			else
-			{
-				if ((s_currentObject = m_reanalyzeQueue.Get(0)))
-				{
-					s_currentObjectLen = s_currentObject->GetAudioLength();
-					s_currentObject->Analyze(false, m_properties.doTruePeak, m_properties.doHighPrecisionMode);
-					m_analyzeInProgress = true;
-				}
-				else
-					m_reanalyzeQueue.Delete(0, false);
-				++m_currentObjectId;
-			}
+			SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
 		}
 		else
 		{
-			// Make sure our object is still here (user could have deleted it)
-			if (m_reanalyzeQueue.Find(s_currentObject) != -1 && s_currentObject->IsRunning())
-			{
-				double progress = (s_finishedObjectsLen + s_currentObjectLen * s_currentObject->GetProgress()) / m_objectsLen;
-				SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
-			}
-			else
-			{
-				if (m_reanalyzeQueue.Find(s_currentObject) != -1)
-					m_reanalyzeQueue.Delete(m_reanalyzeQueue.Find(s_currentObject), false);
-
-				s_finishedObjectsLen += s_currentObjectLen;
-				double progress = s_finishedObjectsLen / m_objectsLen;
-				SendMessage(GetDlgItem(m_hwnd, IDC_PROGRESS), PBM_SETPOS, (int)(progress*100), 0);
-				m_analyzeInProgress = false;
-			}
+			this->Update();
+			SetAnalyzing(false, true);
 		}
 	}
 	else if (wParam == UPDATE_TIMER)
@@ -3695,6 +4031,7 @@ void BR_AnalyzeLoudnessWnd::OnTimer (WPARAM wParam)
 					else
 					{
 						// Remove from reanalyze and analyze queues first!
+						m_runningObjects.Delete(m_runningObjects.Find(listItem), false);
 						m_reanalyzeQueue.Delete(m_reanalyzeQueue.Find(listItem), false);
 						m_analyzeQueue.Delete(m_analyzeQueue.Find(listItem), true);
 
@@ -3851,7 +4188,8 @@ clearEnvelope         (true),
 clearAnalyzed         (true),
 doTruePeak            (true),
 usingLU               (false),
-doHighPrecisionMode   (true)
+doHighPrecisionMode   (true),
+analyzeThreads        (0)
 {
 }
 
@@ -3872,6 +4210,7 @@ void BR_AnalyzeLoudnessWnd::Properties::Load ()
 	doTruePeak            = (lp.getnumtokens() > 7) ? !!lp.gettoken_int(7) : false;
 	usingLU               = (lp.getnumtokens() > 8) ? !!lp.gettoken_int(8) : false;
 	doHighPrecisionMode   = (lp.getnumtokens() > 9) ? !!lp.gettoken_int(9) : false;
+	analyzeThreads        = (lp.getnumtokens() > 10) ? lp.gettoken_int(10) : 0;
 
 	GetPrivateProfileString("SWS", EXPORT_FORMAT_KEY, "$id - $target: $integrated, Range: $range, True peak: $truepeak", tmp, sizeof(tmp), get_ini_file());
 	exportFormat.Set(tmp);
@@ -3891,7 +4230,7 @@ void BR_AnalyzeLoudnessWnd::Properties::Save ()
 	int doHighPrecisionModeInt   = doHighPrecisionMode;
 
 	char tmp[512];
-	_snprintfSafe(tmp, sizeof(tmp), "%d %d %d %d %d %d %d %d %d %d", analyzeTracksInt, analyzeOnNormalizeInt, mirrorProjSelectionInt, doubleClickGoToTargetInt, timeSelOverMaxInt, clearEnvelopeInt, clearAnalyzedInt, doTruePeakInt, usingLUInt, doHighPrecisionModeInt);
+	_snprintfSafe(tmp, sizeof(tmp), "%d %d %d %d %d %d %d %d %d %d %d", analyzeTracksInt, analyzeOnNormalizeInt, mirrorProjSelectionInt, doubleClickGoToTargetInt, timeSelOverMaxInt, clearEnvelopeInt, clearAnalyzedInt, doTruePeakInt, usingLUInt, doHighPrecisionModeInt, analyzeThreads);
 	WritePrivateProfileString("SWS", LOUDNESS_KEY, tmp, get_ini_file());
 
 	WritePrivateProfileString("SWS", EXPORT_FORMAT_KEY, exportFormat.Get(), get_ini_file());
@@ -90,6 +90,7 @@ private:
 	{
 		AudioAccessor* audio;
 		char audioHash[128];
+		char cacheKey[41]; // empty if results for this audio can't be cached
 		int samplerate, channels, channelMode;
 		double audioStart, audioEnd;
 		double volume, pan;
@@ -99,6 +100,9 @@ private:
 
 	static unsigned WINAPI AnalyzeData (void* loudnessObject);
 	int CheckSetAudioData (); // call from the main thread only, returns 0->target doesn't exist anymore, 1->old accessor still valid, 2->accessor got updated
+	bool GetCacheKey (const AudioData& audioData, char* key); // call from the main thread only, key must be 41 bytes minimum
+	bool LoadFromCache (bool integratedOnly, bool doTruePeak, bool doHighPrecisionMode);
+	void SaveToCache ();
 	void SetAudioData (const AudioData& audioData);
 	AudioData GetAudioData ();
 	void SetRunning (bool running);
@@ -249,7 +253,9 @@ protected:
 	BR_LoudnessObject* IsObjectInList (MediaItem_Take* take);
 	void AbortAnalyze ();
 	void AbortReanalyze ();
+	void AbortRunningObjects ();
 	void SetAnalyzing (bool, bool reanalyze);
+	bool ProcessQueue (WDL_PtrList<BR_LoudnessObject>* queue, bool addToList, double* progress); // returns false when queue is done
 	void ShowExportFormatDialog (bool show);
 	void ShowNormalizeDialog (bool show);
 	void SaveRecentFormatPattern (WDL_FastString pattern);
@@ -280,17 +286,17 @@ protected:
 		bool doTruePeak;
 		bool usingLU;
 		bool doHighPrecisionMode;
+		int analyzeThreads;        // 0 -> use hardware thread count
 		WDL_FastString exportFormat;
 		Properties ();
 		void Load ();
 		void Save ();
 	} m_properties;
-	double m_objectsLen;
-	int m_currentObjectId;
-	bool m_analyzeInProgress;
+	double m_objectsLen, m_finishedObjectsLen;
 	BR_AnalyzeLoudnessView* m_list;
 	HWND m_normalizeWnd, m_exportFormatWnd;                                          // never delete objects in reanalyzeQueue when removing them from list!!
 	WDL_PtrList_DeleteOnDestroy<BR_LoudnessObject> m_analyzeQueue, m_reanalyzeQueue; // m_analyzeQueue is ok if the object didn't enter g_analyzedObjects
+	WDL_PtrList<BR_LoudnessObject> m_runningObjects;                                 // objects from the queue that were started (they leave the queue in order, though)
 
 	enum NormalizeWndMessages    {READ_PROJDATA = 0xF001};
 	enum ExportFormatWndMessages {UPDATE_FORMAT_AND_PREVIEW = 0xF001};
@@ -275,11 +275,17 @@ static bool MousePlaybackInit (COMMAND_T* ct, bool init)
 		}
 
 		// Restore items' mute state
-		if (s_itemMuteState)
+		if (s_itemMuteState && !s_itemMuteState->empty())
 		{
+			vector<GUID> guids(s_itemMuteState->size());
+			for (size_t i = 0; i < s_itemMuteState->size(); ++i)
+				guids[i] = s_itemMuteState->at(i).first;
+			vector<MediaItem*> items(guids.size());
+			GuidsToMediaItems(&guids[0], (int)guids.size(), &items[0]);
+
 			for (size_t i = 0; i < s_itemMuteState->size(); ++i)
 			{
-				if (MediaItem* item = GuidToItem(&s_itemMuteState->at(i).first))
+				if (MediaItem* item = items[i])
 					SetMediaItemInfo_Value(item, "B_MUTE", s_itemMuteState->at(i).second);
 			}
 		}
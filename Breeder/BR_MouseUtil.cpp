@@ -58,28 +58,11 @@ static MediaTrack* GetTrackAreaFromY (int y, int* offset)
 	/* Check if Y is in some TCP track or it's envelopes, *
 	*  returned offset is always for returned track       */
 
-	MediaTrack* master = GetMasterTrack(NULL);
-	MediaTrack* track = NULL;
-
-	int trackEnd = 0;
-	int trackOffset = 0;
-	for (int i = 0; i <= GetNumTracks(); ++i)
-	{
-		MediaTrack* currentTrack = CSurf_TrackFromID(i, false);
-		int height = *(int*)GetSetMediaTrackInfo(currentTrack, "I_WNDH", NULL);
-		if (currentTrack == master && TcpVis(master))
-			height += GetMasterTcpGap();
-		trackEnd += height;
-
-		if (y >= trackOffset && y < trackEnd)
-		{
-			track = currentTrack;
-			break;
-		}
-		trackOffset += height;
-	}
+	BR_TcpLayout* layout = BR_TcpLayout::Get();
+	int id = layout->GetIdFromY(y);
+	MediaTrack* track = (id >= 0) ? (CSurf_TrackFromID(id, false)) : (NULL);
 
-	WritePtr(offset, (track) ? (trackOffset) : (0));
+	WritePtr(offset, (track) ? (layout->GetOffset(id)) : (0));
 	return track;
 }
 
@@ -189,8 +172,36 @@ static MediaItem* GetItemFromY (int y, double position, MediaItem_Take** take, i
 	MediaItem* item = NULL;
 	int itemYStart = 0;
 
+	// Tracks with many items: walk back only through items under position (track
+	// items are sorted by position so this is the same as the linear scan below)
+	bool found = false;
+	if (BR_TrackItemIndex* index = BR_TrackItemIndex::Get(track))
+	{
+		found = true;
+		for (int i = index->GetPrevAt(position, -1); i >= 0; i = index->GetPrevAt(position, i))
+		{
+			MediaItem* currentItem = index->GetItem(i);
+			int yStart = offset;
+			int yEnd = GetItemHeight(currentItem, &yStart, trackH, yStart) + yStart;
+			if (y > yStart && y < yEnd)
+			{
+				if (index->IsUpToDate(i))
+				{
+					item = currentItem;
+					itemYStart = yStart;
+				}
+				else
+				{
+					BR_TrackItemIndex::Invalidate();
+					found = false;
+				}
+				break;
+			}
+		}
+	}
+
 	double iStartLast = GetMediaItemInfo_Value(GetTrackMediaItem(track, 0), "D_POSITION");
-	int count = CountTrackMediaItems(track);
+	int count = (found) ? (0) : (CountTrackMediaItems(track));
 	for (int i = 0; i < count ; ++i)
 	{
 		MediaItem* currentItem = GetTrackMediaItem(track, i);
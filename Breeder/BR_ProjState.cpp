@@ -822,11 +822,18 @@ void BR_ItemMuteState::Save (bool selectedOnly)
 
 bool BR_ItemMuteState::Restore (bool selectedOnly)
 {
+	vector<GUID> guids(m_items.size());
+	for (size_t i = 0; i < m_items.size(); ++i)
+		guids[i] = m_items[i].guid;
+	vector<MediaItem*> items(m_items.size(), (MediaItem*)NULL);
+	if (!guids.empty())
+		GuidsToMediaItems(&guids[0], (int)guids.size(), &items[0]);
+
 	PreventUIRefresh(1);
 	bool update = false;
 	for (size_t i = 0; i < m_items.size(); ++i)
 	{
-		if (MediaItem* item = GuidToItem(&m_items[i].guid))
+		if (MediaItem* item = items[i])
 		{
 			if (!selectedOnly || (selectedOnly && GetMediaItemInfo_Value(item, "B_UISEL") != 0))
 			{
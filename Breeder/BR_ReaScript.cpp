@@ -224,6 +224,26 @@ double BR_EnvValueAtPos (BR_Envelope* envelope, double position)
 	return 0;
 }
 
+int BR_EnvValuesInRange (BR_Envelope* envelope, double start, double step, int count, void* reaperarray)
+{
+	if (envelope && g_script_brenvs.Find(envelope)>=0 && reaperarray && count > 0)
+	{
+		// reaper.array: 1st entry holds used size (low 32 bits) and allocated size (high 32 bits), values follow (https://forum.cockos.com/showthread.php?t=211620)
+		double* values = static_cast<double*>(reaperarray);
+		uint32_t& usedSize = ((uint32_t*)values)[0];
+		uint32_t allocSize = ((uint32_t*)values)[1];
+
+		if ((uint32_t)count > allocSize)
+			count = (int)allocSize;
+		if (count > 0)
+			envelope->ValuesInRange(start, step, count, values + 1);
+
+		usedSize = (uint32_t)count;
+		return count;
+	}
+	return 0;
+}
+
 void BR_GetArrangeView (ReaProject* proj, double* startPositionOut, double* endPositionOut)
 {
 	double start, end;
@@ -312,12 +332,9 @@ MediaTrack* BR_GetMediaTrackByGUID (ReaProject* proj, const char* guidStringIn)
 	{
 		GUID guid;
 		stringToGuid(guidStringIn, &guid);
-		for (int i = 0; i < CountTracks(proj); ++i)
-		{
-			MediaTrack* track = GetTrack(proj, i);
-			if (GuidsEqual(&guid, TrackToGuid(track)))
-				return track;
-		}
+		MediaTrack* track = GuidToTrack(&guid, proj);
+		if (track && track != GetMasterTrack(proj)) // master track not included
+			return track;
 	}
 	return NULL;
 }
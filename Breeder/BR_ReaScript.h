@@ -47,6 +47,7 @@ bool            BR_EnvSetPoint (BR_Envelope* envelope, int id, double position,
 void            BR_EnvSetProperties (BR_Envelope* envelope, bool active, bool visible, bool armed, bool inLane, int laneHeight, int defaultShape, bool faderScaling);
 void            BR_EnvSortPoints (BR_Envelope* envelope);
 double          BR_EnvValueAtPos (BR_Envelope* envelope, double position);
+int             BR_EnvValuesInRange (BR_Envelope* envelope, double start, double step, int count, void* reaperarray);
 void            BR_GetArrangeView (ReaProject* proj, double* startPositionOut, double* endPositionOut);
 double          BR_GetClosestGridDivision (double position);
 void            BR_GetCurrentTheme (char* themePathOut, int themePathOut_sz, char* themeNameOut, int themeNameOut_sz);
@@ -0,0 +1,148 @@
+/******************************************************************************
+/ BR_TcpLayout.cpp
+/
+/ Copyright (c) 2013-2015 Dominik Martin Drzic
+/ http://forum.cockos.com/member.php?u=27094
+/ http://github.com/reaper-oss/sws
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+#include "stdafx.h"
+#include "BR_TcpLayout.h"
+
+/******************************************************************************
+* TCP layout cache                                                            *
+******************************************************************************/
+static const unsigned int TCP_LAYOUT_TTL = 100; // ms, for height changes made outside SWS that don't show in the signature
+
+static int g_tcpLayoutGeneration = 0;
+static int g_tcpLayoutBuilds     = 0;
+
+bool BR_TcpLayout::Signature::operator== (const Signature& s) const
+{
+	return proj       == s.proj       &&
+	       stateCount == s.stateCount &&
+	       trackCount == s.trackCount &&
+	       vZoom      == s.vZoom      &&
+	       showMaster == s.showMaster &&
+	       scrollMax  == s.scrollMax;
+}
+
+BR_TcpLayout::BR_TcpLayout () :
+m_generation (-1),
+m_buildTime  (0),
+m_masterVis  (false)
+{
+	memset(&m_signature, 0, sizeof(m_signature));
+}
+
+BR_TcpLayout* BR_TcpLayout::Get ()
+{
+	static BR_TcpLayout s_layout;
+	if (!s_layout.IsValid())
+		s_layout.Build();
+	return &s_layout;
+}
+
+void BR_TcpLayout::Invalidate ()
+{
+	++g_tcpLayoutGeneration;
+}
+
+int BR_TcpLayout::GetBuildCount ()
+{
+	return g_tcpLayoutBuilds;
+}
+
+int BR_TcpLayout::CountTracks ()
+{
+	return (int)m_wndH.size();
+}
+
+int BR_TcpLayout::GetWndH (int id)
+{
+	return (id >= 0 && id < (int)m_wndH.size()) ? m_wndH[id] : 0;
+}
+
+int BR_TcpLayout::GetOffset (int id)
+{
+	return (id >= 0 && id < (int)m_offsets.size()) ? m_offsets[id] : 0;
+}
+
+int BR_TcpLayout::GetTotalHeight ()
+{
+	return m_offsets.size() ? m_offsets.back() : 0;
+}
+
+int BR_TcpLayout::GetIdFromY (int y)
+{
+	if (y < 0 || m_offsets.size() < 2)
+		return -1;
+
+	// First track whose area ends after y (empty areas can't match)
+	int id = (int)(upper_bound(m_offsets.begin() + 1, m_offsets.end(), y) - (m_offsets.begin() + 1));
+	return (id < (int)m_wndH.size()) ? id : -1;
+}
+
+int BR_TcpLayout::GetIdFromWndY (int y)
+{
+	int id = (int)(upper_bound(m_ends.begin(), m_ends.end(), y) - m_ends.begin());
+	return (id < (int)m_ends.size()) ? id : -1;
+}
+
+bool BR_TcpLayout::IsValid ()
+{
+	if (m_generation != g_tcpLayoutGeneration || ReadTime() - m_buildTime > TCP_LAYOUT_TTL)
+		return false;
+
+	Signature signature;
+	ReadSignature(&signature);
+	return signature == m_signature;
+}
+
+void BR_TcpLayout::Build ()
+{
+	ReadSignature(&m_signature);
+	int count = m_signature.trackCount + 1;
+
+	m_wndH.resize(count);
+	m_ends.resize(count);
+	m_offsets.resize(count + 1);
+	m_masterVis = ReadMasterVisible();
+
+	int offset = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		int height = ReadWndH(i);
+
+		m_wndH[i]    = height;
+		m_offsets[i] = offset;
+		m_ends[i]    = offset + height;
+		offset += height;
+		if (i == 0 && m_masterVis)
+			offset += ReadMasterGap();
+	}
+	m_offsets[count] = offset;
+
+	m_generation = g_tcpLayoutGeneration;
+	m_buildTime  = ReadTime();
+	++g_tcpLayoutBuilds;
+}
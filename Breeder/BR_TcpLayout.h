@@ -0,0 +1,78 @@
+/******************************************************************************
+/ BR_TcpLayout.h
+/
+/ Copyright (c) 2013-2015 Dominik Martin Drzic
+/ http://forum.cockos.com/member.php?u=27094
+/ http://github.com/reaper-oss/sws
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+#pragma once
+
+/******************************************************************************
+* TCP layout cache                                                            *
+******************************************************************************/
+// Per-track Y offsets (prefix sums of I_WNDH) of the current project. Track heights can
+// change without any notification so anything in SWS that sets them (I_HEIGHTOVERRIDE,
+// vzoom2, envelope lanes...) must call Invalidate(). Changes made elsewhere are caught by
+// the signature (track list, vertical zoom, scroll range) or after a short TTL.
+// Track ids: 0 is master (like CSurf_TrackFromID)
+class BR_TcpLayout
+{
+public:
+	static BR_TcpLayout* Get ();       // validated layout of the current project
+	static void Invalidate ();
+	static int GetBuildCount ();
+
+	int CountTracks ();                // master included
+	int GetWndH (int id);              // I_WNDH (track lane and visible envelope lanes)
+	int GetOffset (int id);            // start of track's TCP area, master gap belongs to master area
+	int GetTotalHeight ();
+	int GetIdFromY (int y);            // track whose TCP area contains y, -1 if none
+	int GetIdFromWndY (int y);         // first track whose I_WNDH ends after y (master gap belongs to next track), -1 if none
+	bool IsMasterVisible () { return m_masterVis; }
+
+private:
+	struct Signature
+	{
+		ReaProject* proj;
+		int stateCount, trackCount, vZoom, showMaster, scrollMax;
+		bool operator== (const Signature& s) const;
+	};
+
+	BR_TcpLayout ();
+	bool IsValid ();
+	void Build ();
+
+	/* Project access - these are the only REAPER calls layout makes (see BR_Util.cpp), *
+	*  the rest doesn't depend on REAPER so it can be tested against mock tracks       */
+	static void ReadSignature (Signature* signature);
+	static unsigned int ReadTime ();   // ms
+	static int ReadWndH (int id);
+	static bool ReadMasterVisible ();
+	static int ReadMasterGap ();
+
+	Signature m_signature;
+	int m_generation;
+	unsigned int m_buildTime;
+	bool m_masterVis;
+	vector<int> m_wndH, m_offsets, m_ends; // m_offsets has one more entry: total height
+};
@@ -1247,6 +1247,7 @@ void TempoAtGrid (COMMAND_T* ct)
 		return;
 
 	Undo_BeginBlock2(NULL);
+	BR_GridSnapshot gridSnapshot; // tempo map gets committed only after all points are created
 	vector<double> gridLines;
 	int count = tempoMap.CountPoints()-1;
 	for (int i = 0; i < tempoMap.CountSelected(); ++i)
@@ -1273,7 +1274,7 @@ void TempoAtGrid (COMMAND_T* ct)
 		double gridLine = t0;
 		while (true)
 		{
-			gridLine = GetNextGridDiv(gridLine);
+			gridLine = gridSnapshot.GetNextGridDiv(gridLine);
 			if (gridLine < t1 - (MIN_GRID_DIST/2))
 			{
 				if (tempoMap.CreatePoint(tempoMap.CountPoints(), gridLine, CalculateTempoAtPosition(b0, b1, t0, t1, gridLine), s0, 0, false))
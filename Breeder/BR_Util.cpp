@@ -1354,17 +1354,7 @@ GUID GetItemGuid (MediaItem* item)
 
 MediaItem* GuidToItem (const GUID* guid, ReaProject* proj /*=NULL*/)
 {
-	if (guid)
-	{
-		const int itemCount = CountMediaItems(proj);
-		for (int i = 0; i < itemCount; ++i)
-		{
-			MediaItem* item = GetMediaItem(proj, i);
-			if (GuidsEqual((GUID*)GetSetMediaItemInfo(item, "GUID", NULL), guid))
-				return item;
-		}
-	}
-	return NULL;
+	return GuidToMediaItem(guid, proj);
 }
 
 WDL_FastString GetSourceChunk (PCM_source* source)
@@ -1704,175 +1694,17 @@ double GetGridDivSafe ()
 
 double GetNextGridDiv (double position)
 {
-	/* This got a tiny bit complicated, but we're trying to replicate        *
-	*  REAPER behavior as closely as possible...I guess the ultimate test    *
-	*  would be inserting a bunch of really strange time signatures coupled  *
-	*  with possibly even stranger grid divisions, things any sane person    *
-	*  would never use - like 11/7 with grid division of 2/13...haha. As it  *
-	*  stands now, at REAPER v4.7, this function handles it all              */
-
-	if (position < 0)
-		return 0;
-
-	double nextGridPosition = position;
-
-	int projgridframe; GetConfig("projgridframe", projgridframe);
-	if (projgridframe > 0)
-	{
-		int hours, minutes, seconds, frames;
-		GetTimeInfoFromPosition(position, &hours, &minutes, &seconds, &frames);
-		++frames;
-
-		nextGridPosition = GetPositionFromTimeInfo(hours, minutes, seconds, frames);
-	}
-	else
-	{
-		// Grid dividing starts again from the measure in which tempo marker is so find location of first measure grid (obvious if grid division spans more measures)
-		int gridDivStartTempo = FindPreviousTempoMarker(position);
-		double gridDivStart;
-		if (gridDivStartTempo >= 0)
-		{
-			if (GetTempoTimeSigMarker(NULL, gridDivStartTempo + 1, &gridDivStart, NULL, NULL, NULL, NULL, NULL, NULL))
-			{
-				if (gridDivStart > position)
-					GetTempoTimeSigMarker(NULL, gridDivStartTempo, &gridDivStart, NULL, NULL, NULL, NULL, NULL, NULL);
-				else
-					gridDivStartTempo += 1;
-			}
-			else
-				GetTempoTimeSigMarker(NULL, gridDivStartTempo, &gridDivStart, NULL, NULL, NULL, NULL, NULL, NULL);
-		}
-		else
-		{
-			gridDivStart = 0;
-			gridDivStartTempo = 0; // if position is right at project start this would be -1 even if first tempo marker exists
-		}
-
-		// Get grid division translated into current time signature
-		int gridDivStartMeasure, num, den;
-		TimeMap2_timeToBeats(0, gridDivStart, &gridDivStartMeasure, &num, NULL, &den);
-		double gridDiv = GetGridDivSafe();
-		gridDiv = (den*gridDiv) / 4;
-
-		// How much measures must pass for grid diving to start anew? (again, obvious when grid division spans more measures)
-		int measureStep = (int)(gridDiv/num);
-		if (measureStep == 0) measureStep = 1;
-
-		// Find closest measure to our position, where grid diving starts again
-		int positionMeasure;
-		TimeMap2_timeToBeats(0, position, &positionMeasure, NULL, NULL, NULL);
-		gridDivStartMeasure += (int)((positionMeasure - gridDivStartMeasure) / measureStep) * measureStep;
-		gridDivStart = TimeMap2_beatsToTime(0, 0, &gridDivStartMeasure);
-
-		// Finally find next grid position (different cases for measures and beats)
-		if (gridDiv > num)
-		{
-			int gridDivEndMeasure = gridDivStartMeasure + measureStep;
-			double gridDivEnd = TimeMap2_beatsToTime(0, 0, &gridDivEndMeasure);
-
-			// Same as before, existing tempo markers can move end measure grid (where our next grid should be) so find if that's the case
-			if (measureStep > 1)
-			{
-				double tempoPosition;
-				while (GetTempoTimeSigMarker(NULL, ++gridDivStartTempo, &tempoPosition, NULL, NULL, NULL, NULL, NULL, NULL) && tempoPosition <= gridDivEnd)
-				{
-					int currentMeasure;
-					TimeMap2_timeToBeats(0, tempoPosition, &currentMeasure, NULL, NULL, NULL);
-
-					gridDivEndMeasure = currentMeasure + ((currentMeasure == positionMeasure) ? (measureStep) : (0));
-					gridDivEnd = TimeMap2_beatsToTime(0, 0, &gridDivEndMeasure);
-				}
-			}
-
-			nextGridPosition = TimeMap2_beatsToTime(0, 0, &gridDivEndMeasure);
-		}
-		else
-		{
-			double positionBeats = TimeMap2_timeToBeats(0, position, NULL, NULL, NULL, NULL) - TimeMap2_timeToBeats(0, gridDivStart, NULL, NULL, NULL, NULL);
-			//double nextGridBeats = ((int)(positionBeats / gridDiv) + 1) * gridDiv;
-			double nextGridBeats = (int)((positionBeats + gridDiv) / gridDiv) * gridDiv;
-			while (abs(nextGridBeats - positionBeats) < 1E-6) nextGridBeats += gridDiv; // rounding errors, yuck...
-
-			nextGridPosition = TimeMap2_beatsToTime(0, nextGridBeats, &gridDivStartMeasure);
-
-			// Check it didn't pass over into next measure
-			int gridDivEndMeasure = gridDivStartMeasure + measureStep;
-			double gridDivEnd     = TimeMap2_beatsToTime(0, 0, &gridDivEndMeasure);
-			if (nextGridPosition > gridDivEnd)
-				nextGridPosition = gridDivEnd;
-		}
-
-		// Not so perfect fix for this issue: http://forum.cockos.com/project.php?issueid=5263
-		if (nextGridPosition < position)
-		{
-			double gridDiv = GetGridDivSafe();
-
-			double tempoPosition, beat; int measure; GetTempoTimeSigMarker(NULL, gridDivStartTempo, &tempoPosition, &measure, &beat, NULL, NULL, NULL, NULL);
-			double offset =  gridDiv - fmod(TimeMap_timeToQN(TimeMap2_beatsToTime(0, 0, &measure)), gridDiv);
-
-			double gridLn = TimeMap_timeToQN(tempoPosition);
-			gridLn = TimeMap_QNToTime(gridLn - offset - fmod(gridLn, gridDiv));
-			while (gridLn < position + (MIN_GRID_DIST/2))
-				gridLn = TimeMap_QNToTime(TimeMap_timeToQN(gridLn) + gridDiv);
-
-			nextGridPosition = gridLn;
-		}
-	}
-
-	return nextGridPosition;
+	return BR_GridSnapshot().GetNextGridDiv(position);
 }
 
 double GetPrevGridDiv (double position)
 {
-	if (position <= 0)
-		return 0;
-
-	double prevGridDivPos = position;
-
-	int projgridframe; GetConfig("projgridframe", projgridframe);
-	if (projgridframe > 0)
-	{
-		int hours, minutes, seconds, frames;
-		GetTimeInfoFromPosition(position, &hours, &minutes, &seconds, &frames);
-
-		GetHZoomLevel();
-		double currentFramePos = GetPositionFromTimeInfo(hours, minutes, seconds, frames);
-		if (IsEqual(currentFramePos, position, SNM_FUDGE_FACTOR))
-		{
-			--frames;
-			prevGridDivPos = GetPositionFromTimeInfo(hours, minutes, seconds, frames);
-		}
-		else
-		{
-			prevGridDivPos = currentFramePos;
-		}
-	}
-	else
-	{
-		// GetNextGridDiv is complicated enough, so let's not reinvent it here but reuse it (while less efficient than the real deal, it's really not that slower since GetNextGridDiv() is quite optimized)
-		prevGridDivPos = TimeMap_QNToTime_abs(NULL, TimeMap_timeToQN_abs(NULL, position) - 1.5*GetGridDivSafe());
-		while (true)
-		{
-			double tmp = GetNextGridDiv(prevGridDivPos);
-			if (tmp >= position)
-				break;
-			else
-				prevGridDivPos = tmp;
-		}
-	}
-	return prevGridDivPos;
+	return BR_GridSnapshot().GetPrevGridDiv(position);
 }
 
 double GetClosestGridDiv (double position)
 {
-	double gridDiv = 0;
-	if (position > 0)
-	{
-		double prevGridDiv = GetPrevGridDiv(position);
-		double nextGridDiv = GetNextGridDiv(prevGridDiv);
-		gridDiv = GetClosestVal(position, prevGridDiv, nextGridDiv);
-	}
-	return gridDiv;
+	return BR_GridSnapshot().GetClosestGridDiv(position);
 }
 
 double GetNextGridLine (double position)
@@ -2042,6 +1874,77 @@ double GetClosestRightSideGridLine (double position)
 	}
 }
 
+BR_GridSnapshot::BR_GridSnapshot () :
+m_gridDiv    (GetGridDivSafe()),
+m_tempoCount (CountTempoTimeSigMarkers(NULL))
+{
+	GetConfig("projgridframe", m_gridFrame);
+	m_tempoMarkers.resize(m_tempoCount);
+}
+
+double BR_GridSnapshot::GetNextFrame (double position)
+{
+	int hours, minutes, seconds, frames;
+	GetTimeInfoFromPosition(position, &hours, &minutes, &seconds, &frames);
+	++frames;
+
+	return GetPositionFromTimeInfo(hours, minutes, seconds, frames);
+}
+
+double BR_GridSnapshot::GetPrevFrame (double position)
+{
+	int hours, minutes, seconds, frames;
+	GetTimeInfoFromPosition(position, &hours, &minutes, &seconds, &frames);
+
+	double currentFramePos = GetPositionFromTimeInfo(hours, minutes, seconds, frames);
+	if (IsEqual(currentFramePos, position, SNM_FUDGE_FACTOR))
+	{
+		--frames;
+		return GetPositionFromTimeInfo(hours, minutes, seconds, frames);
+	}
+	else
+	{
+		return currentFramePos;
+	}
+}
+
+void BR_GridSnapshot::ReadTempoMarker (int id, double* position, int* measure)
+{
+	GetTempoTimeSigMarker(NULL, id, position, measure, NULL, NULL, NULL, NULL, NULL);
+}
+
+void BR_GridSnapshot::ReadTimeSig (double position, int* measure, int* num, int* den)
+{
+	TimeMap2_timeToBeats(0, position, measure, num, NULL, den);
+}
+
+int BR_GridSnapshot::ReadMeasure (double position)
+{
+	int measure;
+	TimeMap2_timeToBeats(0, position, &measure, NULL, NULL, NULL);
+	return measure;
+}
+
+double BR_GridSnapshot::ReadFullBeats (double position)
+{
+	return TimeMap2_timeToBeats(0, position, NULL, NULL, NULL, NULL); // with measures NULL, return value is full beat count
+}
+
+double BR_GridSnapshot::ReadTime (double beats, int measure)
+{
+	return TimeMap2_beatsToTime(0, beats, &measure);
+}
+
+double BR_GridSnapshot::TimeToQN (double position, bool abs)
+{
+	return (abs) ? (TimeMap_timeToQN_abs(NULL, position)) : (TimeMap_timeToQN(position));
+}
+
+double BR_GridSnapshot::QNToTime (double qn, bool abs)
+{
+	return (abs) ? (TimeMap_QNToTime_abs(NULL, qn)) : (TimeMap_QNToTime(qn));
+}
+
 /******************************************************************************
 * Locking                                                                     *
 ******************************************************************************/
@@ -2137,13 +2040,12 @@ int GetTrackHeight (MediaTrack* track, int* offsetY, int* topGap /*=NULL*/, int*
 		int offset = 0;
 		if (!master)
 		{
-			int count = CSurf_TrackToID(track, false) - 1;
-			if (count >= -1)
+			int id = CSurf_TrackToID(track, false);
+			if (id >= 0)
 			{
-				for (int i = 0; i < count; ++i)
-					offset += (int)GetMediaTrackInfo_Value(GetTrack(NULL, i), "I_WNDH"); // I_WNDH counts both track lane and any visible envelope lanes
-				if (TcpVis(GetMasterTrack(NULL)))
-					offset += (int)GetMediaTrackInfo_Value(GetMasterTrack(NULL), "I_WNDH") + GetMasterTcpGap();
+				// I_WNDH counts both track lane and any visible envelope lanes, hidden master doesn't count here
+				BR_TcpLayout* layout = BR_TcpLayout::Get();
+				offset = layout->GetOffset(id) - ((layout->IsMasterVisible()) ? (0) : (layout->GetWndH(0)));
 			}
 		}
 		*offsetY = offset;
@@ -2394,6 +2296,178 @@ int GetTrackEnvHeight (TrackEnvelope* envelope, int* offsetY, bool drawableRange
 	return envHeight;
 }
 
+/******************************************************************************
+* TCP layout cache (project access, see BR_TcpLayout.h)                       *
+******************************************************************************/
+void BR_TcpLayout::ReadSignature (Signature* signature)
+{
+	SCROLLINFO si = { sizeof(SCROLLINFO), };
+	si.fMask = SIF_RANGE;
+	CoolSB_GetScrollInfo(GetArrangeWnd(), SB_VERT, &si); // range follows total TCP height
+
+	signature->proj       = EnumProjects(-1, NULL, 0);
+	signature->stateCount = GetProjectStateChangeCount(signature->proj);
+	signature->trackCount = GetNumTracks();
+	signature->scrollMax  = si.nMax;
+	GetConfig("vzoom2", signature->vZoom);
+	GetConfig("showmaintrack", signature->showMaster);
+}
+
+unsigned int BR_TcpLayout::ReadTime ()
+{
+	return GetTickCount();
+}
+
+int BR_TcpLayout::ReadWndH (int id)
+{
+	MediaTrack* track = CSurf_TrackFromID(id, false);
+	return (track) ? (*(int*)GetSetMediaTrackInfo(track, "I_WNDH", NULL)) : (0);
+}
+
+bool BR_TcpLayout::ReadMasterVisible ()
+{
+	return TcpVis(GetMasterTrack(NULL));
+}
+
+int BR_TcpLayout::ReadMasterGap ()
+{
+	return GetMasterTcpGap();
+}
+
+/******************************************************************************
+* Track items index                                                           *
+******************************************************************************/
+static const int   TRACK_ITEM_INDEX_MIN = 64;   // linear scan is fine below that
+static const DWORD TRACK_ITEM_INDEX_TTL = 1000; // ms, in case items got moved without undo point
+
+static void DeleteTrackItemIndex (BR_TrackItemIndex* index) { delete index; }
+static WDL_PtrKeyedArray<BR_TrackItemIndex*> g_trackItemIndexes(DeleteTrackItemIndex);
+static ReaProject* g_trackItemIndexProj       = NULL;
+static int         g_trackItemIndexStateCount = -1;
+static DWORD       g_trackItemIndexTime       = 0;
+
+BR_TrackItemIndex* BR_TrackItemIndex::Get (MediaTrack* track)
+{
+	int count = (track) ? (CountTrackMediaItems(track)) : (0);
+	if (count < TRACK_ITEM_INDEX_MIN)
+		return NULL;
+
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	int stateCount = GetProjectStateChangeCount(proj);
+	if (proj != g_trackItemIndexProj || stateCount != g_trackItemIndexStateCount || GetTickCount() - g_trackItemIndexTime > TRACK_ITEM_INDEX_TTL)
+	{
+		g_trackItemIndexes.DeleteAll();
+		g_trackItemIndexProj       = proj;
+		g_trackItemIndexStateCount = stateCount;
+		g_trackItemIndexTime       = GetTickCount();
+	}
+
+	BR_TrackItemIndex* index = g_trackItemIndexes.Get((INT_PTR)track, NULL);
+	if (!index)
+	{
+		index = new BR_TrackItemIndex(track);
+		g_trackItemIndexes.Insert((INT_PTR)track, index);
+	}
+	else if (index->CountItems() != count)
+	{
+		index->Build();
+	}
+	return (index->m_sorted) ? (index) : (NULL);
+}
+
+void BR_TrackItemIndex::Invalidate ()
+{
+	g_trackItemIndexes.DeleteAll();
+	g_trackItemIndexStateCount = -1;
+}
+
+BR_TrackItemIndex::BR_TrackItemIndex (MediaTrack* track) :
+m_track  (track),
+m_sorted (false)
+{
+	this->Build();
+}
+
+int BR_TrackItemIndex::CountItems ()
+{
+	return (int)m_items.size();
+}
+
+MediaItem* BR_TrackItemIndex::GetItem (int id)
+{
+	return (id >= 0 && id < (int)m_items.size()) ? m_items[id] : NULL;
+}
+
+double BR_TrackItemIndex::GetStart (int id)
+{
+	return (id >= 0 && id < (int)m_starts.size()) ? m_starts[id] : 0;
+}
+
+double BR_TrackItemIndex::GetEnd (int id)
+{
+	return (id >= 0 && id < (int)m_ends.size()) ? m_ends[id] : 0;
+}
+
+bool BR_TrackItemIndex::IsUpToDate (int id)
+{
+	MediaItem* item = this->GetItem(id);
+	if (!item || GetTrackMediaItem(m_track, id) != item)
+		return false;
+
+	double start = GetMediaItemInfo_Value(item, "D_POSITION");
+	double end   = GetMediaItemInfo_Value(item, "D_LENGTH") + start;
+	return start == m_starts[id] && end == m_ends[id];
+}
+
+int BR_TrackItemIndex::GetFirstAt (double position)
+{
+	// Items starting at or before position are [0, count), the first of them that ends at or
+	// after position is where the prefix maximum of item ends reaches position
+	int count = (int)(upper_bound(m_starts.begin(), m_starts.end(), position) - m_starts.begin());
+	int id = (int)(lower_bound(m_maxEnds.begin(), m_maxEnds.begin() + count, position) - m_maxEnds.begin());
+	return (id < count) ? (id) : (-1);
+}
+
+int BR_TrackItemIndex::GetPrevAt (double position, int id)
+{
+	int count = (int)(upper_bound(m_starts.begin(), m_starts.end(), position) - m_starts.begin());
+	for (int i = (id < 0 || id > count) ? (count - 1) : (id - 1); i >= 0; --i)
+	{
+		if (m_maxEnds[i] < position) // no item can reach position before this one
+			break;
+		if (m_ends[i] >= position)
+			return i;
+	}
+	return -1;
+}
+
+void BR_TrackItemIndex::Build ()
+{
+	int count = CountTrackMediaItems(m_track);
+	m_items.resize(count);
+	m_starts.resize(count);
+	m_ends.resize(count);
+	m_maxEnds.resize(count);
+
+	m_sorted = true;
+	double maxEnd = -DBL_MAX;
+	for (int i = 0; i < count; ++i)
+	{
+		MediaItem* item = GetTrackMediaItem(m_track, i);
+		double start = GetMediaItemInfo_Value(item, "D_POSITION");
+		double end   = GetMediaItemInfo_Value(item, "D_LENGTH") + start;
+
+		if (i > 0 && start < m_starts[i-1])
+			m_sorted = false;
+		maxEnd = max(maxEnd, end);
+
+		m_items[i]   = item;
+		m_starts[i]  = start;
+		m_ends[i]    = end;
+		m_maxEnds[i] = maxEnd;
+	}
+}
+
 /******************************************************************************
 * Arrange                                                                     *
 ******************************************************************************/
@@ -28,6 +28,8 @@
 #pragma once
 
 #include "BR_EnvelopeUtil.h"
+#include "BR_GridSnapshot.h"
+#include "BR_TcpLayout.h"
 
 /******************************************************************************
 * Constants                                                                   *
@@ -44,8 +46,6 @@ const int    MAX_SIG                   = 255;
 const double MIN_TEMPO_DIST            = 0.001;
 const double MIN_TIME_SIG_PARTIAL_DIFF = 0.00001;
 const double MIN_ENV_DIST              = 0.000001;
-const double MIN_GRID_DIST             = 0.00097;         // 1/256 at 960 BPM (can't set it to more than 1/256 in grid settings, (other actions like Adjust grid can, but things get broken then)
-const double MAX_GRID_DIV              = 1.0 / 256.0 * 4; // 1/256 because things can get broken after that (http://forum.cockos.com/project.php?issueid=5263)
 const double GRID_DIV_DELTA            = 0.00000001;
 
 const int SECTION_MAIN           = 0;
@@ -232,6 +232,36 @@ int GetTakeEnvHeight (MediaItem_Take* take, int* offsetY);
 int GetTakeEnvHeight (MediaItem* item, int id, int* offsetY);
 int GetTrackEnvHeight (TrackEnvelope* envelope, int* offsetY, bool drawableRangeOnly, MediaTrack* parent = NULL);
 
+/******************************************************************************
+* Track items index                                                           *
+******************************************************************************/
+// Item spans of a track, sorted like the track items (i.e. by position) for log-time hit-testing.
+// Only built for tracks with many items, use a linear scan when Get() returns NULL
+class BR_TrackItemIndex
+{
+public:
+	static BR_TrackItemIndex* Get (MediaTrack* track); // NULL if not worth it, or if items aren't sorted by position
+	static void Invalidate ();
+	~BR_TrackItemIndex () {}
+
+	int CountItems ();
+	MediaItem* GetItem (int id);
+	double GetStart (int id);
+	double GetEnd (int id);
+	bool IsUpToDate (int id);                // checks item's track, position and length
+	int GetFirstAt (double position);        // first item whose span contains position, -1 if none
+	int GetPrevAt (double position, int id); // previous item (id = -1 to start from the last one) whose span contains position, -1 if none
+
+private:
+	BR_TrackItemIndex (MediaTrack* track);
+	void Build ();
+
+	MediaTrack* m_track;
+	vector<MediaItem*> m_items;
+	vector<double> m_starts, m_ends, m_maxEnds; // m_maxEnds: max item end up to id (prefix maximum)
+	bool m_sorted;
+};
+
 /******************************************************************************
 * Arrange                                                                     *
 ******************************************************************************/
@@ -82,53 +82,41 @@ void SelItems::Add(MediaTrack* tr)
 	}
 }
 
-// bUsed is an array of bools with size == m_selItems.GetSize(), used to "check off" when an item from that list is used
-// caller initializes bUsed
-void SelItems::Match(MediaTrack* tr, bool* bUsed)
+void SelItems::Deselect(MediaTrack* tr)
 {
-	PreventUIRefresh(1);
 	int nbitems=GetTrackNumMediaItems(tr);
 	for (int i = 0; i < nbitems; i++)
-	{
-		MediaItem* mi = GetTrackMediaItem(tr, i);
-		GetSetMediaItemInfo(mi, "B_UISEL", &g_bFalse);
-		GUID* g = (GUID*)GetSetMediaItemInfo(mi, "GUID", NULL);
-		for (int j = 0; j < m_selItems.GetSize(); j++)
-			if (!bUsed[j] && GuidsEqual(m_selItems.Get(j), g))
-			{
-				bUsed[j] = true;
-				GetSetMediaItemInfo(mi, "B_UISEL", &g_bTrue);
-				break;
-			}
-	}
-	PreventUIRefresh(-1);
+		GetSetMediaItemInfo(GetTrackMediaItem(tr, i), "B_UISEL", &g_bFalse);
 }
 
 void SelItems::Restore(MediaTrack* tr)
 {
-	bool* bUsed = NULL;
-	if (m_selItems.GetSize())
-	{
-		bUsed = new bool[m_selItems.GetSize()];
-		memset(bUsed, 0, sizeof(bool) * m_selItems.GetSize());
-	}
+	// Find all saved items in one pass through the items of tr (or of all tracks)
+	int nGuids = m_selItems.GetSize();
+	WDL_TypedBuf<GUID> guids;
+	WDL_TypedBuf<MediaItem*> items;
+	guids.Resize(nGuids);
+	items.Resize(nGuids);
+	for (int i = 0; i < nGuids; i++)
+		guids.Get()[i] = *m_selItems.Get(i);
+	GuidsToMediaItems(guids.Get(), nGuids, items.Get(), NULL, tr);
 
+	PreventUIRefresh(1);
 	if (tr == NULL)
-	{
-		PreventUIRefresh(1);
 		for (int i = 1; i <= GetNumTracks(); i++)
-			Match(CSurf_TrackFromID(i, false), bUsed);
-		PreventUIRefresh(-1);
-	}
+			Deselect(CSurf_TrackFromID(i, false));
 	else
-		Match(tr, bUsed);
+		Deselect(tr);
+
+	for (int i = 0; i < nGuids; i++)
+		if (items.Get()[i])
+			GetSetMediaItemInfo(items.Get()[i], "B_UISEL", &g_bTrue);
+	PreventUIRefresh(-1);
 
 	// Delete unused items
-	for (int i = m_selItems.GetSize()-1; i >= 0 ; i--)
-		if (!bUsed[i])
+	for (int i = nGuids-1; i >= 0 ; i--)
+		if (!items.Get()[i])
 			m_selItems.Delete(i, true);
-
-	delete[] bUsed;
 }
 
 char* SelItems::ItemString(char* str, int maxLen, bool* bDone)
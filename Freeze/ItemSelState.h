@@ -44,7 +44,7 @@ public:
 
 private:
 	void Add(MediaTrack* tr);
-	void Match(MediaTrack* tr, bool* bUsed);
+	void Deselect(MediaTrack* tr);
 	WDL_PtrList<GUID> m_selItems;
 };
 
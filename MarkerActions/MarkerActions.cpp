@@ -32,34 +32,145 @@ static bool g_bMAEnabled = true;
 static bool g_bIgnoreNext = false;
 static void RefreshMAToolbar();
 
+static bool CanRunActionMarker()
+{
+	if (EnumProjects(0x40000000, NULL, 0)) // disabled while rendering (0x40000000 trick == rendered project, if any)
+		return false;
+	if (g_bIgnoreNext)
+	{	// Ignore the entire marker action
+		g_bIgnoreNext = false;
+		return false;
+	}
+	return true;
+}
+
+static void RunMarkerCommand(int iCommand)
+{
+	int iZero = 0;
+	if (!kbd_RunCommandThroughHooks(NULL, &iCommand, &iZero, &iZero, &iZero, g_hwndParent))
+	{
+		KBD_OnMainActionEx(iCommand, 0, 0, 0, g_hwndParent, NULL);
+	}
+}
+
+// Returns false if a command of the marker action is not registered (yet)
+static bool ParseActionMarker(const char* cName, std::vector<int>* pCommands)
+{
+	bool bResolved = true;
+	LineParser lp(false);
+	lp.parse(&cName[1]);
+	for (int i = 0; i < lp.getnumtokens(); i++)
+	{
+		int iCommand = lp.gettoken_int(i);
+		if (!iCommand)
+			iCommand = NamedCommandLookup(lp.gettoken_str(i));
+
+		if (iCommand)
+			pCommands->push_back(iCommand);
+		else
+			bResolved = false;
+	}
+	return bResolved;
+}
+
 void RunActionMarker(const char* cName)
 {
-	if (cName && cName[0] == '!' && !EnumProjects(0x40000000, NULL, 0)) // disabled while rendering (0x40000000 trick == rendered project, if any)
+	if (cName && cName[0] == '!' && CanRunActionMarker())
+	{
+		std::vector<int> commands;
+		ParseActionMarker(cName, &commands);
+		for (unsigned int i = 0; i < commands.size(); i++)
+			RunMarkerCommand(commands[i]);
+	}
+}
+
+// Action markers of the current project sorted by position, with their commands already parsed.
+// Rebuilt only when the project, its state change count or its number of markers/regions change,
+// so that the playback timer does not have to enumerate (and parse) all markers on each tick.
+class ActionMarkerIndex
+{
+public:
+	ActionMarkerIndex() : m_proj(NULL), m_iStateCount(-1), m_iMarkerCount(-1) {}
+	void Invalidate() { m_proj = NULL; }
+
+	void Update()
 	{
-		if (g_bIgnoreNext)
-		{	// Ignore the entire marker action
-			g_bIgnoreNext = false;
+		ReaProject* proj = EnumProjects(-1, NULL, 0);
+		int iStateCount = GetProjectStateChangeCount(proj);
+		int iMarkerCount = CountProjectMarkers(proj, NULL, NULL);
+		if (proj == m_proj && iStateCount == m_iStateCount && iMarkerCount == m_iMarkerCount)
 			return;
-		}
-		LineParser lp(false);
-		lp.parse(&cName[1]);
-		for (int i = 0; i < lp.getnumtokens(); i++)
-		{
-			int iCommand = lp.gettoken_int(i);
-			if (!iCommand)
-				iCommand = NamedCommandLookup(lp.gettoken_str(i));
 
-			if (iCommand)
+		m_proj = proj;
+		m_iStateCount = iStateCount;
+		m_iMarkerCount = iMarkerCount;
+		m_markers.clear();
+		m_commands.clear();
+
+		int x = 0;
+		const char* cName;
+		double dMarkerPos;
+		while ((x = EnumProjectMarkers2(proj, x, NULL, &dMarkerPos, NULL, &cName, NULL)))
+		{
+			if (cName && cName[0] == '!')
 			{
-				int iZero = 0;
-				if (!kbd_RunCommandThroughHooks(NULL, &iCommand, &iZero, &iZero, &iZero, g_hwndParent))
-				{
-					KBD_OnMainActionEx(iCommand, 0, 0, 0, g_hwndParent, NULL);
-				}
+				ActionMarker m;
+				m.dPos = dMarkerPos;
+				m.iFirstCmd = (int)m_commands.size();
+				m.bResolved = ParseActionMarker(cName, &m_commands);
+				m.iNumCmds = (int)m_commands.size() - m.iFirstCmd;
+				if (!m.bResolved)
+					m.name.assign(cName);
+				m_markers.push_back(m);
 			}
 		}
+		// Markers are enumerated by position already, stable sort keeps the enum order of markers at the same position
+		std::stable_sort(m_markers.begin(), m_markers.end());
 	}
-}
+
+	// Run action markers in [dStart, dEnd[, or at dStart if dStart == dEnd
+	void Run(double dStart, double dEnd)
+	{
+		ActionMarker m;
+		m.dPos = dStart;
+		std::vector<ActionMarker>::iterator it = std::lower_bound(m_markers.begin(), m_markers.end(), m);
+		// Copy the range first: running actions can modify markers (and rebuild the index)
+		std::vector<ActionMarker> crossed;
+		std::vector<int> commands;
+		for (; it != m_markers.end() && (it->dPos < dEnd || (dStart == dEnd && it->dPos == dStart)); ++it)
+		{
+			crossed.push_back(*it);
+			crossed.back().iFirstCmd = (int)commands.size();
+			commands.insert(commands.end(), m_commands.begin() + it->iFirstCmd, m_commands.begin() + it->iFirstCmd + it->iNumCmds);
+		}
+
+		for (unsigned int i = 0; i < crossed.size(); i++)
+		{
+			if (!crossed[i].bResolved) // Not registered at build time, parse again
+				RunActionMarker(crossed[i].name.c_str());
+			else if (CanRunActionMarker())
+				for (int j = 0; j < crossed[i].iNumCmds; j++)
+					RunMarkerCommand(commands[crossed[i].iFirstCmd + j]);
+		}
+	}
+
+private:
+	struct ActionMarker
+	{
+		double dPos;
+		int iFirstCmd, iNumCmds; // in m_commands
+		bool bResolved;
+		std::string name; // Unresolved markers only
+		bool operator<(const ActionMarker& m) const { return dPos < m.dPos; }
+	};
+
+	ReaProject* m_proj;
+	int m_iStateCount, m_iMarkerCount;
+	std::vector<ActionMarker> m_markers;
+	std::vector<int> m_commands;
+};
+
+static ActionMarkerIndex g_actionMarkers;
 
 void MarkerActionTimer()
 {
@@ -74,13 +185,9 @@ void MarkerActionTimer()
 		{
 			// Quick and dirty IIR
 			dUsualPosDelta = dUsualPosDelta * 0.99 + dDelta * 0.01;
-			int x = 0;
-			const char* cName;
-			double dMarkerPos;
 			// Look for markers with '!' as the first char with the right time
-			while ((x = EnumProjectMarkers(x, NULL, &dMarkerPos, NULL, &cName, NULL)))
-				if (dMarkerPos >= dLastPos && dMarkerPos < dPlayPos)
-					RunActionMarker(cName);
+			g_actionMarkers.Update();
+			g_actionMarkers.Run(dLastPos, dPlayPos);
 		}
 		dLastPos = dPlayPos;
 	}
@@ -119,14 +226,10 @@ void MarkerActionRunUnderCursor(COMMAND_T*)
 	if (!g_bMAEnabled)
 		return;
 
-	int x = 0;
-	const char* cName;
-	double dMarkerPos;
-	double dCurPos = GetCursorPosition();
 	// Look for markers with '!' as the first char with the right time
-	while ((x = EnumProjectMarkers(x, NULL, &dMarkerPos, NULL, &cName, NULL)))
-		if (dMarkerPos == dCurPos)
-			RunActionMarker(cName);
+	double dCurPos = GetCursorPosition();
+	g_actionMarkers.Update();
+	g_actionMarkers.Run(dCurPos, dCurPos);
 }
 
 void MarkerActionIgnoreNext(COMMAND_T*)
@@ -227,5 +330,6 @@ int MarkerActionsInit()
 void MarkerActionsExit()
 {
 	plugin_register("-timer",(void*)MarkerActionTimer);
+	g_actionMarkers.Invalidate();
 }
 
@@ -145,7 +145,7 @@ void SWS_MarkerListView::OnItemDblClk(SWS_ListItem* item, int iCol)
 
 int SWS_MarkerListView::OnItemSort(SWS_ListItem* item1, SWS_ListItem* item2)
 {
-	int iRet;
+	int iRet = 0;
 	MarkerItem* mi1 = (MarkerItem*)item1;
 	MarkerItem* mi2 = (MarkerItem*)item2;
 
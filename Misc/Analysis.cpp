@@ -30,9 +30,103 @@
 #include "../sws_waitdlg.h"
 #include "../reaper/localize.h"
 
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && REASAMPLE_SIZE == 8
+	#include <emmintrin.h>
+	#define SWS_ANALYSIS_SSE2
+#endif
+
 static void GetRMSOptions(double *target, double *windowSize);
 
-static bool AnalyzePCMSource(ANALYZE_PCM* a)
+// Shared state of a multi-item analysis, see AnalyzeItems()
+typedef struct ANALYZE_BATCH
+{
+	ANALYZE_PCM* a;
+	const double* lengths;
+	int count;
+	int next;               // next item to be picked by a worker thread
+	int running;            // worker threads still running
+	double totalLength;
+	double dProgress;       // progress of the whole batch, what the wait dialog shows
+	SWS_Mutex mutex;
+} ANALYZE_BATCH;
+
+// Sets the progress of a batch item and updates the batch one. Workers set their own item
+// while any of them can sum them all, so both happen under the batch lock
+static void UpdateBatchProgress(ANALYZE_BATCH* b, ANALYZE_PCM* a, double dProgress)
+{
+	SWS_SectionLock lock(&b->mutex);
+	a->dProgress = dProgress;
+
+	double done = 0.0;
+	for (int i = 0; i < b->next && i < b->count; i++)
+		done += b->lengths[i] * b->a[i].dProgress;
+
+	if (b->running) // 1.0 closes the wait dialog, leave that to the last thread
+		b->dProgress = min(done / b->totalLength, 0.999);
+}
+
+// Finds absolute peak and sum of squares of every channel in an interleaved block. The SSE2 path
+// holds two channels per register (or two consecutive frames when mono), odd channel counts use scalar code
+static void BlockPeakAndSumSquares(const ReaSample* samples, int frames, int nch, double* peaks, double* sumSquares)
+{
+	int chan = 0;
+#ifdef SWS_ANALYSIS_SSE2
+	const __m128d signMask = _mm_set1_pd(-0.0);
+	if (nch == 1)
+	{
+		__m128d pk = _mm_setzero_pd(), ss = _mm_setzero_pd();
+		int i = 0;
+		for (; i + 1 < frames; i += 2)
+		{
+			__m128d x = _mm_loadu_pd(samples + i);
+			pk = _mm_max_pd(pk, _mm_andnot_pd(signMask, x));
+			ss = _mm_add_pd(ss, _mm_mul_pd(x, x));
+		}
+
+		double pkLanes[2], ssLanes[2];
+		_mm_storeu_pd(pkLanes, pk);
+		_mm_storeu_pd(ssLanes, ss);
+		peaks[0] = max(pkLanes[0], pkLanes[1]);
+		sumSquares[0] = ssLanes[0] + ssLanes[1];
+		for (; i < frames; i++)
+		{
+			peaks[0] = max(peaks[0], fabs(samples[i]));
+			sumSquares[0] += samples[i] * samples[i];
+		}
+		return;
+	}
+	else if (!(nch & 1))
+	{
+		for (; chan < nch; chan += 2)
+		{
+			__m128d pk = _mm_setzero_pd(), ss = _mm_setzero_pd();
+			const ReaSample* p = samples + chan;
+			for (int i = 0; i < frames; i++, p += nch)
+			{
+				__m128d x = _mm_loadu_pd(p);
+				pk = _mm_max_pd(pk, _mm_andnot_pd(signMask, x));
+				ss = _mm_add_pd(ss, _mm_mul_pd(x, x));
+			}
+			_mm_storeu_pd(peaks + chan, pk);
+			_mm_storeu_pd(sumSquares + chan, ss);
+		}
+	}
+#endif
+	for (; chan < nch; chan++)
+	{
+		double pk = 0.0, ss = 0.0;
+		const ReaSample* p = samples + chan;
+		for (int i = 0; i < frames; i++, p += nch)
+		{
+			pk = max(pk, fabs(*p));
+			ss += *p * *p;
+		}
+		peaks[chan] = pk;
+		sumSquares[chan] = ss;
+	}
+}
+
+static bool AnalyzePCMSource(ANALYZE_PCM* a, ANALYZE_BATCH* batch = NULL)
 {
 	// Init local transfer block "t" and sum of squares
 	PCM_source_transfer_t t={0,};
@@ -45,32 +139,51 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 		return false;
 
 	ReaSample* prevBuf = NULL;
-	INT64 tempPeakRMSsample = 0;
 	if (a->dWindowSize != 0.0)
 	{
 		if((prevBuf = new (nothrow) ReaSample[t.length * t.nch]))
 			memset(prevBuf, 0, t.length * t.nch * sizeof(*prevBuf));
 		else
+		{
+			delete[] t.samples;
 			return false;
+		}
 	}
 
-	double* dSumSquares = new double[t.nch];
-	for (int i = 0; i < t.nch; i++)
-		dSumSquares[i] = 0.0;
+	// Per channel state. In windowed mode the running sum of squares is compared directly,
+	// sqrt is taken only once at the end for the maximum (it doesn't change the order)
+	WDL_TypedBuf<double> state;
+	double* dWindowSquares = state.Resize(t.nch * 6);
+	double* dTotalSquares  = dWindowSquares + t.nch;
+	double* dPeaks         = dTotalSquares + t.nch;
+	double* dMaxSumSquares = dPeaks + t.nch;
+	double* dBlockPeaks    = dMaxSumSquares + t.nch;
+	double* dBlockSquares  = dBlockPeaks + t.nch;
+	memset(dWindowSquares, 0, state.GetSize() * sizeof(double));
+
+	WDL_TypedBuf<INT64> positions;
+	INT64* peakPos    = positions.Resize(t.nch * 2);
+	INT64* maxRMSPos  = peakPos + t.nch;
+	memset(peakPos, 0, positions.GetSize() * sizeof(INT64));
 
 	// Init output variables.  Note can have different channel count.
 	for (int i = 0; i < a->iChannels; i++)
 	{
 		if (a->dPeakVals) a->dPeakVals[i] = 0.0;
 		if (a->dRMSs) a->dRMSs[i] = 0.0;
+		if (a->dAvgRMSs) a->dAvgRMSs[i] = 0.0;
 		if (a->peakSamples) a->peakSamples[i] = 0;
 		if (a->peakRMSsamples) a->peakRMSsamples[i] = -666;
 	}
 	a->dPeakVal = 0.0;
 	a->dRMS = 0.0;
+	a->dAvgRMS = 0.0;
 	a->peakRMSsample = -666;
 	a->peakSample = 0;
-	a->dProgress = 0.0;
+	if (batch)
+		UpdateBatchProgress(batch, a, 0.0);
+	else
+		a->dProgress = 0.0;
 	a->sampleCount = 0;
 
 	INT64 totalSamples = (INT64)(a->pcm->GetLength() * t.samplerate);
@@ -79,47 +192,46 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 	a->pcm->GetSamples(&t);
 	while (t.samples_out)
 	{
-		for (int samp = 0; samp < t.samples_out; samp++)
+		BlockPeakAndSumSquares(t.samples, t.samples_out, t.nch, dBlockPeaks, dBlockSquares);
+
+		for (int chan = 0; chan < t.nch; chan++)
 		{
-			for (int chan = 0; chan < t.nch; chan++)
+			// Locate the new peak only in blocks that actually contain one
+			if (dBlockPeaks[chan] > dPeaks[chan])
 			{
-				int i = samp*t.nch + chan;
-				dSumSquares[chan] += t.samples[i] * t.samples[i];
-				double absamp = fabs(t.samples[i]);
-				if (absamp > a->dPeakVal)
+				dPeaks[chan] = dBlockPeaks[chan];
+				for (int samp = 0; samp < t.samples_out; samp++)
 				{
-					a->dPeakVal = absamp;
-					a->peakSample = a->sampleCount;
+					if (fabs(t.samples[samp*t.nch + chan]) == dPeaks[chan])
+					{
+						peakPos[chan] = a->sampleCount + samp;
+						break;
+					}
 				}
+			}
 
-				if (a->dPeakVals && chan < a->iChannels && absamp > a->dPeakVals[chan])
-				{
-					a->dPeakVals[chan] = absamp;
-					if (a->peakSamples)
-						a->peakSamples[chan] = a->sampleCount;
-				}
-				if (a->dWindowSize != 0.0)
+			dTotalSquares[chan] += dBlockSquares[chan];
+			if (a->dWindowSize != 0.0)
+			{
+				double ss = dWindowSquares[chan];
+				for (int samp = 0; samp < t.samples_out; samp++)
 				{
-					dSumSquares[chan] -= prevBuf[i] * prevBuf[i];
-					if (dSumSquares[chan] < 0.0) // Unlikely but possible with rounding errors
-						dSumSquares[chan] = 0.0;
-					double curRMS = sqrt(dSumSquares[chan] / t.length);
-					if (curRMS > a->dRMS) // Overall
-					{ 
-						a->dRMS = curRMS;
-						tempPeakRMSsample = a->sampleCount;
-					}
-					if (a->dRMSs && curRMS > a->dRMSs[chan]) // Single channel, if enabled
-					{ 
-						a->dRMSs[chan] = curRMS;
-						if (a->peakRMSsamples)
-							a->peakRMSsamples[chan] = a->sampleCount;
+					int i = samp*t.nch + chan;
+					ss += t.samples[i] * t.samples[i];
+					ss -= prevBuf[i] * prevBuf[i];
+					if (ss < 0.0) // Unlikely but possible with rounding errors
+						ss = 0.0;
+					if (ss > dMaxSumSquares[chan])
+					{
+						dMaxSumSquares[chan] = ss;
+						maxRMSPos[chan] = a->sampleCount + samp;
 					}
-						
 				}
+				dWindowSquares[chan] = ss;
 			}
-			a->sampleCount++;
 		}
+		a->sampleCount += t.samples_out;
+
 		if (a->dWindowSize != 0.0)
 		{	// Swap buffers in windowed mode for history
 			ReaSample* temp = t.samples;
@@ -127,7 +239,10 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 			prevBuf = temp;
 		}
 
-		a->dProgress = (double)a->sampleCount / totalSamples;
+		if (batch)
+			UpdateBatchProgress(batch, a, (double)a->sampleCount / totalSamples);
+		else
+			a->dProgress = (double)a->sampleCount / totalSamples;
 
 		iFrame++;
 		t.time_s = (double)t.length * iFrame / t.samplerate;
@@ -136,131 +251,270 @@ static bool AnalyzePCMSource(ANALYZE_PCM* a)
 		a->pcm->GetSamples(&t);
 	}
 
+	// Peaks: overall one is the highest channel peak, the earliest one if more channels share it
+	for (int chan = 0; chan < t.nch; chan++)
+	{
+		if (dPeaks[chan] > a->dPeakVal || (dPeaks[chan] == a->dPeakVal && dPeaks[chan] > 0.0 && peakPos[chan] < a->peakSample))
+		{
+			a->dPeakVal = dPeaks[chan];
+			a->peakSample = peakPos[chan];
+		}
+		if (a->dPeakVals && chan < a->iChannels)
+		{
+			a->dPeakVals[chan] = dPeaks[chan];
+			if (a->peakSamples)
+				a->peakSamples[chan] = peakPos[chan];
+		}
+	}
+
+	// Calculate the RMS for the entire item (in both modes)
+	// First per channel
+	if (a->dAvgRMSs && a->sampleCount)
+		for (int i = 0; i < a->iChannels && i < t.nch; i++)
+			a->dAvgRMSs[i] = sqrt(dTotalSquares[i] / a->sampleCount);
+
+	// Then for all channels combined
+	double dSS = 0.0;
+	for (int i = 0; i < t.nch; i++)
+		dSS += dTotalSquares[i];
+	a->dAvgRMS = sqrt(dSS / (a->sampleCount * t.nch));
+
 	if (a->dWindowSize == 0.0)
 	{
-		// Non-windowed mode.  Calculate the RMS for the entire item
-		// First per channel
+		// Non-windowed mode, RMS is the one for the entire item
 		if (a->dRMSs && a->sampleCount)
 			for (int i = 0; i < a->iChannels && i < t.nch; i++)
-				a->dRMSs[i] = sqrt(dSumSquares[i] / a->sampleCount);
-
-		// Then for all channels combined
-		double dSS = 0.0;
-		for (int i = 0; i < t.nch; i++)
-			dSS += dSumSquares[i];
-		a->dRMS = sqrt(dSS / (a->sampleCount * t.nch));
+				a->dRMSs[i] = sqrt(dTotalSquares[i] / a->sampleCount);
+		a->dRMS = a->dAvgRMS;
 	}
-	else // calculate pos. of peak RMS samples
-	{	
-		a->peakRMSsample = tempPeakRMSsample - t.length;
-
-		if (a->peakRMSsamples) {
-			for (int chan = 0; chan < t.nch; chan++) {
-				a->peakRMSsamples[chan] -= t.length;
+	else // windowed mode: max RMS and pos. of peak RMS samples
+	{
+		double dMaxSS = 0.0;
+		INT64 tempPeakRMSsample = 0;
+		for (int chan = 0; chan < t.nch; chan++)
+		{
+			if (dMaxSumSquares[chan] > dMaxSS || (dMaxSumSquares[chan] == dMaxSS && dMaxSS > 0.0 && maxRMSPos[chan] < tempPeakRMSsample))
+			{
+				dMaxSS = dMaxSumSquares[chan];
+				tempPeakRMSsample = maxRMSPos[chan];
+			}
+			if (a->dRMSs && chan < a->iChannels && dMaxSumSquares[chan] > 0.0)
+			{
+				a->dRMSs[chan] = sqrt(dMaxSumSquares[chan] / t.length);
+				if (a->peakRMSsamples)
+					a->peakRMSsamples[chan] = maxRMSPos[chan] - t.length;
 			}
 		}
-
+		a->dRMS = sqrt(dMaxSS / t.length);
+		a->peakRMSsample = tempPeakRMSsample - t.length;
 	}
 
 	delete[] t.samples;
 	delete[] prevBuf;
-	delete[] dSumSquares;
 
 	return true;
 }
 
-unsigned int WINAPI AnalyzePCMThread(void* pAnalyze)
+static unsigned int WINAPI AnalyzeBatchThread(void* pBatch)
 {
-	ANALYZE_PCM *a = static_cast<ANALYZE_PCM *>(pAnalyze);
-	a->success = AnalyzePCMSource(a);
-	a->dProgress = 1.0; // closes the wait dialog
+	ANALYZE_BATCH* b = static_cast<ANALYZE_BATCH*>(pBatch);
+	while (true)
+	{
+		int i;
+		{
+			SWS_SectionLock lock(&b->mutex);
+			i = b->next++;
+		}
+		if (i >= b->count)
+			break;
+
+		if (b->a[i].pcm)
+			b->a[i].success = AnalyzePCMSource(&b->a[i], b);
+		UpdateBatchProgress(b, &b->a[i], 1.0);
+	}
+
+	SWS_SectionLock lock(&b->mutex);
+	if (--b->running == 0)
+		b->dProgress = 1.0; // closes the wait dialog
 	return 0;
 }
 
-// return true for successful analysis
-// wraps AnalyzePCM to check item validity and create a wait dialog
-bool AnalyzeItem(MediaItem* item, ANALYZE_PCM* a)
+// Analyze several items concurrently (worker thread per CPU) behind a single wait dialog
+// Every a[i] is set up by the caller as for AnalyzeItem(), returns the number of successfully analyzed items
+int AnalyzeItems(MediaItem** items, int count, ANALYZE_PCM* a)
 {
-	a->dProgress = 0.0;
-	a->pcm = (PCM_source*)item;
+	WDL_TypedBuf<double> lengths, winSizes;
+	lengths.Resize(count);
+	winSizes.Resize(count);
 
-	if (!a->pcm || strcmp(a->pcm->GetType(), "MIDI") == 0 || strcmp(a->pcm->GetType(), "MIDIPOOL") == 0)
-		return false;
+	double totalLength = 0.0;
+	for (int i = 0; i < count; i++)
+	{
+		lengths.Get()[i] = 0.0;
+		winSizes.Get()[i] = a[i].dWindowSize;
+		a[i].dProgress = 0.0;
+		a[i].success = false;
+		a[i].pcm = (PCM_source*)items[i];
 
-	a->pcm = a->pcm->Duplicate();
-	if (!a->pcm || !a->pcm->GetNumChannels())
-		return false;
+		if (!a[i].pcm || strcmp(a[i].pcm->GetType(), "MIDI") == 0 || strcmp(a[i].pcm->GetType(), "MIDIPOOL") == 0)
+		{
+			a[i].pcm = NULL;
+			continue;
+		}
+
+		a[i].pcm = a[i].pcm->Duplicate();
+		if (a[i].pcm && !a[i].pcm->GetNumChannels())
+		{
+			delete a[i].pcm;
+			a[i].pcm = NULL;
+		}
+		if (!a[i].pcm)
+			continue;
 
-	double dZero = 0.0;
-	GetSetMediaItemInfo((MediaItem*)a->pcm, "D_POSITION", &dZero);
+		double dZero = 0.0;
+		GetSetMediaItemInfo((MediaItem*)a[i].pcm, "D_POSITION", &dZero);
 
-	const char* cName = NULL;
-	MediaItem_Take* take = GetMediaItemTake(item, -1);
-	if (take)
-		cName = (const char*)GetSetMediaItemTakeInfo(take, "P_NAME", NULL);
+		if (a[i].dWindowSize > a[i].pcm->GetLength())
+			a[i].dWindowSize = 0.0;
 
-	const double oldWinSize = a->dWindowSize;
-	if (a->dWindowSize > a->pcm->GetLength())
-		a->dWindowSize = 0.0;
+		// +1 so empty sources still count towards progress
+		lengths.Get()[i] = a[i].pcm->GetLength() + 1.0;
+		totalLength += lengths.Get()[i];
+	}
+
+	if (totalLength > 0.0)
+	{
+		ANALYZE_BATCH b;
+		b.a = a;
+		b.lengths = lengths.Get();
+		b.count = count;
+		b.next = 0;
+		b.totalLength = totalLength;
+		b.dProgress = 0.0;
+		b.running = min(SWS_GetNumCPUs(), count);
+
+		WDL_TypedBuf<HANDLE> threads;
+		threads.Resize(b.running);
+		int created = 0;
+		for (int i = 0; i < threads.GetSize(); i++)
+		{
+			if (HANDLE hThread = (HANDLE)_beginthreadex(NULL, 0, AnalyzeBatchThread, &b, 0, NULL))
+				threads.Get()[created++] = hThread;
+			else
+			{
+				SWS_SectionLock lock(&b.mutex);
+				if (--b.running == 0)
+					b.dProgress = 1.0;
+			}
+		}
+		threads.Resize(created);
 
-	HANDLE hThread = (HANDLE)_beginthreadex(NULL, 0, AnalyzePCMThread, a, 0, NULL);
+		WDL_String title;
+		if (count == 1)
+		{
+			const char* cName = NULL;
+			if (MediaItem_Take* take = GetMediaItemTake(items[0], -1))
+				cName = (const char*)GetSetMediaItemTakeInfo(take, "P_NAME", NULL);
+			title.AppendFormatted(100, __LOCALIZE_VERFMT("Please wait, analyzing %s...","sws_analysis"), cName ? cName : __LOCALIZE("item","sws_analysis"));
+		}
+		else
+			title.AppendFormatted(100, __LOCALIZE_VERFMT("Please wait, analyzing %d items...","sws_analysis"), count);
 
-	WDL_String title;
-	title.AppendFormatted(100, __LOCALIZE_VERFMT("Please wait, analyzing %s...","sws_analysis"), cName ? cName : __LOCALIZE("item","sws_analysis"));
-	SWS_WaitDlg wait(title.Get(), &a->dProgress);
+		if (created)
+		{
+			SWS_WaitDlg wait(title.Get(), &b.dProgress);
+		}
+		else
+		{
+			// couldn't start any thread, analyze here
+			b.running = 1;
+			b.dProgress = 0.0;
+			AnalyzeBatchThread(&b);
+		}
 
-	CloseHandle(hThread);
+		for (int i = 0; i < threads.GetSize(); i++)
+		{
+			WaitForSingleObject(threads.Get()[i], INFINITE);
+			CloseHandle(threads.Get()[i]);
+		}
+	}
 
-	// restore original window if it was larger than the item's length
-	a->dWindowSize = oldWinSize;
+	int analyzed = 0;
+	for (int i = 0; i < count; i++)
+	{
+		// restore original window if it was larger than the item's length
+		a[i].dWindowSize = winSizes.Get()[i];
 
-	delete a->pcm;
-	return a->success;
+		delete a[i].pcm;
+		a[i].pcm = NULL;
+		if (a[i].success)
+			analyzed++;
+	}
+	return analyzed;
+}
+
+// return true for successful analysis
+// wraps AnalyzePCM to check item validity and create a wait dialog
+bool AnalyzeItem(MediaItem* item, ANALYZE_PCM* a)
+{
+	return AnalyzeItems(&item, 1, a) == 1;
 }
 
 void DoAnalyzeItem(COMMAND_T*)
 {
 	WDL_TypedBuf<MediaItem*> items;
 	SWS_GetSelectedMediaItems(&items);
-	bool bDidWork = false;
+
+	// Analyze all items at once, then show the results one by one
+	WDL_TypedBuf<ANALYZE_PCM> analyze;
+	ANALYZE_PCM* pa = analyze.Resize(items.GetSize());
+	memset(pa, 0, analyze.GetSize() * sizeof(ANALYZE_PCM));
+
+	int iCount = 0;
 	for (int i = 0; i < items.GetSize(); i++)
 	{
 		MediaItem* item = items.Get()[i];
 		int iChannels = ((PCM_source*)item)->GetNumChannels();
 		if (iChannels)
 		{
-			bDidWork = true;
-			ANALYZE_PCM a;
-			memset(&a, 0, sizeof(a));
+			items.Get()[iCount] = item;
+			ANALYZE_PCM& a = pa[iCount++];
 			a.iChannels = iChannels;
 			a.dPeakVals = new double[iChannels];
 			a.dRMSs     = new double[iChannels];
-
-			if (AnalyzeItem(item, &a))
-			{
-				WDL_String str;
-				str.Set(__LOCALIZE("Peak level:","sws_analysis"));
-				for (int i = 0; i < iChannels; i++) {
-					str.Append(" ");
-					str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), i+1, VAL2DB(a.dPeakVals[i]));
-				}
-				str.Append("\n");
-				str.Append(__LOCALIZE("RMS level:","sws_analysis"));
-				for (int i = 0; i < iChannels; i++) {
-					str.Append(" ");
-					str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), i+1, VAL2DB(a.dRMSs[i]));
-				}
-				MessageBox(g_hwndParent, str.Get(), __LOCALIZE("Item analysis","sws_analysis"), MB_OK);
-			}
-			delete [] a.dPeakVals;
-			delete [] a.dRMSs;
 		}
 	}
-	if (!bDidWork)
+
+	if (!iCount)
 	{
 		MessageBox(NULL, __LOCALIZE("No items selected to analyze.","sws_analysis"), __LOCALIZE("SWS - Error","sws_analysis"), MB_OK);
 		return;
 	}
+
+	AnalyzeItems(items.Get(), iCount, pa);
+
+	for (int i = 0; i < iCount; i++)
+	{
+		ANALYZE_PCM& a = pa[i];
+		if (a.success)
+		{
+			WDL_String str;
+			str.Set(__LOCALIZE("Peak level:","sws_analysis"));
+			for (int i = 0; i < a.iChannels; i++) {
+				str.Append(" ");
+				str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), i+1, VAL2DB(a.dPeakVals[i]));
+			}
+			str.Append("\n");
+			str.Append(__LOCALIZE("RMS level:","sws_analysis"));
+			for (int i = 0; i < a.iChannels; i++) {
+				str.Append(" ");
+				str.AppendFormatted(50, __LOCALIZE_VERFMT("Channel %d = %.2f dB","sws_analysis"), i+1, VAL2DB(a.dRMSs[i]));
+			}
+			MessageBox(g_hwndParent, str.Get(), __LOCALIZE("Item analysis","sws_analysis"), MB_OK);
+		}
+		delete [] a.dPeakVals;
+		delete [] a.dRMSs;
+	}
 }
 
 void FindItemPeak(COMMAND_T*)
@@ -293,17 +547,22 @@ void OrganizeByVol(COMMAND_T* ct)
 		{
 			double dStart = *(double*)GetSetMediaItemInfo(items.Get()[0], "D_POSITION", NULL);
 			double* pVol = new double[items.GetSize()];
-			ANALYZE_PCM a;
-			memset(&a, 0, sizeof(a));
+			WDL_TypedBuf<ANALYZE_PCM> analyze;
+			ANALYZE_PCM* pa = analyze.Resize(items.GetSize());
+			memset(pa, 0, analyze.GetSize() * sizeof(ANALYZE_PCM));
 			if (ct->user == 2)
 			{	// Windowed mode, set the window size
-				GetRMSOptions(NULL, &a.dWindowSize);
+				double dWindowSize;
+				GetRMSOptions(NULL, &dWindowSize);
+				for (int i = 0; i < items.GetSize(); i++)
+					pa[i].dWindowSize = dWindowSize;
 			}
+			AnalyzeItems(items.Get(), items.GetSize(), pa);
 			for (int i = 0; i < items.GetSize(); i++)
 			{
 				pVol[i] = -1.0;
-				if (AnalyzeItem(items.Get()[i], &a))
-					pVol[i] = ct->user ? a.dRMS : a.dPeakVal;
+				if (pa[i].success)
+					pVol[i] = ct->user ? pa[i].dRMS : pa[i].dPeakVal;
 			}
 			// Sort and arrange items from min to max RMS
 			while (true)
@@ -329,20 +588,35 @@ void OrganizeByVol(COMMAND_T* ct)
 	}
 }
 
+// Selected items that have an active take
+static void GetSelectedTakeItems(WDL_TypedBuf<MediaItem*>* buf)
+{
+	SWS_GetSelectedMediaItems(buf);
+	int iCount = 0;
+	for (int i = 0; i < buf->GetSize(); i++)
+		if (GetMediaItemTake(buf->Get()[i], -1))
+			buf->Get()[iCount++] = buf->Get()[i];
+	buf->Resize(iCount);
+}
+
 void RMSNormalize(double dTargetDb, double dWindowSize)
 {
 	WDL_TypedBuf<MediaItem*> items;
-	SWS_GetSelectedMediaItems(&items);
+	GetSelectedTakeItems(&items);
 	bool bDidWork = false;
-	ANALYZE_PCM a;
-	memset(&a, 0, sizeof(a));
-	a.dWindowSize = dWindowSize;
+	WDL_TypedBuf<ANALYZE_PCM> analyze;
+	ANALYZE_PCM* pa = analyze.Resize(items.GetSize());
+	memset(pa, 0, analyze.GetSize() * sizeof(ANALYZE_PCM));
+	for (int i = 0; i < items.GetSize(); i++)
+		pa[i].dWindowSize = dWindowSize;
+	AnalyzeItems(items.Get(), items.GetSize(), pa);
 
 	for (int i = 0; i < items.GetSize(); i++)
 	{
 		MediaItem* item = items.Get()[i];
 		MediaItem_Take* take = GetMediaItemTake(item, -1);
-		if (take && AnalyzeItem(item, &a) && a.dRMS != 0.0)
+		const ANALYZE_PCM& a = pa[i];
+		if (a.success && a.dRMS != 0.0)
 		{
 			bDidWork = true;
 			double dVol = *(double*)GetSetMediaItemTakeInfo(take, "D_VOL", NULL);
@@ -360,18 +634,19 @@ void RMSNormalize(double dTargetDb, double dWindowSize)
 void RMSNormalizeAll(double dTargetDb, double dWindowSize)
 {
 	WDL_TypedBuf<MediaItem*> items;
-	SWS_GetSelectedMediaItems(&items);
+	GetSelectedTakeItems(&items);
 	double dMaxRMS = -DBL_MAX;
-	ANALYZE_PCM a;
-	memset(&a, 0, sizeof(a));
-	a.dWindowSize = dWindowSize;
+	WDL_TypedBuf<ANALYZE_PCM> analyze;
+	ANALYZE_PCM* pa = analyze.Resize(items.GetSize());
+	memset(pa, 0, analyze.GetSize() * sizeof(ANALYZE_PCM));
+	for (int i = 0; i < items.GetSize(); i++)
+		pa[i].dWindowSize = dWindowSize;
+	AnalyzeItems(items.Get(), items.GetSize(), pa);
 
 	for (int i = 0; i < items.GetSize(); i++)
 	{
-		MediaItem* item = items.Get()[i];
-		MediaItem_Take* take = GetMediaItemTake(item, -1);
-		if (take && AnalyzeItem(item, &a) && a.dRMS != 0.0 && a.dRMS > dMaxRMS)
-			dMaxRMS = a.dRMS;
+		if (pa[i].success && pa[i].dRMS != 0.0 && pa[i].dRMS > dMaxRMS)
+			dMaxRMS = pa[i].dRMS;
 	}
 
 	if (dMaxRMS > -DBL_MAX)
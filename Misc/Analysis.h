@@ -47,11 +47,14 @@ typedef struct ANALYZE_PCM
 	INT64 sampleCount;      // out # of samples analyzed
 	double dWindowSize;     // RMS window in seconds.  If this is != 0.0, then RMS is calculated/returned as max within window
 	bool success;
+	double* dAvgRMSs;       // i/o Array of channel RMS values over entire item, also in windowed mode (optional)
+	double dAvgRMS;         // out RMS of all channels over entire item, also in windowed mode
 } ANALYZE_PCM;
 
 int AnalysisInit();
 
 bool AnalyzeItem(MediaItem* mi, ANALYZE_PCM* a);
+int AnalyzeItems(MediaItem** items, int count, ANALYZE_PCM* a); // one wait dialog, items analyzed concurrently
 
 // #781 Export to ReaScript
 void NF_GetRMSOptions(double *targetOut, double *winSizeOut);
\ No newline at end of file
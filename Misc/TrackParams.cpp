@@ -31,6 +31,7 @@
 #include "TrackParams.h"
 #include "TrackSel.h"
 #include "../reaper/localize.h"
+#include "../Breeder/BR_TcpLayout.h"
 
 void EnableMPSend(COMMAND_T* = NULL)
 {
@@ -234,6 +235,7 @@ void MinimizeTracks(COMMAND_T* = NULL)
 			GetSetMediaTrackInfo(tr, "I_HEIGHTOVERRIDE", &g_i1);
 	}
 	TrackList_AdjustWindows(false);
+	BR_TcpLayout::Invalidate();
 	UpdateTimeline();
 }
 
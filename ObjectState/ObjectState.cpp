@@ -38,6 +38,13 @@
 
 //#define GOS_DEBUG
 
+static ObjectStateCacheStats g_objStateCacheStats = {0, 0, 0, 0, 0};
+
+const ObjectStateCacheStats* SWS_GetObjectStateCacheStats()
+{
+	return &g_objStateCacheStats;
+}
+
 ObjectStateCache::ObjectStateCache():m_iUseCount(1)
 {
 }
@@ -52,20 +59,31 @@ void ObjectStateCache::WriteCache()
 #ifdef GOS_DEBUG
 	int iCount = 0;
 #endif
-	for (int i = 0; i < m_obj.GetSize(); i++)
+	for (int i = 0; i < m_order.GetSize(); i++)
 	{
-		if (m_str.Get(i)->GetLength() && m_orig.Get(i) && strcmp(m_str.Get(i)->Get(), m_orig.Get(i)))
+		CachedState* s = m_order.Get(i);
+		// never written (or written before being read): nothing to compare
+		if (!s->m_iGeneration || !s->m_str.GetLength() || !s->m_orig ||
+			(s->m_str.GetLength() == s->m_iOrigLen && !memcmp(s->m_str.Get(), s->m_orig, s->m_iOrigLen)))
 		{
-			int fxstate = SNM_PreObjectState(m_str.Get(i), false);
-			GetSetObjectState(m_obj.Get(i), m_str.Get(i)->Get());
-			SNM_PostObjectState(fxstate);
+			g_objStateCacheStats.iSkipped++;
+			continue;
+		}
+
+		int fxstate = SNM_PreObjectState(&s->m_str, false);
+		GetSetObjectState(s->m_obj, s->m_str.Get());
+		SNM_PostObjectState(fxstate);
+		g_objStateCacheStats.iWrites++;
+		g_objStateCacheStats.iBytesWritten += s->m_str.GetLength();
 #ifdef GOS_DEBUG
-			iCount++;
+		iCount++;
 #endif
-		}
 	}
 #ifdef GOS_DEBUG
 	dprintf("ObjectStateCache::WriteCache applied %d chunks.\n", iCount);
+	dprintf("ObjectStateCache stats: %d hits, %d misses, %d writes, %d skipped, %d bytes written\n",
+		g_objStateCacheStats.iHits, g_objStateCacheStats.iMisses, g_objStateCacheStats.iWrites,
+		g_objStateCacheStats.iSkipped, (int)g_objStateCacheStats.iBytesWritten);
 #endif
 
 	EmptyCache();
@@ -73,39 +91,44 @@ void ObjectStateCache::WriteCache()
 
 void ObjectStateCache::EmptyCache()
 {
-	m_obj.Empty();
-	m_str.Empty(true);
-	m_orig.Empty(true, FreeHeapPtr);
+	m_states.clear();
+	m_order.Empty(true);
 }
 
 const char* ObjectStateCache::GetSetObjState(void* obj, const char* str, bool wantsMinimalState)
 {
-	int i = m_obj.Find(obj);
-	if (i < 0)
+	CachedState* s;
+	std::map<void*, CachedState*>::iterator it = m_states.find(obj);
+	if (it != m_states.end())
 	{
-		i = m_obj.GetSize();
-		m_obj.Add(obj);
-		m_str.Add(new WDL_FastString);
-		if (str && str[0])
-			m_orig.Add(NULL);
-		else
+		s = it->second;
+		g_objStateCacheStats.iHits++;
+	}
+	else
+	{
+		s = m_order.Add(new CachedState(obj));
+		m_states[obj] = s;
+		g_objStateCacheStats.iMisses++;
+		if (!str || !str[0])
 		{
 			int fxstate = SNM_PreObjectState(NULL, wantsMinimalState);
-			char* p = GetSetObjectState(obj, NULL);
+			s->m_orig = GetSetObjectState(obj, NULL);
 			SNM_PostObjectState(fxstate);
-			m_orig.Add(p);
+			s->m_iOrigLen = s->m_orig ? (int)strlen(s->m_orig) : 0;
 		}
 	}
+
 	if (str && str[0])
 	{
-		m_str.Get(i)->Set(str);
+		s->m_str.Set(str);
+		s->m_iGeneration++;
 		return NULL;
 	}
 
-	if (m_str.Get(i)->GetLength())
-		return m_str.Get(i)->Get();
+	if (s->m_str.GetLength())
+		return s->m_str.Get();
 	else
-		return m_orig.Get(i);
+		return s->m_orig;
 }
 
 ObjectStateCache* g_objStateCache = NULL;
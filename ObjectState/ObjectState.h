@@ -28,6 +28,16 @@
 
 #pragma once
 
+// Cumulative counters, for profiling
+typedef struct ObjectStateCacheStats
+{
+	int iHits;          // state reads/writes served by the cache
+	int iMisses;        // objects added to the cache (1st access)
+	int iWrites;        // states written back when flushing the cache
+	int iSkipped;       // cached states not written back (not written at all or unchanged)
+	INT64 iBytesWritten;
+} ObjectStateCacheStats;
+
 class ObjectStateCache
 {
 public:
@@ -38,11 +48,23 @@ public:
 	const char* GetSetObjState(void* obj, const char* str, bool wantsMinimalState = false);
 	int m_iUseCount;
 private:
-	WDL_PtrList<void> m_obj;
-	WDL_PtrList<WDL_FastString> m_str;
-	WDL_PtrList<char> m_orig;
+	class CachedState
+	{
+	public:
+		CachedState(void* obj) : m_obj(obj), m_orig(NULL), m_iOrigLen(0), m_iGeneration(0) {}
+		~CachedState() { if (m_orig) FreeHeapPtr(m_orig); }
+		void* m_obj;
+		WDL_FastString m_str; // written state, if any
+		char* m_orig;         // state read from REAPER, NULL if the 1st access was a write
+		int m_iOrigLen;
+		int m_iGeneration;    // number of writes, 0: clean
+	};
+	std::map<void*, CachedState*> m_states;
+	WDL_PtrList_DeleteOnDestroy<CachedState> m_order; // 1st access order, i.e. write back order
 };
 
+const ObjectStateCacheStats* SWS_GetObjectStateCacheStats();
+
 const char* SWS_GetSetObjectState(void* obj, WDL_FastString* str, bool wantsMinimalState = false);
 void SWS_FreeHeapPtr(void* ptr);
 void SWS_FreeHeapPtr(const char* ptr);
@@ -38,8 +38,6 @@
 //#define _SNM_DEBUG
 //#define _SNM_SCREENSET_DEBUG
 //#define _SNM_DYN_FONT_DEBUG
-//#define _SNM_RGNPL_DEBUG1
-//#define _SNM_RGNPL_DEBUG2
 //#define _SNM_MISC           // not released, deprecated, tests, etc..
 //#define _SNM_WDL            // if my WDL version is used
 #define _SNM_HOST_AW          // host Adam's stuff
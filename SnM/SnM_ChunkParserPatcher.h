@@ -1,5 +1,5 @@
 /******************************************************************************
-/ SnM_ChunkParserPatcher.h - v1.34
+/ SnM_ChunkParserPatcher.h - v1.35
 /
 / Copyright (c) 2008 and later Jeffos
 /
@@ -40,12 +40,17 @@
 // Important: 
 // - Chunks can be HUGE! e.g. 4Mb+ is an usual case
 // - The code assumes RPP chunks are consistent, left trimmed, with Unix EOL
+// - Built-in getter/setter modes work on a line index of the cached chunk
+//   when it gives the same results (see ParsePatchIndexed()), custom modes
+//   use the line by line parser
 // - A v2.0 with major refactoring is on the way
 
 
 #ifndef _SNM_CHUNKPARSERPATCHER_H_
 #define _SNM_CHUNKPARSERPATCHER_H_
 
+#include <typeinfo>
+
 #ifndef __GNUC__
 #pragma warning(disable : 4267) // size_t to int warnings in x64
 #endif
@@ -96,6 +101,8 @@ static int RemoveChunkLines(WDL_FastString* _chunk, const char* _searchStr,
 static int RemoveChunkLines(WDL_FastString* _chunk, WDL_PtrList<const char>* _searchStrs,
 							bool _checkBOL = false, int _checkEOLChar = 0);
 static int FindEndOfSubChunk(const char* _chunk, int _startPos);
+static bool GetPatchedBoolToken(bool _state, int _mode, int _idx, int _occurence,
+							const char* _value, const char* _valueExcept = NULL);
 
 static int SNM_PreObjectState(WDL_FastString* _str = NULL, bool _wantsMinState = false);
 static void SNM_PostObjectState(int _oldfxstate);
@@ -115,6 +122,16 @@ static int RemoveAllIds(WDL_FastString* _chunk) {
 // SNM_ChunkParserPatcher
 ///////////////////////////////////////////////////////////////////////////////
 
+// an indexed line of the cached chunk, see ParsePatchIndexed()
+typedef struct SNM_ChunkLine {
+	int pos, len;         // start position and length (without '\n') in the chunk
+	int kwOffset, kwLen;  // keyword (1st token), kwOffset is relative to pos
+	int depth;            // parsed depth, as in ParsePatchCore()
+	int parent;           // line that opened the current parent sub-chunk (-1: none)
+	int end;              // for sub-chunk start lines: the closing '>' line (-1: none)
+	int next;             // next line with the same keyword hash (-1: none)
+} SNM_ChunkLine;
+
 class SNM_ChunkParserPatcher
 {
 public:
@@ -137,6 +154,12 @@ SNM_ChunkParserPatcher(void* _reaObject, bool _autoCommit=true,
 	m_processInProjectMIDI = _processInProjectMIDI;
 	m_processFreeze = _processFreeze;
 	m_minimalState = false;
+	m_useIndex = -1;
+	m_getChunkInternal = false;
+	m_indexState = 0;
+	m_indexedChunk = NULL;
+	m_indexedData = NULL;
+	m_indexedLen = m_indexedFlags = 0;
 }
 
 // when attached to a WDL_FastString* (simple text chunk parser/patcher)
@@ -157,6 +180,12 @@ SNM_ChunkParserPatcher(WDL_FastString* _chunk, bool _autoCommit=true,
 	m_processInProjectMIDI = _processInProjectMIDI;
 	m_processFreeze = _processFreeze;
 	m_minimalState = false;
+	m_useIndex = -1;
+	m_getChunkInternal = false;
+	m_indexState = 0;
+	m_indexedChunk = NULL;
+	m_indexedData = NULL;
+	m_indexedLen = m_indexedFlags = 0;
 }
 
 virtual ~SNM_ChunkParserPatcher() 
@@ -219,6 +248,8 @@ virtual WDL_FastString* GetChunk()
 		else if (m_originalChunk)
 			m_chunk->Set(m_originalChunk);
 	}
+	if (!m_getChunkInternal)
+		m_indexState = 0; // the caller may alter the cached chunk directly
 	return m_chunk;
 }
 
@@ -272,7 +303,7 @@ virtual bool Commit(bool _force = false)
 }
 
 const char* GetInfo() {
-	return "SNM_ChunkParserPatcher - v1.34";
+	return "SNM_ChunkParserPatcher - v1.35";
 }
 
 void SetProcessBase64(bool _enable) {
@@ -291,6 +322,13 @@ void SetWantsMinimalState(bool _enable) {
 	m_minimalState = _enable;
 }
 
+// see ParsePatchIndexed()
+// _useIndex: 0 disabled, 1 enabled, -1 (default) enabled for SNM_ChunkParserPatcher
+//            instances only (subclasses may rely on Notify*() callbacks)
+void SetUseIndex(int _useIndex) {
+	m_useIndex = _useIndex;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Helpers
@@ -397,6 +435,7 @@ bool InsertAfterBefore(int _dir, const char* _str, const char* _parent, const ch
 		int pos = GetLinePos(_dir, _parent, _keyword, _depth, _occurence, _breakKeyword);
 		if (pos >= 0) {
 			m_chunk->Insert(_str, pos);
+			m_indexState = 0;
 			m_updates++;
 			return true;
 		}
@@ -531,6 +570,9 @@ bool WriteChunkLine(WDL_FastString* _chunkLine, const char* _value, int _tokenPo
 // Those callbacks are *always* triggered, except NotifyChunkLine() that 
 // is triggered depending on Parse() or ParsePatch() parameters/criteria 
 // => for optimization: the more criteria, the less calls!
+// Exception: none of them are triggered when built-in getter/setter modes
+// are answered by the line index, i.e. for subclasses that enabled it with
+// SetUseIndex(1), see ParsePatchIndexed()
 ///////////////////////////////////////////////////////////////////////////////
 
 virtual void NotifyStartChunk(int _mode) {}
@@ -561,6 +603,18 @@ virtual bool NotifySkippedSubChunk(int _mode,
 ///////////////////////////////////////////////////////////////////////////////
 private:
 
+	// line index of the cached chunk
+	int m_useIndex;
+	bool m_getChunkInternal;
+	int m_indexState; // 0: to be built, 1: valid, -1: chunk cannot be indexed
+	const WDL_FastString* m_indexedChunk;
+	const char* m_indexedData;
+	int m_indexedLen, m_indexedFlags;
+	WDL_FastString m_indexedCopy; // to detect in-place edits
+	WDL_TypedBuf<SNM_ChunkLine> m_lines;
+	std::map<unsigned int,int> m_keywords; // keyword hash -> first line
+
+
 // just to avoid duplicate strcmp() calls in ParsePatchCore()
 void IsMatchingParsedLine(bool* _tolerantMatch, bool* _strictMatch, 
 		int _expectedDepth, int _parsedDepth,
@@ -585,6 +639,535 @@ void IsMatchingParsedLine(bool* _tolerantMatch, bool* _strictMatch,
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Line index
+// Built once per cached chunk with the same skipping rules as ParsePatchCore()
+// so that the built-in getter/setter modes can jump to the searched lines
+// instead of re-parsing (and re-copying when patching) the whole chunk at each
+// call. The index is dropped as soon as the cached chunk may have been altered
+// behind its back (public GetChunk() calls, other chunk buffer, length or
+// content).
+// Chunks that ParsePatchCore() would silently alter when patching (empty,
+// too long, unparsable or unterminated lines, unbalanced sub-chunks) are not
+// indexed, so that both paths always give the same results.
+///////////////////////////////////////////////////////////////////////////////
+
+WDL_FastString* GetChunkInternal()
+{
+	m_getChunkInternal = true;
+	WDL_FastString* chunk = GetChunk();
+	m_getChunkInternal = false;
+	return chunk;
+}
+
+int GetIndexFlags() {
+	return (m_processBase64?1:0) | (m_processInProjectMIDI?2:0) | (m_processFreeze?4:0);
+}
+
+bool IsIndexEnabled() {
+	return (m_useIndex<0 ? typeid(*this) == typeid(SNM_ChunkParserPatcher) : m_useIndex>0);
+}
+
+static unsigned int HashKeyword(const char* _keyword, int _len)
+{
+	unsigned int h = 2166136261u; // FNV-1a
+	for (int i=0; i < _len; i++)
+		h = (h ^ (unsigned char)_keyword[i]) * 16777619u;
+	return h;
+}
+
+bool IsLineKeyword(int _line, const char* _keyword, int _len) {
+	const SNM_ChunkLine* l = m_lines.Get()+_line;
+	return (l->kwLen == _len && !memcmp(m_indexedData+l->pos+l->kwOffset, _keyword, _len));
+}
+
+// same as IsMatchingParsedLine()'s strict match
+bool IsIndexedLineMatching(int _line, int _depth, const char* _expectedParent, int _parentLen, const char* _keyword, int _len)
+{
+	const SNM_ChunkLine* l = m_lines.Get()+_line;
+	if (l->depth != _depth || l->parent < 0)
+		return false;
+	const SNM_ChunkLine* p = m_lines.Get()+l->parent;
+	return (p->kwLen == _parentLen+1 && !memcmp(m_indexedData+p->pos+p->kwOffset+1, _expectedParent, _parentLen) && // +1 to zap '<'
+		IsLineKeyword(_line, _keyword, _len));
+}
+
+// returns the first line with _keyword's hash, -1 if none (next ones: see SNM_ChunkLine.next)
+int GetFirstIndexedLine(const char* _keyword, int _len) {
+	std::map<unsigned int,int>::iterator it = m_keywords.find(HashKeyword(_keyword, _len));
+	return (it != m_keywords.end() ? it->second : -1);
+}
+
+// returns false if the chunk cannot be indexed (the line by line parser is used instead)
+bool BuildIndex(WDL_FastString* _chunk)
+{
+	m_lines.Resize(0, false);
+	m_keywords.clear();
+	m_indexedChunk = _chunk;
+	m_indexedData = _chunk->Get();
+	m_indexedLen = _chunk->GetLength();
+	m_indexedFlags = GetIndexFlags();
+	m_indexedCopy.Set(m_indexedData, m_indexedLen);
+
+	// unterminated last line: dropped by ParsePatchCore() when patching
+	if (m_indexedLen && m_indexedData[m_indexedLen-1] != '\n')
+		return false;
+
+	LineParser lp(false);
+	std::map<unsigned int,int> lastLines; // keyword hash -> last indexed line
+	WDL_TypedBuf<int> parents; // lines that opened the current parents
+	const char* cData = m_indexedData;
+	const char* pEOL = cData-1, *pLine, *pEOSkippedChunk;
+	bool isParsingSource = false;
+	int curLineLen;
+	for(;;)
+	{
+		pLine = pEOL+1;
+		pEOL = strchr(pLine, '\n');
+		if (!pEOL)
+			break;
+
+		curLineLen = (int)(pEOL-pLine);
+
+		// skip the same data and sub-chunks as ParsePatchCore()
+		pEOSkippedChunk = NULL;
+		if (!m_processBase64 &&
+			curLineLen>2 && *(pEOL-1)=='=' && *(pEOL-2)=='=')
+		{
+			pEOSkippedChunk = strstr(pLine, ">\n");
+		}
+		else if (!m_processInProjectMIDI && isParsingSource && (
+			(curLineLen>2 && !_strnicmp(pLine, "E ", 2)) ||
+			(curLineLen>3 && !_strnicmp(pLine, "Em ", 3))))
+		{
+			pEOSkippedChunk = strstr(pLine, "GUID {");
+		}
+		else if (!m_processFreeze && parents.GetSize()==1 && 
+			curLineLen>8 && !strncmp(pLine, "<FREEZE ", 8))
+		{
+			int skippedLen = FindEndOfSubChunk(pLine, 0);
+			while (skippedLen >= 0) // in case of multiple freeze
+			{
+				pEOSkippedChunk = (char*)(pLine+skippedLen);
+				if (!strncmp(pEOSkippedChunk, "<FREEZE ", 8))
+					skippedLen = FindEndOfSubChunk(pLine, skippedLen);
+				else
+					skippedLen = -1;
+			}
+		}
+
+		if (pEOSkippedChunk)
+		{
+			pLine = pEOSkippedChunk;
+			pEOL = strchr(pEOSkippedChunk, '\n');
+			if (!pEOL)
+				return false;
+			curLineLen = (int)(pEOL-pLine);
+		}
+
+		// lines that ParsePatchCore() would trim or zap
+		if (curLineLen >= SNM_MAX_CHUNK_LINE_LENGTH || (curLineLen && *(pEOL-1)=='\r'))
+			return false;
+
+		// keyword, i.e. 1st token
+		const char* kw = pLine;
+		while (kw<pEOL && (*kw==' ' || *kw=='\t')) kw++;
+		if (kw == pEOL || *kw=='"' || *kw=='\'' || *kw=='`' || *kw=='#' || *kw==';')
+			return false;
+		const char* kwEnd = kw;
+		while (kwEnd<pEOL && *kwEnd!=' ' && *kwEnd!='\t') kwEnd++;
+
+		// quoted tokens: check the line is tokenized as expected
+		bool quoted = false;
+		for (const char* p=kwEnd; !quoted && p<pEOL; p++)
+			quoted = (*p=='"' || *p=='\'' || *p=='`');
+		if (quoted)
+		{
+			char curLine[SNM_MAX_CHUNK_LINE_LENGTH];
+			memcpy(curLine, pLine, curLineLen);
+			curLine[curLineLen] = '\0';
+			if (lp.parse(curLine) || !lp.getnumtokens() || 
+				(int)strlen(lp.gettoken_str(0)) != (int)(kwEnd-kw) || strncmp(lp.gettoken_str(0), kw, kwEnd-kw))
+			{
+				return false;
+			}
+		}
+
+		SNM_ChunkLine l;
+		l.pos = (int)(pLine-cData);
+		l.len = curLineLen;
+		l.kwOffset = (int)(kw-pLine);
+		l.kwLen = (int)(kwEnd-kw);
+		l.end = -1;
+		l.next = -1;
+		int line = m_lines.GetSize();
+
+		// sub chunk?
+		if (*kw == '<')
+		{
+			if (!isParsingSource && l.kwLen==7 && curLineLen>9 /* e.g. <SOURCE MIDI*/ && !strncmp(kw, "<SOURCE", 7))
+			{
+				char curLine[SNM_MAX_CHUNK_LINE_LENGTH];
+				memcpy(curLine, pLine, curLineLen);
+				curLine[curLineLen] = '\0';
+				isParsingSource = (!lp.parse(curLine) && lp.getnumtokens()==2);
+			}
+			parents.Add(line);
+		}
+		// end of sub chunk?
+		else if (*kw == '>' && parents.GetSize())
+		{
+			int opening = parents.Get()[parents.GetSize()-1];
+			if (isParsingSource)
+				isParsingSource = !IsLineKeyword(opening, "<SOURCE", 7);
+			m_lines.Get()[opening].end = line;
+			parents.Resize(parents.GetSize()-1, false);
+		}
+
+		l.depth = parents.GetSize();
+		l.parent = l.depth ? parents.Get()[l.depth-1] : -1;
+
+		// chain lines sharing the same keyword (hash)
+		unsigned int h = HashKeyword(kw, l.kwLen);
+		std::map<unsigned int,int>::iterator it = lastLines.find(h);
+		if (it != lastLines.end()) {
+			m_lines.Get()[it->second].next = line;
+			it->second = line;
+		}
+		else
+			m_keywords[h] = lastLines[h] = line;
+		m_lines.Add(l);
+	}
+	return !parents.GetSize(); // unbalanced sub-chunks: not indexed
+}
+
+// (re)builds the index if needed, returns false if not usable
+bool UpdateIndex()
+{
+	WDL_FastString* chunk = GetChunkInternal();
+	if (m_indexState && (m_indexedChunk != chunk || m_indexedData != chunk->Get() || 
+		m_indexedLen != chunk->GetLength() || m_indexedFlags != GetIndexFlags() ||
+		memcmp(m_indexedCopy.Get(), chunk->Get(), m_indexedLen))) // same length in-place edits
+	{
+		m_indexState = 0;
+	}
+	if (!m_indexState)
+		m_indexState = BuildIndex(chunk) ? 1 : -1;
+	return (m_indexState == 1);
+}
+
+// tokenizes an indexed line
+// _curLine: working copy of the line, SNM_MAX_CHUNK_LINE_LENGTH long (trimmed 
+//           as in ParsePatchCore(), even if longer lines are not indexed)
+int ParseIndexedLine(int _line, char* _curLine, LineParser* _lp)
+{
+	const SNM_ChunkLine* l = m_lines.Get()+_line;
+	int len = min(l->len, SNM_MAX_CHUNK_LINE_LENGTH-1);
+	memcpy(_curLine, m_indexedData+l->pos, len);
+	_curLine[len] = '\0';
+	return _lp->parse(_curLine);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ParsePatchIndexed()
+// Fast path of ParsePatchCore() for the built-in getter/setter modes: matching
+// lines are looked up in the line index and edits are spliced into a new chunk
+// in one pass (untouched parts are bulk copied). Line edits keep the index in
+// sync, sub-chunk replacements drop it.
+// Notes:
+// - Notify*() callbacks are not triggered, so the index is only used by
+//   SNM_ChunkParserPatcher instances by default (see SetUseIndex())
+// - returns false if the request must go through ParsePatchCore(), otherwise
+//   *_retVal and the patched chunk are exactly what ParsePatchCore() returns
+//   and builds
+///////////////////////////////////////////////////////////////////////////////
+
+bool ParsePatchIndexed(bool _write, int _mode, int _depth, const char* _expectedParent, const char* _keyWord,
+	int _occurence, int _tokenPos, void* _value, void* _valueExcept, const char* _breakKeyword, int* _retVal)
+{
+	switch (_mode)
+	{
+		case SNM_GET_CHUNK_CHAR:
+		case SNM_GET_SUBCHUNK_OR_LINE:
+		case SNM_GET_SUBCHUNK_OR_LINE_EOL:
+		case SNM_COUNT_KEYWORD:
+			break;
+		case SNM_GETALL_CHUNK_CHAR_EXCEPT:
+			if (!_value) return false;
+			break;
+		case SNM_SET_CHUNK_CHAR:
+		case SNM_SETALL_CHUNK_CHAR_EXCEPT:
+		case SNM_D_ADD:
+		case SNM_D_MUL:
+			if (!_write || !_value) return false;
+			break;
+		case SNM_TOGGLE_CHUNK_INT:
+		case SNM_TOGGLE_CHUNK_INT_EXCEPT:
+			if (!_write) return false;
+			break;
+		case SNM_REPLACE_SUBCHUNK_OR_LINE:
+			// break keywords are ignored in replaced sub-chunks: not worth it
+			if (!_write || !_value || _breakKeyword) return false;
+			break;
+		default:
+			return false;
+	}
+
+	// m_breakParsePatch set by a subclass: ParsePatchCore() stops at once
+	if (m_breakParsePatch || !IsIndexEnabled() || !UpdateIndex())
+		return false;
+
+	// matching lines, in chunk order
+	WDL_TypedBuf<int> matches;
+	if (_keyWord && _expectedParent && _depth > 0)
+	{
+		int kwLen = (int)strlen(_keyWord), parentLen = (int)strlen(_expectedParent);
+		int breakLine = m_lines.GetSize();
+		if (_breakKeyword)
+		{
+			// brutal: no check on depth, parent, etc.. (see ParsePatchCore())
+			int breakLen = (int)strlen(_breakKeyword);
+			for (int i=GetFirstIndexedLine(_breakKeyword, breakLen); i>=0; i=m_lines.Get()[i].next)
+				if (m_lines.Get()[i].depth>0 && IsLineKeyword(i, _breakKeyword, breakLen) &&
+					!IsIndexedLineMatching(i, _depth, _expectedParent, parentLen, _keyWord, kwLen))
+				{
+					breakLine = i;
+					break;
+				}
+		}
+		for (int i=GetFirstIndexedLine(_keyWord, kwLen); i>=0 && i<breakLine; i=m_lines.Get()[i].next)
+			if (IsIndexedLineMatching(i, _depth, _expectedParent, parentLen, _keyWord, kwLen))
+				matches.Add(i);
+	}
+
+	const char* cData = m_indexedData;
+	SNM_ChunkLine* lines = m_lines.Get();
+	const int* match = matches.Get();
+	int nbMatches = matches.GetSize();
+	LineParser lp(false);
+	char curLine[SNM_MAX_CHUNK_LINE_LENGTH] = "";
+
+	switch (_mode)
+	{
+		// *** READ ONLY ***
+		case SNM_COUNT_KEYWORD:
+			*_retVal = nbMatches;
+			return true;
+
+		case SNM_GETALL_CHUNK_CHAR_EXCEPT:
+			*_retVal = 1; // found, unless..
+			for (int i=0; i < nbMatches; i++)
+				if (_occurence != -1 && _occurence != i &&
+					!ParseIndexedLine(match[i], curLine, &lp) && strcmp((char*)_value, lp.gettoken_str(_tokenPos)))
+				{
+					*_retVal = 0; // .. 1st unmatching
+					break;
+				}
+			return true;
+
+		case SNM_GET_CHUNK_CHAR:
+		case SNM_GET_SUBCHUNK_OR_LINE:
+		case SNM_GET_SUBCHUNK_OR_LINE_EOL:
+		{
+			*_retVal = 0; // not found
+			int occurence = (_occurence == -1 ? 0 : _occurence);
+			if (occurence < 0 || occurence >= nbMatches)
+				return true;
+
+			const SNM_ChunkLine* l = lines+match[occurence];
+			if (_mode == SNM_GET_CHUNK_CHAR)
+			{
+				if (_value) {
+					ParseIndexedLine(match[occurence], curLine, &lp);
+					strcpy((char*)_value, lp.gettoken_str(_tokenPos));
+				}
+				*_retVal = l->pos+l->kwOffset+1; // *KEYWORD* position + 1
+				return true;
+			}
+
+			// sub-chunk: from the keyword line to the matching '>' line (all
+			// sub-chunks of indexed chunks are closed), recopied as ">\n"
+			int endPos = l->pos+l->len;
+			if (*_keyWord == '<' && (_value || _mode == SNM_GET_SUBCHUNK_OR_LINE_EOL))
+			{
+				endPos = lines[l->end].pos+lines[l->end].len;
+				if (_value) {
+					((WDL_FastString*)_value)->Append(cData+l->pos, lines[l->end].pos-l->pos);
+					((WDL_FastString*)_value)->Append(">\n", 2);
+				}
+			}
+			else if (_value) {
+				((WDL_FastString*)_value)->Append(cData+l->pos, l->len);
+				((WDL_FastString*)_value)->Append("\n");
+			}
+			*_retVal = (_mode == SNM_GET_SUBCHUNK_OR_LINE ? l->pos+l->kwOffset+1 : endPos+1); // *KEYWORD* or *EOL* position + 1
+			return true;
+		}
+	}
+
+	// *** R/W ***
+	// edits are collected in chunk order, then spliced
+	WDL_TypedBuf<int> editPos, editLen, editedLines;
+	WDL_PtrList_DeleteOnDestroy<WDL_FastString> editStrs;
+	int updates = 0;
+
+	if (_mode == SNM_REPLACE_SUBCHUNK_OR_LINE)
+	{
+		int prevEnd = 0;
+		for (int i=0; i < nbMatches; i++)
+		{
+			if (_occurence != -1 && _occurence != i)
+				continue;
+			const SNM_ChunkLine* l = lines+match[i];
+			if (l->pos < prevEnd)
+				continue; // in a replaced sub-chunk
+			int endPos = l->pos+l->len+1, nbLines = 1;
+			if (*_keyWord == '<') {
+				endPos = lines[l->end].pos+lines[l->end].len+1;
+				nbLines = l->end-match[i]+1;
+			}
+			editPos.Add(l->pos);
+			editLen.Add(endPos-l->pos);
+			editStrs.Add(new WDL_FastString((const char*)_value));
+			updates += nbLines;
+			prevEnd = endPos;
+		}
+	}
+	else
+	{
+		// only the specified occurrence is processed, except with "EXCEPT" modes
+		int from = 0, to = nbMatches;
+		if (_occurence != -1 && _mode != SNM_SETALL_CHUNK_CHAR_EXCEPT && _mode != SNM_TOGGLE_CHUNK_INT_EXCEPT) {
+			from = _occurence;
+			to = (_occurence >= 0 ? min(_occurence+1, nbMatches) : 0);
+		}
+
+		for (int i=from; i < to; i++)
+		{
+			if (ParseIndexedLine(match[i], curLine, &lp) || !lp.getnumtokens())
+				continue;
+
+			bool thisOccurence = (_occurence == -1 || _occurence == i);
+			const char* val = NULL;
+			char bufConv[64] = "";
+			switch (_mode)
+			{
+				case SNM_SET_CHUNK_CHAR:
+					val = (const char*)_value;
+					break;
+				case SNM_SETALL_CHUNK_CHAR_EXCEPT:
+					val = (const char*)(thisOccurence ? _valueExcept : _value);
+					break;
+				case SNM_TOGGLE_CHUNK_INT:
+				case SNM_TOGGLE_CHUNK_INT_EXCEPT:
+					if (thisOccurence && _mode == SNM_TOGGLE_CHUNK_INT_EXCEPT)
+						val = (const char*)_valueExcept;
+					else if (_snprintf(bufConv, sizeof(bufConv), "%d", !lp.gettoken_int(_tokenPos)) > 0)
+						val = bufConv;
+					break;
+				case SNM_D_ADD:
+				case SNM_D_MUL:
+				{
+					int success; double d = lp.gettoken_float(_tokenPos, &success);
+					if (success) {
+						if (_mode == SNM_D_ADD) d += *(double*)_value;
+						else d *= *(double*)_value;
+						int l = _snprintf(bufConv, sizeof(bufConv), "%.14f", d);
+						if (l>0 && l<64)
+							val = bufConv;
+					}
+				}
+				break;
+			}
+
+			if (val)
+			{
+				// out of range token: ParsePatchCore() would recopy the line twice
+				if (_tokenPos < 0 || _tokenPos >= lp.getnumtokens())
+					return false;
+
+				WDL_FastString* newLine = new WDL_FastString;
+				if (WriteChunkLine(newLine, val, _tokenPos, &lp))
+				{
+					editPos.Add(lines[match[i]].pos);
+					editLen.Add(lines[match[i]].len+1);
+					editedLines.Add(match[i]);
+					editStrs.Add(newLine);
+					updates++;
+				}
+				else
+					delete newLine;
+			}
+		}
+	}
+
+	*_retVal = updates;
+	if (!updates)
+		return true;
+
+	// splice
+	WDL_FastString* newChunk = new WDL_FastString(SNM_HEAPBUF_GRANUL);
+	int lastPos = 0;
+	for (int i=0; i < editPos.GetSize(); i++)
+	{
+		if (editPos.Get()[i] > lastPos)
+			newChunk->Append(cData+lastPos, editPos.Get()[i]-lastPos);
+		newChunk->Append(editStrs.Get(i)->Get(), editStrs.Get(i)->GetLength());
+		lastPos = editPos.Get()[i]+editLen.Get()[i];
+	}
+	if (m_indexedLen > lastPos)
+		newChunk->Append(cData+lastPos, m_indexedLen-lastPos);
+
+	if (!newChunk->GetLength()) { // as ParsePatchCore()
+		delete newChunk;
+		return true;
+	}
+
+	m_updates += updates;
+	WDL_FastString* oldChunk = m_chunk;
+	m_chunk = newChunk;
+	delete oldChunk;
+
+	// keep the index in sync with line edits (same keyword, one line each)
+	bool keepIndex = (editedLines.GetSize() && _tokenPos > 0);
+	for (int i=0; keepIndex && i < editedLines.GetSize(); i++)
+	{
+		const WDL_FastString* newLine = editStrs.Get(i);
+		int len = newLine->GetLength();
+		keepIndex = (!lines[editedLines.Get()[i]].kwOffset && // left trimmed
+			*newLine->Get() != '<' && // no <SOURCE token count change
+			len <= SNM_MAX_CHUNK_LINE_LENGTH && // not trimmed, see BuildIndex()
+			strchr(newLine->Get(), '\n') == newLine->Get()+len-1 && // single line
+			!strpbrk(newLine->Get(), "\"'`\r") && // tokenized as expected
+			(len<3 || newLine->Get()[len-2]!='=' || newLine->Get()[len-3]!='=')); // not skipped as base64 data
+	}
+
+	if (keepIndex)
+	{
+		int delta = 0, edit = 0;
+		for (int i=editedLines.Get()[0]; i < m_lines.GetSize(); i++)
+		{
+			lines[i].pos += delta;
+			if (edit < editedLines.GetSize() && editedLines.Get()[edit] == i)
+			{
+				int newLen = editStrs.Get(edit)->GetLength()-1; // -1 for '\n'
+				delta += newLen-lines[i].len;
+				lines[i].len = newLen;
+				edit++;
+			}
+		}
+		m_indexedChunk = m_chunk;
+		m_indexedData = m_chunk->Get();
+		m_indexedLen = m_chunk->GetLength();
+		m_indexedCopy.Set(m_indexedData, m_indexedLen);
+	}
+	else
+		m_indexState = 0;
+
+	return true;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // ParsePatchCore()
 // Globally, the func is tolerant; the less parameters provided, the more parsed
@@ -633,8 +1216,13 @@ int ParsePatchCore(
 		return -1;
 #endif
 
+	// built-in getter/setter modes: use the line index if possible
+	int indexedRetVal;
+	if (ParsePatchIndexed(_write, _mode, _depth, _expectedParent, _keyWord, _occurence, _tokenPos, _value, _valueExcept, _breakKeyword, &indexedRetVal))
+		return indexedRetVal;
+
 	// get/cache the chunk
-	const char* cData = GetChunk() ? GetChunk()->Get() : NULL;
+	const char* cData = GetChunkInternal()->Get();
 	if (!cData)
 		return -1;
 
@@ -1091,6 +1679,28 @@ static const char* FindKeyword(const char* _chunk) {
 	return NULL;
 }
 
+// returns the new value of the 0/1 token of occurence _idx, i.e. what 
+// ParsePatch(_mode, ..., _occurence, ..., _value, _valueExcept) would write
+// (toggle and set modes only), so that callers using a native API rather
+// than the chunk (e.g. FX online/offline) give the same results
+static bool GetPatchedBoolToken(bool _state, int _mode, int _idx, int _occurence, const char* _value, const char* _valueExcept)
+{
+	switch (_mode)
+	{
+		case SNM_TOGGLE_CHUNK_INT:
+			return _idx == _occurence ? !_state : _state;
+		case SNM_TOGGLE_CHUNK_INT_EXCEPT:
+			return _idx != _occurence ? !_state : _state;
+		case SNM_SET_CHUNK_CHAR:
+			return _idx == _occurence && _value ? !!atoi(_value) : _state;
+		case SNM_SETALL_CHUNK_CHAR_EXCEPT:
+			if (_idx != _occurence)
+				return _value ? !!atoi(_value) : _state;
+			return _valueExcept ? !!atoi(_valueExcept) : _state;
+	}
+	return _state;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // Other static helpers
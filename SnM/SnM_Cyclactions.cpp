@@ -452,6 +452,29 @@ int ExplodeConsoleAction(int _section, const char* _cmdStr,
 // Perform cycle actions
 ///////////////////////////////////////////////////////////////////////////////
 
+// assumes _cmdId is registered in _kbdSec
+int PerformCommandId(int _section, KbdSectionInfo* _kbdSec, int _cmdId, int _val, int _valhw, int _relmode, HWND _hwnd)
+{
+	// can't just rely on kbdSec->onAction() because some actions
+	// depend on the current focused window, etc
+	switch (_section)
+	{
+		case SNM_SEC_IDX_MAIN:
+			return KBD_OnMainActionEx(_cmdId, _val, _valhw, _relmode, _hwnd, NULL);
+		case SNM_SEC_IDX_ME:
+		case SNM_SEC_IDX_ME_EL:
+			return MIDIEditor_LastFocused_OnCommand(_cmdId, _section==SNM_SEC_IDX_ME_EL);
+		case SNM_SEC_IDX_EPXLORER:
+			if (HWND h = GetReaHwndByTitle(__localizeFunc("Media Explorer", "explorer", 0))) {
+				SendMessage(h, WM_COMMAND, _cmdId, 0);
+				return 1;
+			}
+			return 0;
+		default:
+			return _kbdSec->onAction(_cmdId, _val, _valhw, _relmode, _hwnd);
+	}
+}
+
 // assumes _cmdStr is valid and has been "exploded", if needed
 int PerformSingleCommand(int _section, const char* _cmdStr, int _val, int _valhw, int _relmode, HWND _hwnd)
 {
@@ -467,25 +490,8 @@ int PerformSingleCommand(int _section, const char* _cmdStr, int _val, int _valhw
 
 		// SNM_NamedCommandLookup hard check: the command MUST be registered
 		if (int cmdId = SNM_NamedCommandLookup(_cmdStr, kbdSec, true))
-	{
-			// can't just rely on kbdSec->onAction() because some actions
-			// depend on the current focused window, etc
-			switch (_section)
-			{
-				case SNM_SEC_IDX_MAIN:
-					return KBD_OnMainActionEx(cmdId, _val, _valhw, _relmode, _hwnd, NULL);
-				case SNM_SEC_IDX_ME:
-				case SNM_SEC_IDX_ME_EL:
-					return MIDIEditor_LastFocused_OnCommand(cmdId, _section==SNM_SEC_IDX_ME_EL);
-				case SNM_SEC_IDX_EPXLORER:
-					if (HWND h = GetReaHwndByTitle(__localizeFunc("Media Explorer", "explorer", 0))) {
-						SendMessage(h, WM_COMMAND, cmdId, 0);
-						return 1;
-					}
-					return 0;
-				default:
-					return kbdSec->onAction(cmdId, _val, _valhw, _relmode, _hwnd);
-			}
+		{
+			return PerformCommandId(_section, kbdSec, cmdId, _val, _valhw, _relmode, _hwnd);
 		}
 		// custom console command?
 		// note: authorized in any section
@@ -517,6 +523,236 @@ int PerformSingleCommand(int _section, const char* _cmdStr, int _val, int _valhw
 	return 0;
 }
 
+
+///////////////////////////////////////////////////////////////////////////////
+// Compiled cycle actions
+//
+// Cycle points are compiled once (lazily, on 1st run after a load or an edit)
+// into flat instruction lists: command ids are resolved and conditional 
+// statements get their jump indexes, so that running a CA does not re-parse
+// its definition nor look up each command in the action list.
+// Compiled CAs are invalidated when cycle actions are (un)registered, see 
+// g_caCompileGen, other command ids are re-checked before being performed.
+// Cycle points calling other CAs are not compiled (sub-CAs have their own
+// cycle points) and are exploded at run time, as before.
+///////////////////////////////////////////////////////////////////////////////
+
+enum {
+  CA_OP_NOP=0,
+  CA_OP_CMD,
+  CA_OP_COND,
+  CA_OP_ELSE,
+  CA_OP_LOOP,
+  CA_OP_ENDLOOP
+};
+
+// bumped when actions are (un)registered, invalidates all compiled CAs
+int g_caCompileGen = 0;
+
+// same as the "zap commands until next ELSE/ENDIF" loops of the interpreter: 
+// returns the index of the found statement, or _step size if not found
+int FindCompiledStatement(CyclactionStep* _step, int _idx, bool _else)
+{
+	while (++_idx < _step->m_instrs.GetSize())
+	{
+		const char* cmd = _step->m_instrs.Get(_idx)->m_cmd.Get();
+		if ((_else && !_stricmp(STATEMENT_ELSE, cmd)) || !_stricmp(STATEMENT_ENDIF, cmd))
+			break;
+	}
+	return _idx;
+}
+
+// _startIdx: see Cyclaction::GetStepIdx()
+// note: each instruction is decoded independently (i.e. even when it is
+// also the condition of a previous IF statement) to stick to the interpreter
+CyclactionStep* CompileCyclactionStep(int _section, Cyclaction* _a, int _startIdx)
+{
+	KbdSectionInfo* kbdSec = SNM_GetActionSection(_section);
+	if (!kbdSec || _startIdx<0)
+		return NULL;
+
+	CyclactionStep* step = new CyclactionStep;
+
+	// same cycle point boundaries as ExplodeCyclaction()
+	for (int i=_startIdx; i<_a->GetCmdSize(); i++)
+	{
+		const char* cmd = _a->GetCmd(i);
+		if (*cmd && *cmd != '!')
+		{
+			if (*cmd == '_' && strstr(cmd, "_CYCLACTION"))
+				step->m_dynamic = true;
+			step->m_instrs.Add(new CyclactionInstr(CA_OP_NOP, cmd));
+		}
+
+		if (i == (_a->GetCmdSize()-1)) {
+			step->m_last = true;
+			break;
+		}
+		else if (*cmd == '!')
+			break;
+	}
+
+	if (step->m_dynamic)
+		return step;
+
+	const int sz = step->m_instrs.GetSize();
+	for (int i=0; i<sz; i++)
+	{
+		CyclactionInstr* instr = step->m_instrs.Get(i);
+		const char* cmd = instr->m_cmd.Get();
+		if (IsCondStatement(cmd))
+		{
+			int nbConds = IsTwoCondStatement(cmd) ? 2 : 1;
+			if ((i+nbConds) < sz) // ignored otherwise
+			{
+				instr->m_op = CA_OP_COND;
+				instr->m_stmt = IsStatement(cmd);
+				for (int j=0; j<nbConds; j++)
+					instr->m_condIds[j] = SNM_NamedCommandLookup(step->m_instrs.Get(i+1+j)->m_cmd.Get(), kbdSec);
+				instr->m_jump = FindCompiledStatement(step, i+nbConds, true);
+				instr->m_jump2 = FindCompiledStatement(step, i+nbConds, false);
+			}
+		}
+		else if (!_stricmp(STATEMENT_ELSE, cmd))
+		{
+			instr->m_op = CA_OP_ELSE;
+			instr->m_jump = FindCompiledStatement(step, i, false);
+		}
+		else if (!_strnicmp(STATEMENT_LOOP, cmd, strlen(STATEMENT_LOOP)))
+		{
+			instr->m_op = CA_OP_LOOP;
+			if (strlen(cmd) > strlen(STATEMENT_LOOP))
+			{
+				const char* param = cmd+strlen(STATEMENT_LOOP)+1; // +1 for the space char in "LOOP n"
+				instr->m_loopCnt = (*param=='x' || *param=='X') ? -1 : atoi(param);
+			}
+			else
+				instr->m_loopCnt = 0;
+		}
+		else if (!_stricmp(STATEMENT_ENDLOOP, cmd))
+			instr->m_op = CA_OP_ENDLOOP;
+		else if (!_stricmp(STATEMENT_ENDIF, cmd))
+			instr->m_op = CA_OP_NOP;
+		else
+		{
+			instr->m_op = CA_OP_CMD;
+			// hard check, see PerformSingleCommand(): 0 for console/label
+			// statements, or for actions that are not registered (yet)
+			instr->m_cmdId = SNM_NamedCommandLookup(cmd, kbdSec, true);
+		}
+	}
+	return step;
+}
+
+int GetCompiledCondState(KbdSectionInfo* _kbdSec, CyclactionStep* _step, int _idx, int _cond)
+{
+	CyclactionInstr* instr = _step->m_instrs.Get(_idx);
+	int cmdId = instr->m_condIds[_cond];
+	if (!cmdId) // not registered at compile time?
+		cmdId = SNM_NamedCommandLookup(_step->m_instrs.Get(_idx+1+_cond)->m_cmd.Get(), _kbdSec);
+	return GetToggleCommandState2(_kbdSec, cmdId);
+}
+
+// cached command ids go stale when actions get unregistered meanwhile (removed
+// ReaScripts, S&M dynamic actions, other extensions..): same hard check as
+// SNM_NamedCommandLookup() but without the action list lookup
+bool IsCompiledCmdRegistered(KbdSectionInfo* _kbdSec, int _cmdId)
+{
+	const char* desc = kbd_getTextFromCmd(_cmdId, _kbdSec);
+	return desc && *desc;
+}
+
+// runs a compiled cycle point, same behavior as the interpreter in RunCycleAction()
+// returns the number of performed commands
+int RunCompiledStep(int _section, KbdSectionInfo* _kbdSec, CyclactionStep* _step, const char* _undoStr, int _val, int _valhw, int _relmode, HWND _hwnd)
+{
+	int loopCnt = -1;
+	WDL_PtrList<CyclactionInstr> allCmds, loopCmds;
+	const int sz = _step->m_instrs.GetSize();
+	for (int i=0; i<sz; i++)
+	{
+		CyclactionInstr* instr = _step->m_instrs.Get(i);
+		switch (instr->m_op)
+		{
+			case CA_OP_COND:
+			{
+				bool twoConds = instr->m_stmt>=IDX_STATEMENT_IFAND;
+				bool isON = (instr->m_stmt==IDX_STATEMENT_IF || instr->m_stmt==IDX_STATEMENT_IFAND ||
+					instr->m_stmt==IDX_STATEMENT_IFOR || instr->m_stmt==IDX_STATEMENT_IFXOR);
+
+				int tgl = GetCompiledCondState(_kbdSec, _step, i, 0);
+				if (twoConds)
+				{
+					int tgl2 = GetCompiledCondState(_kbdSec, _step, i, 1);
+					if (instr->m_stmt==IDX_STATEMENT_IFAND || instr->m_stmt==IDX_STATEMENT_IFNAND)
+						tgl = (tgl && tgl2) ? 1 : 0;
+					else if (instr->m_stmt==IDX_STATEMENT_IFOR || instr->m_stmt==IDX_STATEMENT_IFNOR)
+						tgl = (tgl || tgl2) ? 1 : 0;
+					else
+						tgl = (tgl ^ tgl2) ? 1 : 0;
+				}
+
+				if (tgl>=0)
+					i = (isON ? tgl==0 : tgl==1) ? instr->m_jump : i+(twoConds?2:1);
+				else
+					i = instr->m_jump2;
+				break;
+			}
+			case CA_OP_ELSE:
+				i = instr->m_jump;
+				break;
+			case CA_OP_LOOP:
+				if (instr->m_loopCnt<0) {
+					loopCnt = PromptForInteger(_undoStr, __LOCALIZE("Number of times to repeat","sws_DLG_161"), 0, 4096, false);
+					loopCnt++; // 0-based => 1-based + ignore the loop if user has cancelled
+				}
+				else
+					loopCnt = instr->m_loopCnt;
+				break;
+			case CA_OP_ENDLOOP:
+				if (loopCnt>=0)
+				{
+					for (int j=0; j<loopCnt; j++)
+						for (int k=0; k<loopCmds.GetSize(); k++)
+							allCmds.Add(loopCmds.Get(k));
+					loopCmds.Empty(false);
+					loopCnt = -1;
+				}
+				break;
+			case CA_OP_CMD:
+				if (loopCnt > 0)
+					loopCmds.Add(instr);
+				else if (loopCnt == -1)
+					allCmds.Add(instr);
+				break;
+		}
+	}
+
+	if (allCmds.GetSize())
+	{
+		if (g_undos)
+			Undo_BeginBlock2(NULL);
+
+		for (int i=0; i<allCmds.GetSize(); i++)
+		{
+			CyclactionInstr* instr = allCmds.Get(i);
+			if (instr->m_cmdId && !IsCompiledCmdRegistered(_kbdSec, instr->m_cmdId))
+				instr->m_cmdId = 0; // unregistered since compilation, look it up from now on
+
+			if (instr->m_cmdId)
+				PerformCommandId(_section, _kbdSec, instr->m_cmdId, _val, _valhw, _relmode, _hwnd);
+			else // console/label statements, late registered or unregistered actions
+				PerformSingleCommand(_section, instr->m_cmd.Get(), _val, _valhw, _relmode, _hwnd);
+		}
+
+		if (g_undos)
+			Undo_EndBlock2(NULL, _undoStr, UNDO_STATE_ALL);
+
+		RefreshToolbar(0); // not strictly needed, except for toggle states of CAs calling other CAs
+	}
+	return allCmds.GetSize();
+}
+
 // assumes the CA is valid (e.g. no recursion) + its statements are valid + etc..
 // (faulty CAs must not be registered at this point, see CheckRegisterableCyclaction())
 void RunCycleAction(COMMAND_T* _ct, int _val, int _valhw, int _relmode, HWND _hwnd)
@@ -533,11 +769,25 @@ void RunCycleAction(COMMAND_T* _ct, int _val, int _valhw, int _relmode, HWND _hw
 	if (!kbdSec) 
 		return;
 
+	double runTime = time_precise();
 	for (;;)
 	{
 		// store step or action name *before* m_performState update
 		const char* undoStr = action->GetStepName();
 
+		CyclactionStep* step = action->GetCompiledStep(sec, action->m_performState);
+		if (step && !step->m_dynamic)
+		{
+			// same m_performState update as ExplodeCyclaction()
+			action->m_performState = step->m_last ? 0 : action->m_performState+1;
+			action->m_fakeToggle = !action->m_fakeToggle;
+
+			// (try to) switch to the next action step if nothing has been performed, see below
+			if (RunCompiledStep(sec, kbdSec, step, undoStr, _val, _valhw, _relmode, _hwnd) || !action->m_performState)
+				break;
+			continue;
+		}
+
 		WDL_PtrList_DeleteOnDestroy<WDL_FastString> subCmds;
 		if (ExplodeCyclaction(sec, _ct->id, &subCmds, NULL, NULL, 0x1, action) > 0) // 0x1!
 		{
@@ -672,7 +922,11 @@ void RunCycleAction(COMMAND_T* _ct, int _val, int _valhw, int _relmode, HWND _hw
 					break;
 			}
 		} // if (ExplodeCyclaction())
+		else
+			break; // would loop forever otherwise
 	} // for(;;)
+
+	action->AddRunTime(time_precise()-runTime);
 }
 
 int IsCyclactionEnabled(COMMAND_T* _ct)
@@ -1015,6 +1269,7 @@ int RegisterCyclation(const char* _name, int _section, int _cycleId, int _cmdId)
 	char custId[SNM_MAX_ACTION_CUSTID_LEN]="";
 	if (_snprintfStrict(custId, sizeof(custId), "%s%d", GetCACustomId(_section), _cycleId) > 0)
 	{
+		g_caCompileGen++; // compiled CAs might refer to this action
 		return SWSCreateRegisterDynamicCmd(
 			SNM_GetActionSectionUniqueId(_section),
 			_cmdId,
@@ -1073,6 +1328,7 @@ void FlushCyclactions(int _section)
 			a->m_cmdId = 0;
 		}
 	g_cas[_section].EmptySafe(true);
+	g_caCompileGen++;
 }
 
 // _cyclactions: NULL to add/register to the main model, imports into _cyclactions otherwise
@@ -1298,6 +1554,7 @@ void Cyclaction::ReplaceCmd(WDL_FastString* _cmd, bool _wantDelete, WDL_PtrList<
 
 void Cyclaction::UpdateNameAndCmds()
 {
+	InvalidateCompiled();
 	m_cmds.EmptySafe(false); // to be deleted by callers (might be used in a list view)
 
 	char actionStr[CA_MAX_LEN] = "";
@@ -1314,6 +1571,7 @@ void Cyclaction::UpdateNameAndCmds()
 
 void Cyclaction::UpdateFromCmd()
 {
+	InvalidateCompiled();
 	WDL_FastString newDef;
 	if (int tgl=IsToggle())
 		newDef.SetFormatted(CA_MAX_LEN, "%c", tgl==1?CA_TGL1:CA_TGL2);
@@ -1326,6 +1584,34 @@ void Cyclaction::UpdateFromCmd()
 	m_def.Set(&newDef);
 }
 
+// returns the compiled cycle point _performState, or NULL if it cannot be
+// compiled (the CA must be exploded at run time in this case)
+// compiles all cycle points at once, if needed
+CyclactionStep* Cyclaction::GetCompiledStep(int _section, int _performState)
+{
+	if (m_compiledGen != g_caCompileGen)
+	{
+		m_compiled.Empty(true);
+		m_compiledGen = g_caCompileGen;
+	}
+
+	if (!m_compiled.GetSize())
+	{
+		int nbSteps = GetStepCount();
+		for (int i=0; i<nbSteps; i++)
+			m_compiled.Add(CompileCyclactionStep(_section, this, GetStepIdx(i)));
+	}
+	return m_compiled.Get(_performState);
+}
+
+void Cyclaction::GetRunStats(int* _count, double* _total, double* _last, double* _max)
+{
+	if (_count) *_count = m_runCount;
+	if (_total) *_total = m_runTime;
+	if (_last) *_last = m_lastRunTime;
+	if (_max) *_max = m_maxRunTime;
+}
+
 int Cyclaction::GetIndent(WDL_FastString* _cmd)
 {
 	int indent=0;
@@ -1410,7 +1696,7 @@ enum {
 // - dbl-click ids to perform cycle actions
 
 // !WANT_LOCALIZE_STRINGS_BEGIN:sws_DLG_161
-static SWS_LVColumn s_casCols[] = { { 50, 0, "Id" }, { 260, 1, "Cycle action name" }, { 50, 2, "Toggle" } };
+static SWS_LVColumn s_casCols[] = { { 50, 0, "Id" }, { 260, 1, "Cycle action name" }, { 50, 2, "Toggle" }, { 110, 0, "Run time (ms)", -1 } };
 static SWS_LVColumn s_commandsCols[] = { { 180, 1, "Command" }, { 180, 0, "Description" } };
 // !WANT_LOCALIZE_STRINGS_END
 
@@ -1418,6 +1704,7 @@ enum {
   COL_L_ID=0,
   COL_L_NAME,
   COL_L_TOGGLE,
+  COL_L_RUNTIME,
   COL_L_COUNT
 };
 
@@ -1608,6 +1895,20 @@ void CyclactionsView::GetItemText(SWS_ListItem* item, int iCol, char* str, int i
 				else if (a->IsToggle()==2)
 					lstrcpyn(str, UTF8_BULLET, iStrMax);
 				break;
+			case COL_L_RUNTIME:
+				// execution timing of the registered CA (edited CAs are copies)
+				if (!a->m_added && a->m_cmdId)
+				{
+					Cyclaction* ra = g_cas[g_editedSection].Get(g_editedActions[g_editedSection].Find(a));
+					int count; double total, last, maxt;
+					if (ra && ra->m_cmdId == a->m_cmdId)
+					{
+						ra->GetRunStats(&count, &total, &last, &maxt);
+						if (count)
+							_snprintfSafe(str, iStrMax, "%.2f (avg. %.2f, max %.2f)", last*1000.0, total*1000.0/count, maxt*1000.0);
+					}
+				}
+				break;
 		}
 	}
 }
@@ -47,12 +47,40 @@ static const char s_CA_TGL1_STR[] = { CA_TGL1, '\0' };
 static const char s_CA_TGL2_STR[] = { CA_TGL2, '\0' };
 
 
+// compiled cycle action instruction, see Cyclaction::GetCompiledStep()
+// instructions and exploded commands share the same indexes: jumps are 
+// indexes of the ELSE/ENDIF instructions to continue after
+class CyclactionInstr
+{
+public:
+	CyclactionInstr(int _op, const char* _cmd) : m_op(_op), m_stmt(-1), m_cmdId(0), m_jump(-1), m_jump2(-1), m_loopCnt(-1), m_cmd(_cmd) { m_condIds[0]=m_condIds[1]=0; }
+	int m_op;      // CA_OP_xxx, see SnM_Cyclactions.cpp
+	int m_stmt;    // statement index (conditional statements only)
+	int m_cmdId;   // pre-resolved command id, 0 if not registered (yet)
+	int m_condIds[2]; // conditional statement: pre-resolved ids of the next command(s)
+	int m_jump;    // conditional statement: next ELSE or ENDIF, ELSE: next ENDIF
+	int m_jump2;   // conditional statement: next ENDIF (invalid toggle state)
+	int m_loopCnt; // LOOP: number of iterations, -1 to prompt the user
+	WDL_FastString m_cmd;
+};
+
+// compiled cycle point
+class CyclactionStep
+{
+public:
+	CyclactionStep() : m_dynamic(false), m_last(false) {}
+	WDL_PtrList_DeleteOnDestroy<CyclactionInstr> m_instrs;
+	bool m_dynamic; // calls other CAs, i.e. must be exploded at run time
+	bool m_last;    // last cycle point (cycles back to the 1st one)
+};
+
+
 class Cyclaction
 {
 public:
 	// constructors assume their params are valid
-	Cyclaction(const char* _def=CA_EMPTY, bool _added=false) : m_def(_def), m_performState(0), m_fakeToggle(false), m_cmdId(0), m_added(_added) { UpdateNameAndCmds(); }
-	Cyclaction(Cyclaction* _a) : m_def(_a->m_def), m_performState(_a->m_performState), m_fakeToggle(_a->m_fakeToggle), m_cmdId(_a->m_cmdId), m_added(_a->m_added) { UpdateNameAndCmds(); }
+	Cyclaction(const char* _def=CA_EMPTY, bool _added=false) : m_def(_def), m_performState(0), m_fakeToggle(false), m_cmdId(0), m_added(_added), m_compiledGen(-1), m_runCount(0), m_runTime(0.0), m_lastRunTime(0.0), m_maxRunTime(0.0) { UpdateNameAndCmds(); }
+	Cyclaction(Cyclaction* _a) : m_def(_a->m_def), m_performState(_a->m_performState), m_fakeToggle(_a->m_fakeToggle), m_cmdId(_a->m_cmdId), m_added(_a->m_added), m_compiledGen(-1), m_runCount(0), m_runTime(0.0), m_lastRunTime(0.0), m_maxRunTime(0.0) { UpdateNameAndCmds(); }
 	~Cyclaction() {}
 	const char* GetDefinition() { return m_def.Get(); }
 	void Update(const char* _def) { m_def.Set(_def); UpdateNameAndCmds(); }
@@ -74,6 +102,10 @@ public:
 	WDL_FastString* GetCmdString(int _i) { return m_cmds.Get(_i); }
 	int FindCmd(WDL_FastString* _cmd) { return m_cmds.Find(_cmd); }
 	int GetIndent(WDL_FastString* _cmd);
+	CyclactionStep* GetCompiledStep(int _section, int _performState);
+	void InvalidateCompiled() { m_compiled.Empty(true); m_compiledGen = -1; }
+	void AddRunTime(double _t) { m_runCount++; m_runTime += _t; m_lastRunTime = _t; if (_t > m_maxRunTime) m_maxRunTime = _t; }
+	void GetRunStats(int* _count, double* _total, double* _last, double* _max);
 
 	int m_performState;
 	bool m_added; // CA added by the user, not yet registered
@@ -87,6 +119,14 @@ private:
 	WDL_FastString m_def;
 	WDL_FastString m_name;
 	WDL_PtrList_DeleteOnDestroy<WDL_FastString> m_cmds;
+
+	// compiled cycle points, one per step (NULL items: not compilable, explode at run time)
+	WDL_PtrList_DeleteOnDestroy<CyclactionStep> m_compiled;
+	int m_compiledGen;
+
+	// execution timing, in seconds
+	int m_runCount;
+	double m_runTime, m_lastRunTime, m_maxRunTime;
 };
 
 
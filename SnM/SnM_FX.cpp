@@ -199,6 +199,9 @@ int IsFXOfflineSelTracks(COMMAND_T * _ct)
 		int fxId = GetTrackFXIdFromCmd(tr, (int)_ct->user);
 		if (tr && fxId >= 0)
 		{
+			if (TrackFX_GetOffline) // v5.95+
+				return fxId < TrackFX_GetCount(tr) && TrackFX_GetOffline(tr, fxId);
+
 			char state[2] = "0";
 			SNM_ChunkParserPatcher p(tr);
 			p.SetWantsMinimalState(true);
@@ -213,7 +216,32 @@ int IsFXOfflineSelTracks(COMMAND_T * _ct)
 	return false;
 }
 
-// core func (no dedicated API yet => state chunk update)
+// native API fast path (v5.95+): no state chunk round trip, i.e. no reload of all plugin states
+// (new states are what the chunk path would write, see GetPatchedBoolToken() and tests/SnM_FXState_test.cpp)
+// returns false if the API is not available, _updated is set otherwise
+static bool SetTrackFXOnline(MediaTrack* _tr, int _mode, int _fxId, const char* _val, const char* _valExcept, bool* _updated)
+{
+	if (!TrackFX_GetOffline || !TrackFX_SetOffline)
+		return false;
+
+	*_updated = false;
+	for (int j=0; j < TrackFX_GetCount(_tr); j++)
+	{
+		bool offline = TrackFX_GetOffline(_tr, j);
+		bool newOffline = GetPatchedBoolToken(offline, _mode, j, _fxId, _val, _valExcept);
+		if (newOffline != offline)
+		{
+			// close the GUI for buggy plugins, http://github.com/reaper-oss/sws/issues/317
+			if (g_SNM_SupportBuggyPlug)
+				TrackFX_SetOpen(_tr, j, false);
+			TrackFX_SetOffline(_tr, j, newOffline);
+			*_updated = true;
+		}
+	}
+	return true;
+}
+
+// core func: uses the native API when available, state chunk update otherwise
 bool PatchSelTracksFXOnline(const char * _undoMsg, int _mode, int _fxCmdId, const char* _val = NULL, const char* _valExcept = NULL)
 {
 	bool updated = false;
@@ -223,10 +251,15 @@ bool PatchSelTracksFXOnline(const char * _undoMsg, int _mode, int _fxCmdId, cons
 		if (tr && *(int*)GetSetMediaTrackInfo(tr, "I_SELECTED", NULL))
 		{
 			int fxId = GetTrackFXIdFromCmd(tr, _fxCmdId);
-			if (fxId >= 0)
+			bool updt;
+			if (fxId >= 0 && SetTrackFXOnline(tr, _mode, fxId, _val, _valExcept, &updt))
+			{
+				updated |= updt;
+			}
+			else if (fxId >= 0)
 			{
 				SNM_ChunkParserPatcher p(tr);
-				bool updt = (p.ParsePatch(_mode, 2, "FXCHAIN", "BYPASS", fxId, 2, (void*)_val, (void*)_valExcept) > 0);
+				updt = (p.ParsePatch(_mode, 2, "FXCHAIN", "BYPASS", fxId, 2, (void*)_val, (void*)_valExcept) > 0);
 				updated |= updt;
 
 				// close the GUI for buggy plugins (before chunk update)
@@ -279,7 +312,35 @@ void SetAllFXsOnlineExceptSelTracks(COMMAND_T* _ct) {
 // Take fx online/offline, bypass/unbypass
 ///////////////////////////////////////////////////////////////////////////////
 
-// core func
+// native API fast path (v5.95+), see PatchSelItemsFXState()
+// returns false if the API is not available, _updated is set otherwise
+static bool SetItemFXState(MediaItem* _item, int _mode, int _token, int _fxId, const char* _value, bool* _updated)
+{
+	if (_token == 1 ? (!TakeFX_GetEnabled || !TakeFX_SetEnabled) : (!TakeFX_GetOffline || !TakeFX_SetOffline))
+		return false;
+
+	*_updated = false;
+	int fxIdx = 0; // fx ids run through all takes like chunk occurrences do
+	for (int i=0; i < CountTakes(_item); i++)
+	{
+		MediaItem_Take* tk = GetTake(_item, i);
+		for (int j=0; tk && j < TakeFX_GetCount(tk); j++, fxIdx++)
+		{
+			// token 1: bypass, i.e. !enabled, token 2: offline
+			bool state = (_token == 1) ? !TakeFX_GetEnabled(tk, j) : TakeFX_GetOffline(tk, j);
+			bool newState = GetPatchedBoolToken(state, _mode, fxIdx, _fxId, _value);
+			if (newState != state)
+			{
+				if (_token == 1) TakeFX_SetEnabled(tk, j, !newState);
+				else TakeFX_SetOffline(tk, j, newState);
+				*_updated = true;
+			}
+		}
+	}
+	return true;
+}
+
+// core func: uses the native API when available, state chunk update otherwise
 // note: all takes are patched atm (i.e. nothing specific to active takes yet)
 bool PatchSelItemsFXState(const char * _undoMsg, int _mode, int _token, int _fxId, const char* _value)
 {
@@ -292,8 +353,15 @@ bool PatchSelItemsFXState(const char * _undoMsg, int _mode, int _token, int _fxI
 			MediaItem* item = GetTrackMediaItem(tr,j);
 			if (item && *(bool*)GetSetMediaItemInfo(item,"B_UISEL",NULL))
 			{
+				bool updt;
+				if (SetItemFXState(item, _mode, _token, _fxId, _value, &updt))
+				{
+					updated |= updt;
+					continue;
+				}
+
 				SNM_ChunkParserPatcher p(item);
-				bool updt = (p.ParsePatch(_mode, 2, "TAKEFX", "BYPASS", _fxId, _token, (void*)_value) > 0);
+				updt = (p.ParsePatch(_mode, 2, "TAKEFX", "BYPASS", _fxId, _token, (void*)_value) > 0);
 				updated |= updt;
 
 /*JFB not used: doesn't seem to occur with take FX
@@ -146,12 +146,183 @@ SNM_MultiWindowManager<LiveConfigMonitorWnd> g_monWndsMgr(LIVECFG_MON_WND_ID);
 SWSProjConfig<WDL_PtrList_DOD<LiveConfig> > g_liveConfigs;
 WDL_PtrList<LiveConfigItem> g_clipboardConfigs; // for cut/copy/paste
 int g_configId = 0; // the current *displayed/edited* config id
+LiveConfigChunkCache g_lcChunkCache; // shared by all projects/configs, keyed by filename
 
 // prefs
 char g_lcBigFontName[64] = SNM_DYN_FONT_NAME;
 int* g_reaPref_fadeLen = NULL;
 
 
+///////////////////////////////////////////////////////////////////////////////
+// LiveConfigChunkCache
+///////////////////////////////////////////////////////////////////////////////
+
+// lock must be held
+LiveConfigChunkCache::Entry* LiveConfigChunkCache::Find(const char* _fn, bool _tmplt)
+{
+	for (int i=0; i<m_entries.GetSize(); i++)
+		if (Entry* e = m_entries.Get(i))
+			if (e->m_tmplt==_tmplt && !strcmp(e->m_fn.Get(), _fn))
+				return e;
+	return NULL;
+}
+
+bool LiveConfigChunkCache::GetFileStamp(const char* _fn, time_t* _mtime, INT64* _size)
+{
+	struct stat s;
+#ifdef _WIN32
+	if (statUTF8(_fn, &s))
+#else
+	if (stat(_fn, &s))
+#endif
+		return false;
+	*_mtime = s.st_mtime;
+	*_size = (INT64)s.st_size;
+	return true;
+}
+
+// also used by the worker thread: no REAPER API calls in here!
+bool LiveConfigChunkCache::Prepare(const char* _fn, bool _tmplt, WDL_FastString* _chunkOut)
+{
+	if (!_tmplt)
+		return LoadChunk(_fn, _chunkOut) && _chunkOut->GetLength();
+
+	WDL_FastString tmplt;
+	// items and envs are removed, so no need to obey the "templateditcursor" pref (would be a REAPER API call)
+	return LoadChunk(_fn, &tmplt) && tmplt.GetLength() && 
+		MakeSingleTrackTemplateChunk(&tmplt, _chunkOut, true, true, 0, false);
+}
+
+unsigned WINAPI LiveConfigChunkCache::ThreadProc(void* _cache)
+{
+	LiveConfigChunkCache* c = (LiveConfigChunkCache*)_cache;
+	WDL_FastString fn, chunk;
+	while (true)
+	{
+		bool tmplt=false, ready=false;
+		time_t mtime=0;
+		INT64 size=0;
+		{
+			SWS_SectionLock lock(&c->m_mutex);
+			Entry* e = NULL;
+			for (int i=0; !e && !c->m_quit && i<c->m_entries.GetSize(); i++)
+				if (c->m_entries.Get(i)->m_queued)
+					e = c->m_entries.Get(i);
+			if (!e) {
+				c->m_running = false;
+				return 0;
+			}
+			e->m_queued = false;
+			fn.Set(e->m_fn.Get());
+			tmplt = e->m_tmplt;
+			ready = e->m_ready;
+			mtime = e->m_mtime;
+			size = e->m_size;
+		}
+
+		time_t newMtime=0;
+		INT64 newSize=0;
+		bool exists = GetFileStamp(fn.Get(), &newMtime, &newSize);
+		if (exists && ready && newMtime==mtime && newSize==size)
+			continue; // up to date
+
+		bool ok = exists && Prepare(fn.Get(), tmplt, &chunk);
+		{
+			SWS_SectionLock lock(&c->m_mutex);
+			if (Entry* e = c->Find(fn.Get(), tmplt))
+			{
+				e->m_ready = ok;
+				e->m_chunk.Set(ok ? chunk.Get() : "");
+				e->m_mtime = newMtime;
+				e->m_size = newSize;
+			}
+		}
+	}
+	return 0;
+}
+
+// queue a file for preparation (worker thread)
+void LiveConfigChunkCache::Request(const char* _fn, bool _tmplt)
+{
+	if (!_fn || !*_fn)
+		return;
+
+	SWS_SectionLock lock(&m_mutex);
+	if (m_quit)
+		return;
+
+	Entry* e = Find(_fn, _tmplt);
+	if (!e)
+		e = m_entries.Add(new Entry(_fn, _tmplt));
+	e->m_queued = true;
+
+	if (!m_running)
+	{
+		if (m_thread) // already done, see ThreadProc()
+		{
+			WaitForSingleObject(m_thread, INFINITE);
+			CloseHandle(m_thread);
+			m_thread = NULL;
+		}
+		m_running = true;
+		m_thread = (HANDLE)_beginthreadex(NULL, 0, ThreadProc, this, 0, NULL);
+		if (!m_thread)
+			m_running = false; // no biggie, prepared on demand, see Get()
+	}
+}
+
+// returns the prepared chunk, done right now if not ready yet or if the file has been modified
+bool LiveConfigChunkCache::Get(const char* _fn, bool _tmplt, WDL_FastString* _chunkOut)
+{
+	time_t mtime;
+	INT64 size;
+	if (!_fn || !*_fn || !_chunkOut || !GetFileStamp(_fn, &mtime, &size))
+		return false;
+
+	{
+		SWS_SectionLock lock(&m_mutex);
+		Entry* e = Find(_fn, _tmplt);
+		if (e && e->m_ready && e->m_mtime==mtime && e->m_size==size)
+		{
+			_chunkOut->Set(e->m_chunk.Get());
+			return true;
+		}
+	}
+
+	if (!Prepare(_fn, _tmplt, _chunkOut))
+		return false;
+
+	// keep it for the next switches
+	SWS_SectionLock lock(&m_mutex);
+	Entry* e = Find(_fn, _tmplt);
+	if (!e)
+		e = m_entries.Add(new Entry(_fn, _tmplt));
+	e->m_chunk.Set(_chunkOut->Get());
+	e->m_mtime = mtime;
+	e->m_size = size;
+	e->m_ready = true;
+	return true;
+}
+
+void LiveConfigChunkCache::Stop()
+{
+	HANDLE thread = NULL;
+	{
+		SWS_SectionLock lock(&m_mutex);
+		m_quit = true;
+		thread = m_thread;
+		m_thread = NULL;
+	}
+	if (thread)
+	{
+		WaitForSingleObject(thread, INFINITE);
+		CloseHandle(thread);
+	}
+	SWS_SectionLock lock(&m_mutex);
+	m_entries.Empty(true);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Presets helpers
 // Format of v1 presets (deprecated): 
@@ -528,6 +699,27 @@ int LiveConfig::CountTrackConfigs(MediaTrack* _tr)
 	return cnt;
 }
 
+// request the preparation of the track templates/fx chains, see LiveConfigChunkCache
+void LiveConfig::PrepareChunks()
+{
+	char fn[SNM_MAX_PATH]="";
+	for (int i=0; i < m_ccConfs.GetSize(); i++)
+		if (LiveConfigItem* cfg = m_ccConfs.Get(i))
+			if (cfg->m_track)
+			{
+				if (cfg->m_trTemplate.GetLength())
+				{
+					GetFullResourcePath("TrackTemplates", cfg->m_trTemplate.Get(), fn, sizeof(fn));
+					g_lcChunkCache.Request(fn, true);
+				}
+				else if (cfg->m_fxChain.GetLength())
+				{
+					GetFullResourcePath("FXChains", cfg->m_fxChain.Get(), fn, sizeof(fn));
+					g_lcChunkCache.Request(fn, false);
+				}
+			}
+}
+
 void LiveConfig::cfg_SaveMuteStateAndMuteIfNeeded(MediaTrack* _tr, bool _force)
 {
 	if (_tr && m_cfg_tracks.Find(_tr)<0)
@@ -943,6 +1135,7 @@ void LiveConfigsWnd::Update()
 	if (LiveConfig* lc = g_liveConfigs.Get()->Get(g_configId)) {
 		m_vwndCC.SetValue(lc->m_ccDelay);
 		m_vwndFade.SetValue(lc->m_fade);
+		lc->PrepareChunks(); // things may have been edited
 	}
 	m_parentVwnd.RequestRedraw(NULL);
 }
@@ -1982,6 +2175,8 @@ static bool ProcessExtensionLine(const char *line, ProjectStateContext *ctx, boo
 
 			// refresh monitoring window + osc feedback
 			UpdateMonitoring(configId, APPLY_MASK|PRELOAD_MASK, APPLY_MASK|PRELOAD_MASK);
+
+			lc->PrepareChunks();
 		}
 
 		// refresh editor
@@ -2132,6 +2327,7 @@ int LiveConfigInit()
 void LiveConfigExit()
 {
 	plugin_register("-projectconfig", &s_projectconfig);
+	g_lcChunkCache.Stop();
 	WritePrivateProfileString("LiveConfigs", "BigFontName", g_lcBigFontName, g_SNM_IniFn.Get());
 	g_lcWndMgr.Delete();
 	g_monWndsMgr.DeleteAll();
@@ -2277,12 +2473,11 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 				char fn[SNM_MAX_PATH] = "";
 				GetFullResourcePath("TrackTemplates", cfg->m_trTemplate.Get(), fn, sizeof(fn));
 
-				static WDL_FastString tmplt; 
-				if (LoadChunk(fn, &tmplt) && tmplt.GetLength())
+				// single track template, already prepared (most of the time), see LiveConfigChunkCache
+				if (g_lcChunkCache.Get(fn, true, &chunk) && chunk.GetLength())
 				{
 					SNM_SendPatcher p(cfg->m_track); // auto-commit on destroy
 					
-					MakeSingleTrackTemplateChunk(&tmplt, &chunk, true, true, false);
 					if (ApplyTrackTemplate(cfg->m_track, &chunk, false, false, &p))
 					{
 						// make sure the track will be restored with its current name 
@@ -2305,7 +2500,7 @@ void ApplyPreloadLiveConfig(bool _apply, int _cfgId, int _val, LiveConfigItem* _
 			{
 				char fn[SNM_MAX_PATH]="";
 				GetFullResourcePath("FXChains", cfg->m_fxChain.Get(), fn, sizeof(fn));
-				if (LoadChunk(fn, &chunk) && chunk.GetLength())
+				if (g_lcChunkCache.Get(fn, false, &chunk) && chunk.GetLength())
 				{
 					SNM_FXChainTrackPatcher p(cfg->m_track); // auto-commit on destroy
 					if (p.SetFXChain(&chunk))
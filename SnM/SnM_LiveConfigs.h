@@ -42,6 +42,40 @@ public:
 };
 
 
+// Preloaded track templates/fx chains, ready to be applied: config switches do not hit the disk
+// nor re-process templates. Prepared in a worker thread (file loading + text processing only),
+// entries are invalidated when the file is modified.
+// Note: the track dependent stuff (sends, receives, items, envelopes, etc) is not cached, it is
+// still applied on switch, from the current track state.
+class LiveConfigChunkCache {
+public:
+	LiveConfigChunkCache() : m_thread(NULL), m_running(false), m_quit(false) {}
+	~LiveConfigChunkCache() { Stop(); }
+	void Request(const char* _fn, bool _tmplt);
+	bool Get(const char* _fn, bool _tmplt, WDL_FastString* _chunkOut);
+	void Stop();
+private:
+	class Entry {
+	public:
+		Entry(const char* _fn, bool _tmplt) : m_fn(_fn), m_tmplt(_tmplt), m_mtime(0), m_size(0), m_ready(false), m_queued(false) {}
+		WDL_FastString m_fn, m_chunk;
+		bool m_tmplt;
+		time_t m_mtime;
+		INT64 m_size;
+		bool m_ready, m_queued;
+	};
+	Entry* Find(const char* _fn, bool _tmplt);
+	static bool GetFileStamp(const char* _fn, time_t* _mtime, INT64* _size);
+	static bool Prepare(const char* _fn, bool _tmplt, WDL_FastString* _chunkOut);
+	static unsigned WINAPI ThreadProc(void* _cache);
+
+	SWS_Mutex m_mutex;
+	WDL_PtrList_DOD<Entry> m_entries;
+	HANDLE m_thread;
+	bool m_running, m_quit;
+};
+
+
 class LiveConfigItem {
 public:
 	LiveConfigItem(int _cc, const char* _desc="", MediaTrack* _track=NULL, 
@@ -66,6 +100,7 @@ public:
 
 	bool IsDefault(bool _ignoreComment);
 	int CountTrackConfigs(MediaTrack* _tr);
+	void PrepareChunks();
 
 	// GUID_NULL means "no track" here not "the master track", see GuidToTrack()
 	MediaTrack* GetInputTrack() { return !GuidsEqual(&m_inputTr, &GUID_NULL) ? GuidToTrack(&m_inputTr) : NULL; }
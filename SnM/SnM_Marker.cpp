@@ -28,6 +28,7 @@
 #include "stdafx.h" 
 #include "SnM.h"
 #include "SnM_Marker.h"
+#include "SnM_MarkerIdIndex.h"
 #include "../reaper/localize.h"
 
 
@@ -39,6 +40,8 @@ DWORD g_mkrRgnNotifyTime = 0; // really approx (updated on timer)
 WDL_PtrList<MarkerRegion> g_mkrRgnCache;
 WDL_PtrList<SNM_MarkerRegionListener> g_mkrRgnListeners;
 
+void SyncMarkerRegionIdIndex(int _updateFlags);
+
 void RegisterToMarkerRegionUpdates(SNM_MarkerRegionListener* _listener)
 {
 	if (_listener && g_mkrRgnListeners.Find(_listener) < 0)
@@ -76,6 +79,8 @@ int UpdateMarkerRegionCache()
 			updateFlags |= (m->IsRegion() ? SNM_REGION_MASK : SNM_MARKER_MASK);
 		g_mkrRgnCache.Delete(j, true);
 	}
+	SyncMarkerRegionIdIndex(updateFlags);
+
 	// project time mode update?
 	static int sPrevTimemode = *(int*)GetConfigVar("projtimemode");
 	if (updateFlags != (SNM_MARKER_MASK|SNM_REGION_MASK))
@@ -137,6 +142,109 @@ int FindMarkerRegion(ReaProject* _proj, double _pos, int _flags, int* _idOut)
 // Marker/region "IDs"
 ///////////////////////////////////////////////////////////////////////////////
 
+// id -> marker/region index map, for the current project only
+// - refreshed from UpdateMarkerRegionCache() diffs when there are listeners
+// - otherwise rebuilt lazily, when the project state change count or the
+//   number of markers/regions have changed (or when an entry is found stale)
+// see SNM_MarkerRegionIdIndex::GetRebuildCount() and tests/
+
+int SNM_MarkerRegionIdIndex::ReadStateChangeCount(ReaProject* _proj) {
+	return GetProjectStateChangeCount(_proj);
+}
+
+int SNM_MarkerRegionIdIndex::ReadCount(ReaProject* _proj) {
+	return CountProjectMarkers(_proj, NULL, NULL);
+}
+
+int SNM_MarkerRegionIdIndex::ReadId(ReaProject* _proj, int _idx, int* _idOut)
+{
+	int num; bool isrgn;
+	int x = EnumProjectMarkers3(_proj, _idx, &isrgn, NULL, NULL, NULL, &num, NULL);
+	if (x) *_idOut = MakeMarkerRegionId(num, isrgn);
+	return x;
+}
+
+// g_mkrRgnCache has just been updated: rebuild the index from it if needed,
+// or just acknowledge the current state (e.g. no marker/region changes)
+void SyncMarkerRegionIdIndex(int _updateFlags)
+{
+	ReaProject* proj = EnumProjects(-1, NULL, 0);
+	SNM_MarkerRegionIdIndex* index = SNM_MarkerRegionIdIndex::Get();
+	if (_updateFlags || !index->IsFromCache(proj))
+	{
+		index->Clear(true);
+		for (int i=0; i<g_mkrRgnCache.GetSize(); i++)
+			if (MarkerRegion* m = g_mkrRgnCache.Get(i))
+				index->Add(m->GetId(), i);
+	}
+	index->Stamp(proj);
+}
+
+// returns the index of the marker/region _id, or -1 if not found
+// _isrgn, _pos, etc: optional
+int FindMarkerRegionById(ReaProject* _proj, int _id, bool* _isrgn, double* _pos, double* _end, const char** _name, int* _num, int* _color)
+{
+	if (_id <= 0)
+		return -1;
+
+	const char* name2;
+	double pos2, end2;
+	bool isrgn = IsRegion(_id), isrgn2;
+	int num=(_id&0x3FFFFFFF), num2, col2;
+
+	ReaProject* curProj = EnumProjects(-1, NULL, 0);
+	if (!_proj || _proj==curProj)
+	{
+		SNM_MarkerRegionIdIndex* index = SNM_MarkerRegionIdIndex::Get();
+		bool rebuilt = false;
+		if (!index->IsValid(curProj))
+		{
+			index->Rebuild(curProj);
+			rebuilt = true;
+		}
+
+		for (;;)
+		{
+			int idx = index->Find(_id);
+			if (idx<0)
+				return -1;
+
+			// check the entry (markers could have been updated w/o any project state change)
+			if (EnumProjectMarkers3(curProj, idx, &isrgn2, &pos2, &end2, &name2, &num2, &col2) && num==num2 && isrgn==isrgn2)
+			{
+				if (_isrgn)	*_isrgn = isrgn2;
+				if (_pos)	*_pos = pos2;
+				if (_end)	*_end = end2;
+				if (_name)	*_name = name2;
+				if (_num)	*_num = num2;
+				if (_color)	*_color = col2;
+				return idx;
+			}
+			if (rebuilt)
+				break; // should not happen, but who knows.. fall back to a linear search
+			index->Rebuild(curProj);
+			rebuilt = true;
+		}
+	}
+
+	int x=0, lastx=0;
+	while ((x = EnumProjectMarkers3(_proj, x, &isrgn2, &pos2, &end2, &name2, &num2, &col2)))
+	{
+		if (num == num2 && isrgn == isrgn2)
+		{
+			if (_isrgn)	*_isrgn = isrgn2;
+			if (_pos)	*_pos = pos2;
+			if (_end)	*_end = end2;
+			if (_name)	*_name = name2;
+			if (_num)	*_num = num2;
+			if (_color)	*_color = col2;
+			return lastx;
+		}
+		lastx=x;
+	}
+	return -1;
+}
+
 int MakeMarkerRegionId(int _num, bool _isrgn)
 {
 	// note: MSB is ignored so that the encoded number is always positive
@@ -160,17 +268,7 @@ int GetMarkerRegionIdFromIndex(ReaProject* _proj, int _idx)
 
 int GetMarkerRegionIndexFromId(ReaProject* _proj, int _id) 
 {
-	if (_id > 0)
-	{
-		int x=0, lastx=0, num=(_id&0x3FFFFFFF), num2; 
-		bool isrgn = IsRegion(_id), isrgn2;
-		while ((x = EnumProjectMarkers3(_proj, x, &isrgn2, NULL, NULL, NULL, &num2, NULL))) {
-			if (num == num2 && isrgn == isrgn2)
-				return lastx;
-			lastx=x;
-		}
-	}
-	return -1;
+	return FindMarkerRegionById(_proj, _id, NULL, NULL, NULL, NULL, NULL, NULL);
 }
 
 int GetMarkerRegionNumFromId(int _id) {
@@ -183,28 +281,7 @@ bool IsRegion(int _id) {
 
 int EnumMarkerRegionById(ReaProject* _proj, int _id, bool* _isrgn, double* _pos, double* _end, const char** _name, int* _num, int* _color)
 {
-	if (_id > 0)
-	{
-		const char* name2;
-		double pos2, end2;
-		bool isrgn = IsRegion(_id), isrgn2;
-		int  num=(_id&0x3FFFFFFF), x=0, lastx=0, num2, col2;
-		while ((x = EnumProjectMarkers3(_proj, x, &isrgn2, &pos2, &end2, &name2, &num2, &col2)))
-		{
-			if (num == num2 && isrgn == isrgn2)
-			{
-				if (_isrgn)	*_isrgn = isrgn2;
-				if (_pos)	*_pos = pos2;
-				if (_end)	*_end = end2;
-				if (_name)	*_name = name2;
-				if (_num)	*_num = num2;
-				if (_color)	*_color = col2;
-				return lastx;
-			}
-            lastx=x;
-		}
-	}
-	return -1;
+	return FindMarkerRegionById(_proj, _id, _isrgn, _pos, _end, _name, _num, _color);
 }
 
 
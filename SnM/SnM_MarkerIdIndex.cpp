@@ -0,0 +1,103 @@
+/******************************************************************************
+/ SnM_MarkerIdIndex.cpp
+/
+/ Copyright (c) 2013 and later Jeffos
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "stdafx.h"
+#include "SnM_MarkerIdIndex.h"
+
+
+static int g_mkrRgnIdIndexRebuilds = 0;
+
+SNM_MarkerRegionIdIndex::SNM_MarkerRegionIdIndex()
+	: m_sorted(true), m_fromCache(false), m_proj(NULL), m_stateCount(-1), m_count(-1)
+{
+}
+
+SNM_MarkerRegionIdIndex* SNM_MarkerRegionIdIndex::Get()
+{
+	static SNM_MarkerRegionIdIndex s_index;
+	return &s_index;
+}
+
+int SNM_MarkerRegionIdIndex::GetRebuildCount() {
+	return g_mkrRgnIdIndexRebuilds;
+}
+
+static bool CompareIds(const std::pair<int,int>& _a, const std::pair<int,int>& _b) {
+	return _a.first < _b.first;
+}
+
+int SNM_MarkerRegionIdIndex::Find(int _id)
+{
+	if (!m_sorted)
+	{
+		// stable: the 1st index of duplicate ids wins, as with linear searches
+		std::stable_sort(m_ids.begin(), m_ids.end(), CompareIds);
+		m_sorted = true;
+	}
+	std::vector<std::pair<int,int> >::iterator it = 
+		std::lower_bound(m_ids.begin(), m_ids.end(), std::pair<int,int>(_id, 0), CompareIds);
+	return (it!=m_ids.end() && it->first==_id) ? it->second : -1;
+}
+
+bool SNM_MarkerRegionIdIndex::IsValid(ReaProject* _proj)
+{
+	return m_proj==_proj && m_stateCount==ReadStateChangeCount(_proj) && m_count==ReadCount(_proj);
+}
+
+void SNM_MarkerRegionIdIndex::Rebuild(ReaProject* _proj)
+{
+	Clear(false);
+	int x=0, lastx=0, id;
+	while ((x = ReadId(_proj, x, &id))) {
+		Add(id, lastx);
+		lastx=x;
+	}
+	Stamp(_proj);
+}
+
+void SNM_MarkerRegionIdIndex::Clear(bool _fromCache)
+{
+	g_mkrRgnIdIndexRebuilds++;
+	m_ids.clear();
+	m_sorted = true;
+	m_fromCache = _fromCache;
+}
+
+void SNM_MarkerRegionIdIndex::Add(int _id, int _idx)
+{
+	if (_id>0) {
+		m_ids.push_back(std::pair<int,int>(_id, _idx));
+		m_sorted = false;
+	}
+}
+
+void SNM_MarkerRegionIdIndex::Stamp(ReaProject* _proj)
+{
+	m_proj = _proj;
+	m_stateCount = ReadStateChangeCount(_proj);
+	m_count = ReadCount(_proj);
+}
@@ -0,0 +1,70 @@
+/******************************************************************************
+/ SnM_MarkerIdIndex.h
+/
+/ Copyright (c) 2013 and later Jeffos
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+//#pragma once
+
+#ifndef _SNM_MARKERIDINDEX_H_
+#define _SNM_MARKERIDINDEX_H_
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Marker/region id -> index map, see FindMarkerRegionById()
+// note: the only REAPER API calls are the Read*() helpers (see SnM_Marker.cpp)
+// so that the index can be checked against mock markers, see tests/
+///////////////////////////////////////////////////////////////////////////////
+
+class SNM_MarkerRegionIdIndex {
+public:
+	SNM_MarkerRegionIdIndex();
+	static SNM_MarkerRegionIdIndex* Get(); // index of the current project
+	static int GetRebuildCount();
+
+	// index of the 1st marker/region with id _id (entry not checked), -1 if not found
+	int Find(int _id);
+	// false when _proj, its state change count or number of markers/regions changed since the last Stamp()
+	bool IsValid(ReaProject* _proj);
+	bool IsFromCache(ReaProject* _proj) { return m_fromCache && m_proj==_proj; }
+
+	// from the project markers/regions
+	void Rebuild(ReaProject* _proj);
+	// from another source (e.g. the marker/region cache): Clear(), Add() ids in index order, Stamp()
+	void Clear(bool _fromCache);
+	void Add(int _id, int _idx);
+	void Stamp(ReaProject* _proj);
+
+private:
+	static int ReadStateChangeCount(ReaProject* _proj);
+	static int ReadCount(ReaProject* _proj);
+	static int ReadId(ReaProject* _proj, int _idx, int* _idOut); // next index, 0 when done (like EnumProjectMarkers3)
+
+	std::vector<std::pair<int,int> > m_ids; // (id, index), sorted by id
+	bool m_sorted, m_fromCache;
+	ReaProject* m_proj;
+	int m_stateCount, m_count;
+};
+
+#endif
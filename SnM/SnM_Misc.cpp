@@ -81,7 +81,7 @@ MediaItem_Take* SNM_GetMediaItemTakeByGUID(ReaProject* _project, const char* _gu
 	{
 		GUID g;
 		stringToGuid(_guid, &g);
-		return GetMediaItemTakeByGUID(_project, &g);
+		return GuidToTake(&g, _project);
 	}
 	return NULL;
 }
@@ -52,6 +52,7 @@ enum {
   COPY_PLAYLIST_MSG,
   DEL_PLAYLIST_MSG,
   REN_PLAYLIST_MSG,
+  SIMULATE_PLAYLIST_MSG,
   ADD_ALL_REGIONS_MSG,
   CROP_PRJTAB_MSG,
   APPEND_PRJ_MSG,
@@ -105,16 +106,17 @@ bool g_repeatPlaylist = false;	// playlist repeat state
 bool g_seekImmediate = false;
 int g_optionFlags = false;
 
+double g_lookahead = 0.01;		// seconds, see RgnPlaylistScheduler::Process()
+
 // see PlaylistRun()
+// note: g_playCur, g_playNext, g_rgnLoop and g_unsync mirror the scheduler state (monitoring, etc)
 int g_playPlaylist = -1;		// -1: stopped, playlist id otherwise
 bool g_unsync = false;			// true when switching to a position that is not part of the playlist
 int g_playCur = -1;				// index of the item being played, -1 means "not playing yet"
 int g_playNext = -1;			// index of the next item to be played, -1 means "the end"
 int g_rgnLoop = 0;				// region loop count: 0 not looping, <0 infinite loop, n>0 looping n times
-bool g_plLoop = false;			// other (corner case) loops in the playlist?
-double g_lastRunPos = -1.0;
-double g_nextRgnPos, g_nextRgnEnd;
-double g_curRgnPos = 0.0, g_curRgnEnd = -1.0; // to detect unsync, end<pos means non relevant
+RgnPlaylistTimeline g_timeline;	// flattened g_playPlaylist
+RgnPlaylistScheduler g_scheduler;
 
 int g_oldSeekPref = -1;
 int g_oldStopprojlenPref = -1;
@@ -774,6 +776,9 @@ void RegionPlaylistWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 				}
 			}
 			break;
+		case SIMULATE_PLAYLIST_MSG:
+			SimulatePlaylist(g_pls.Get()->m_editId);
+			break;
 		case BTNID_PLAY:
 			PlaylistPlay(g_pls.Get()->m_editId, GetNextValidItem(g_pls.Get()->m_editId, 0, true, g_repeatPlaylist));
 			break;
@@ -1073,6 +1078,8 @@ void RegionPlaylistWnd::PlaylistMenu(HMENU _menu)
 	AddToMenu(_menu, __LOCALIZE("Copy playlist...","sws_DLG_165"), COPY_PLAYLIST_MSG, -1, false, GetPlaylist() ? MF_ENABLED : MF_GRAYED);
 	AddToMenu(_menu, __LOCALIZE("Delete","sws_DLG_165"), DEL_PLAYLIST_MSG, -1, false, GetPlaylist() ? MF_ENABLED : MF_GRAYED);
 	AddToMenu(_menu, __LOCALIZE("Rename...","sws_DLG_165"), REN_PLAYLIST_MSG, -1, false, GetPlaylist() ? MF_ENABLED : MF_GRAYED);
+	AddToMenu(_menu, SWS_SEPARATOR, 0);
+	AddToMenu(_menu, __LOCALIZE("Simulate playlist","sws_DLG_165"), SIMULATE_PLAYLIST_MSG, -1, false, GetPlaylist() && GetPlaylist()->GetSize() ? MF_ENABLED : MF_GRAYED);
 }
 
 void RegionPlaylistWnd::EditMenu(HMENU _menu)
@@ -1252,6 +1259,66 @@ int IsInPlaylists(double _pos)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// Playlist engine: project regions -> timeline, see SnM_RegionPlaylistTimeline.cpp
+///////////////////////////////////////////////////////////////////////////////
+
+#define RGNPL_SIM_TICK			0.03 // approx. SNM_CSurfRun() polling period
+
+// playlist items with their current region bounds, see RgnPlaylistTimeline::Build()
+void GetTimelineItems(RegionPlaylist* _pl, std::vector<RgnPlaylistTimelineItem>* _items)
+{
+	_items->clear();
+	for (int i=0; _pl && i<_pl->GetSize(); i++)
+	{
+		RgnPlaylistTimelineItem tlItem = { -1, 0, 0.0, 0.0 };
+		RgnPlaylistItem* item = _pl->Get(i);
+		if (item && item->m_rgnId>0 && EnumMarkerRegionById(NULL, item->m_rgnId, NULL, &tlItem.m_pos, &tlItem.m_end, NULL, NULL, NULL)>=0)
+		{
+			tlItem.m_rgnId = item->m_rgnId;
+			tlItem.m_cnt = item->m_cnt;
+		}
+		_items->push_back(tlItem);
+	}
+}
+
+// reports the seeks the playlist _plId would perform with the current regions
+void SimulatePlaylist(int _plId)
+{
+	RegionPlaylist* pl = GetPlaylist(_plId);
+	if (!pl)
+		return;
+
+	std::vector<RgnPlaylistTimelineItem> items;
+	GetTimelineItems(pl, &items);
+	RgnPlaylistTimeline tl;
+	tl.Build(items, g_repeatPlaylist);
+
+	// infinite loops/repeat: 10 minutes max
+	double len = pl->GetLength();
+	double maxTime = (len<0.0 || g_repeatPlaylist) ? 600.0 : len+1.0;
+
+	std::vector<RgnPlaylistSimSeek> seeks;
+	SimulateRegionPlaylist(&tl, tl.FindItem(GetNextValidItem(_plId, 0, true, g_repeatPlaylist)), g_lookahead, RGNPL_SIM_TICK, maxTime, &seeks);
+
+	WDL_FastString msg;
+	msg.SetFormatted(256, __LOCALIZE_VERFMT("Playlist #%d, %d seeks (lookahead: %d ms, polling: %d ms):","sws_DLG_165"), _plId+1, (int)seeks.size(), (int)(g_lookahead*1000.0+0.5), (int)(RGNPL_SIM_TICK*1000.0+0.5));
+	msg.Append("\n");
+	for (int i=0; i<(int)seeks.size(); i++)
+	{
+		char from[64]="", to[64]="";
+		RgnPlaylistSimSeek* s = &seeks[i];
+		format_timestr_pos(s->m_from, from, sizeof(from), -1);
+		format_timestr_pos(s->m_to, to, sizeof(to), -1);
+		msg.AppendFormatted(256, "%.3f: %s -> %s", s->m_time, from, s->m_end ? __LOCALIZE("<END>","sws_DLG_165") : to);
+		if (s->m_late)
+			msg.Append(__LOCALIZE(" (late)","sws_DLG_165"));
+		msg.Append("\n");
+	}
+	SNM_ShowMsg(msg.Get(), __LOCALIZE("S&M - Region Playlist simulation","sws_DLG_165"));
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // Polling on play: PlaylistRun() and related funcs
 ///////////////////////////////////////////////////////////////////////////////
@@ -1300,167 +1367,80 @@ int GetPrevValidItem(int _plId, int _itemId, bool _startWith, bool _repeat)
 	return -1;
 }
 
-bool SeekItem(int _plId, int _nextItemId, int _curItemId)
+// applies the scheduler requests + updates the vars used for monitoring
+void ApplySchedulerEvents(int _evt)
 {
-	if (RegionPlaylist* pl = g_pls.Get()->Get(_plId))
+	if (_evt & RGNPL_EVT_SEEK)
 	{
 		// trick to stop the playlist in sync: smooth seek to the end of the project (!)
-		if (_nextItemId<0)
+		if (_evt & RGNPL_EVT_END)
 		{
 			// temp override of the "stop play at project end" option
 			if (int* opt = (int*)GetConfigVar("stopprojlen")) {
-				g_oldStopprojlenPref = *opt;
+				if (g_oldStopprojlenPref<0) g_oldStopprojlenPref = *opt;
 				*opt = 1;
 			}
-			g_playNext = -1;
-			g_rgnLoop = 0;
-			g_nextRgnPos = SNM_GetProjectLength()+1.0;
-			g_nextRgnEnd = g_nextRgnPos+1.0;
-			SeekPlay(g_nextRgnPos);
-			return true;
+			SeekPlay(SNM_GetProjectLength()+1.0);
 		}
-		else if (RgnPlaylistItem* next = pl->Get(_nextItemId))
+		else
+			SeekPlay(g_scheduler.GetSeekPos());
+	}
+
+	RgnPlaylistSegment* cur = g_timeline.Get(g_scheduler.GetCur());
+	RgnPlaylistSegment* next = g_timeline.Get(g_scheduler.GetNext());
+	g_unsync = g_scheduler.IsUnsync();
+	if (cur) g_playCur = cur->m_itemId;
+	else if (!g_unsync) g_playCur = -1;
+	g_playNext = next ? next->m_itemId : -1;
+	g_rgnLoop = g_scheduler.GetLoopsLeft();
+}
+
+// (re)builds the flattened playlist, with the current regions
+void BuildTimeline(int _plId)
+{
+	std::vector<RgnPlaylistTimelineItem> items;
+	GetTimelineItems(g_pls.Get()->Get(_plId), &items);
+	g_timeline.Build(items, g_repeatPlaylist);
+	g_scheduler.Init(&g_timeline, g_lookahead);
+}
+
+// _nextItemId: item to play next, -1 to end the playlist
+// _curItemId: item being played, -1 if none (e.g. play start)
+bool SeekItem(int _plId, int _nextItemId, int _curItemId)
+{
+	if (g_pls.Get()->Get(_plId))
+	{
+		if (_plId != g_playPlaylist)
+			BuildTimeline(_plId);
+
+		int seg = -1;
+		if (_nextItemId>=0)
 		{
-			double a, b;
-			if (EnumMarkerRegionById(NULL, next->m_rgnId, NULL, &a, &b, NULL, NULL, NULL)>=0)
-			{
-				g_playNext = _nextItemId;
-				g_playCur = _plId==g_playPlaylist ? g_playCur : _curItemId;
-				g_rgnLoop = next->m_cnt<0 ? -1 : next->m_cnt>1 ? next->m_cnt : 0;
-				g_nextRgnPos = a;
-				g_nextRgnEnd = b;
-				if (_curItemId<0) {
-					g_curRgnPos = 0.0;
-					g_curRgnEnd = -1.0;
-				}
-				SeekPlay(g_nextRgnPos);
-				return true;
-			}
+			seg = g_timeline.FindItem(_nextItemId);
+			if (seg<0)
+				return false;
 		}
+		ApplySchedulerEvents(g_scheduler.Seek(seg, _curItemId>=0 && _plId==g_playPlaylist));
+		return true;
 	}
 	return false;
 }
 
 // the meat!
-// polls the playing position and smooth seeks if needed
-// remember we always lookup one region ahead!
+// polls the playing position (audio buffer position) and smooth seeks if needed
+// remember we always lookup one region ahead, see RgnPlaylistScheduler
 // made as idle as possible, polled via SNM_CSurfRun()
 void PlaylistRun()
 {
 	if (g_playPlaylist>=0)
 	{
-#if defined(_SNM_RGNPL_DEBUG1) || defined(_SNM_RGNPL_DEBUG2)
-		char dbg[256] = "";
-#endif
-		bool updated = false;
-		double pos = GetPlayPosition2Ex(NULL);
-
-		// NF: potentially fix #886
-		// it seems that if '+0.01' isn't added to 'pos' below, adjacent regions are no more occassionally skipped
-		// https://forum.cockos.com/showpost.php?p=1935561&postcount=6 and my own tests so far seem to confirm also
-		// but I'm unsure what poetential side effects this might have
-		if ((pos/*+0.01*/) >= g_nextRgnPos && pos <= g_nextRgnEnd)	//JFB!! +0.01 because 'pos' can be a bit ahead of time
-																// +1 sample block would be better, but no API..
-																// note: sync loss detection will deal with this in the worst case
-		{
-			// a bunch of calls end here when looping!!
-
-			if (!g_plLoop || (g_plLoop && (g_unsync || pos<g_lastRunPos)))
-			{
-				g_plLoop = false;
-
-				bool first = false;
-				if (g_playCur != g_playNext 
-/*JFB those vars are only altered here
-					|| g_curRgnPos != g_nextRgnPos || g_curRgnEnd != g_nextRgnEnd
-*/
-					)
-				{
-#ifdef _SNM_RGNPL_DEBUG1
-					 OutputDebugString("\n");
-					_snprintfSafe(dbg, sizeof(dbg), "NEXT DETECTED - pos = %f\n", pos); OutputDebugString(dbg);
-					_snprintfSafe(dbg, sizeof(dbg), "                g_curRgnPos = %f, g_curRgnEnd = %f\n", g_curRgnPos, g_curRgnEnd); OutputDebugString(dbg);
-					_snprintfSafe(dbg, sizeof(dbg), "                g_nextRgnPos = %f, g_nextRgnEnd = %f\n", g_nextRgnPos, g_nextRgnEnd); OutputDebugString(dbg);
-					_snprintfSafe(dbg, sizeof(dbg), "                g_playCur = %d, g_playNext = %d\n", g_playCur, g_playNext); OutputDebugString(dbg);
-					_snprintfSafe(dbg, sizeof(dbg), "                g_unsync = %d, g_lastRunPos = %f\n", g_unsync, g_lastRunPos); OutputDebugString(dbg);
-#endif
-					first = updated = true;
-					g_playCur = g_playNext;
-					g_curRgnPos = g_nextRgnPos;
-					g_curRgnEnd = g_nextRgnEnd;
-				}
-
-				// region loop?
-				if (g_rgnLoop && (first || g_unsync || pos<g_lastRunPos))
-				{
-					updated = true;
-					if (g_rgnLoop>0)
-						g_rgnLoop--;
-					if (g_rgnLoop)
-						SeekPlay(g_nextRgnPos); // then exit
-				}
+		int evt = g_scheduler.Process(GetPlayPosition2Ex(NULL));
+		if (!evt)
+			return;
 
-				if (!g_rgnLoop) // if, not else if!
-				{
-					int nextId = GetNextValidItem(g_playPlaylist, g_playCur, false, g_repeatPlaylist);
-
-					// loop corner cases
-					// ex: 1 item in the playlist + repeat on, or repeat on + last region == first region,
-					//     or playlist = region3, then unknown region (e.g. deleted) and region3 again, or etc..
-					if (nextId>=0)
-						if (RegionPlaylist* pl = GetPlaylist(g_playPlaylist))
-							if (RgnPlaylistItem* next = pl->Get(nextId)) 
-								if (RgnPlaylistItem* cur = pl->Get(g_playCur)) 
-									g_plLoop = (cur->m_rgnId==next->m_rgnId); // valid regions at this point
-
-#ifdef _SNM_RGNPL_DEBUG1
-					_snprintfSafe(dbg, sizeof(dbg), "SEEK - Current = %d, Next = %d\n", g_playCur, nextId); OutputDebugString(dbg);
-#endif
-					if (!SeekItem(g_playPlaylist, nextId, g_playCur))
-						SeekItem(g_playPlaylist, -1, g_playCur); // end of playlist..
-					updated = true;
-				}
-			}
-			g_unsync = false;
-		}
-		else if (g_curRgnPos<g_curRgnEnd) // relevant vars?
-		{
-			// seek play requested, waiting for region switch..
-			if ((pos+0.01) >= g_curRgnPos && pos <= g_curRgnEnd) //JFB!! +0.01 because 'pos' can be a bit ahead of time
-																 // +1 sample block would be better, but no API..
-			{
-				// a bunch of calls end here!
-				g_unsync = false;
-			}
-			// playlist no more in sync?
-			else if (!g_unsync)
-			{
-#ifdef _SNM_RGNPL_DEBUG2
-				_snprintfSafe(dbg, sizeof(dbg), ">>> SYNC LOSS - pos = %f\n", pos); OutputDebugString(dbg);
-				_snprintfSafe(dbg, sizeof(dbg), "                g_curRgnPos = %f, g_curRgnEnd = %f\n", g_curRgnPos, g_curRgnEnd); OutputDebugString(dbg);
-				_snprintfSafe(dbg, sizeof(dbg), "                g_nextRgnPos = %f, g_nextRgnEnd = %f\n", g_nextRgnPos, g_nextRgnEnd); OutputDebugString(dbg);
-#endif
-				updated = g_unsync = true;
-				int spareItemId = -1;
-				if (RegionPlaylist* pl = g_pls.Get()->Get(g_playPlaylist))
-					spareItemId = pl->IsInPlaylist(pos, g_repeatPlaylist, g_playCur>=0?g_playCur:0);
-				if (spareItemId<0 || !SeekItem(g_playPlaylist, spareItemId, -1))
-				{
-#ifdef _SNM_RGNPL_DEBUG2
-					_snprintfSafe(dbg, sizeof(dbg), ">>> SYNC LOSS, SEEK expected region pos = %f\n", g_nextRgnPos); OutputDebugString(dbg);
-#endif
-					SeekPlay(g_nextRgnPos);	// try to resync the expected region, best effort
-				}
-#ifdef _SNM_RGNPL_DEBUG2
-				else {
-					_snprintfSafe(dbg, sizeof(dbg), ">>> SYNC LOSS, SEEK - Current = %d, Next = %d\n", -1, spareItemId); OutputDebugString(dbg);
-				}
-#endif
-			}
-		}
+		ApplySchedulerEvents(evt);
 
-		g_lastRunPos = pos;
-		if (updated && (g_osc || g_rgnplWndMgr.Get()))
+		if (g_osc || g_rgnplWndMgr.Get())
 		{
 			// one call to GetMonitoringInfo() for both the wnd & osc
 			WDL_FastString cur, curNum, next, nextNum;
@@ -1554,9 +1534,6 @@ void PlaylistPlay(int _plId, int _itemId)
 				GetSetRepeat(0);
 			}
 
-			g_plLoop = false;
-			g_unsync = false;
-			g_lastRunPos = SNM_GetProjectLength()+1.0;
 			if (SeekItem(_plId, _itemId, g_playPlaylist==_plId ? g_playCur : -1))
 			{
 				g_playPlaylist = _plId; // enables PlaylistRun()
@@ -1663,11 +1640,29 @@ void PlaylistUnpaused() {
 }
 
 // used when editing the playlist/regions while playing (required because we always look one region ahead)
+// rebuilds the flattened playlist and re-maps the current/next segments (current loop is preserved)
 void PlaylistResync()
 {
-	if (RegionPlaylist* pl = GetPlaylist(g_playPlaylist))
-		if (RgnPlaylistItem* item = pl->Get(g_playCur))
-			SeekItem(g_playPlaylist, GetNextValidItem(g_playPlaylist, g_playCur, item->m_cnt<0 || item->m_cnt>1, g_repeatPlaylist), g_playCur);
+	if (GetPlaylist(g_playPlaylist))
+	{
+		RgnPlaylistSegment* cur = g_timeline.Get(g_scheduler.GetCur());
+		RgnPlaylistSegment* next = g_timeline.Get(g_scheduler.GetNext());
+		int curItem = cur ? cur->m_itemId : -1, curLoop = cur ? cur->m_loop : 0;
+		int nextItem = next ? next->m_itemId : -1, nextLoop = next ? next->m_loop : 0;
+		bool unsync = g_scheduler.IsUnsync();
+
+		BuildTimeline(g_playPlaylist);
+
+		int curSeg = curItem>=0 ? g_timeline.FindItem(curItem, curLoop) : -1;
+		int nextSeg = nextItem>=0 ? g_timeline.FindItem(nextItem, nextLoop) : -1;
+		if (curSeg>=0 || nextSeg>=0)
+			ApplySchedulerEvents(g_scheduler.Resync(curSeg, nextSeg));
+		else if (!unsync)
+		{
+			int itemId = GetNextValidItem(g_playPlaylist, curItem>=0 ? curItem : 0, true, g_repeatPlaylist);
+			ApplySchedulerEvents(g_scheduler.Seek(g_timeline.FindItem(itemId), false));
+		}
+	}
 }
 
 void SetPlaylistRepeat(COMMAND_T* _ct)
@@ -2092,6 +2087,8 @@ int RegionPlaylistInit()
 	g_repeatPlaylist = (GetPrivateProfileInt("RegionPlaylist", "Repeat", 0, g_SNM_IniFn.Get()) == 1);
 	g_seekImmediate = (GetPrivateProfileInt("RegionPlaylist", "SeekImmediate", 0, g_SNM_IniFn.Get()) == 1);
 	g_optionFlags = (GetPrivateProfileInt("RegionPlaylist", "SeekPlay", 0, g_SNM_IniFn.Get()) == 1);
+	g_lookahead = BOUNDED(GetPrivateProfileInt("RegionPlaylist", "Lookahead", 10, g_SNM_IniFn.Get()), 0, 1000) / 1000.0; // ms
+
 	GetPrivateProfileString("RegionPlaylist", "BigFontName", SNM_DYN_FONT_NAME, g_rgnplBigFontName, sizeof(g_rgnplBigFontName), g_SNM_IniFn.Get());
 	GetPrivateProfileString("RegionPlaylist", "OscFeedback", "", buf, sizeof(buf), g_SNM_IniFn.Get());
 	g_osc = LoadOscCSurfs(NULL, buf); // NULL on err (e.g. "", token doesn't exist, etc.)
@@ -2115,6 +2112,9 @@ void RegionPlaylistExit()
 	WritePrivateProfileString("RegionPlaylist", "ScrollView", NULL, g_SNM_IniFn.Get()); // deprecated
 	WritePrivateProfileString("RegionPlaylist", "SeekImmediate", g_seekImmediate?"1":"0", g_SNM_IniFn.Get());
 	WritePrivateProfileString("RegionPlaylist", "SeekPlay", g_optionFlags?"1":"0", g_SNM_IniFn.Get()); 
+	char lookahead[16]="";
+	_snprintfSafe(lookahead, sizeof(lookahead), "%d", (int)(g_lookahead*1000.0+0.5));
+	WritePrivateProfileString("RegionPlaylist", "Lookahead", lookahead, g_SNM_IniFn.Get());
 	WritePrivateProfileString("RegionPlaylist", "BigFontName", g_rgnplBigFontName, g_SNM_IniFn.Get());
 	if (g_osc)
 	{
@@ -31,6 +31,7 @@
 #define _SNM_REGIONPLAYLIST_H_
 
 #include "SnM_Marker.h"
+#include "SnM_RegionPlaylistTimeline.h"
 #include "SnM_VWnd.h"
 
 
@@ -71,6 +72,10 @@ public:
 	int m_editId; // edited playlist id
 };
 
+
+void SimulatePlaylist(int _plId);
+
+
 class RegionPlaylistView : public SWS_ListView {
 public:
 	RegionPlaylistView(HWND hwndList, HWND hwndEdit);
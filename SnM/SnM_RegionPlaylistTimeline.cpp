@@ -0,0 +1,261 @@
+/******************************************************************************
+/ SnM_RegionPlaylistTimeline.cpp
+/
+/ Copyright (c) 2012 and later Jeffos
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+#include "stdafx.h"
+#include "SnM_RegionPlaylistTimeline.h"
+
+
+#define RGNPL_SYNC_TOLERANCE	0.01 // 'pos' can be a bit ahead of time, +1 sample block would be better, but no API..
+
+// invalid items and items without loops are skipped (m_itemId keeps the
+// item index), same rules as RgnPlaylistItem::IsValidIem()
+void RgnPlaylistTimeline::Build(const std::vector<RgnPlaylistTimelineItem>& _items, bool _repeat)
+{
+	m_repeat = _repeat;
+	m_segs.clear();
+	for (int i=0; i<(int)_items.size(); i++)
+	{
+		const RgnPlaylistTimelineItem& item = _items[i];
+		if (item.m_rgnId>0 && item.m_cnt!=0)
+		{
+			RgnPlaylistSegment seg;
+			seg.m_itemId = i;
+			seg.m_rgnId = item.m_rgnId;
+			seg.m_loops = item.m_cnt;
+			seg.m_pos = item.m_pos;
+			seg.m_end = item.m_end;
+			int loops = item.m_cnt<0 ? 1 : item.m_cnt;
+			for (seg.m_loop=0; seg.m_loop<loops; seg.m_loop++)
+				m_segs.push_back(seg);
+		}
+	}
+}
+
+// same rules as GetNextValidItem()
+int RgnPlaylistTimeline::GetNext(int _seg)
+{
+	RgnPlaylistSegment* seg = Get(_seg);
+	if (!seg)
+		return -1;
+	if (seg->m_loops<0) // infinite loop
+		return _seg;
+	if ((_seg+1) < (int)m_segs.size())
+		return _seg+1;
+	return m_repeat ? 0 : -1;
+}
+
+// returns the segment of the _loop-th play of the item _itemId, -1 if not found
+int RgnPlaylistTimeline::FindItem(int _itemId, int _loop)
+{
+	// segments are sorted by item ids
+	int lo=0, hi=(int)m_segs.size();
+	while (lo<hi)
+	{
+		int mid = (lo+hi)/2;
+		if (m_segs[mid].m_itemId < _itemId) lo = mid+1;
+		else hi = mid;
+	}
+	if (lo<(int)m_segs.size() && m_segs[lo].m_itemId == _itemId)
+	{
+		const RgnPlaylistSegment& seg = m_segs[lo];
+		return lo + (seg.m_loops>0 ? std::max(0, std::min(_loop, seg.m_loops-1)) : 0);
+	}
+	return -1;
+}
+
+// returns the 1st play of the 1st item whose region contains _pos, starting 
+// with the item _startWithItem (and then from the start when repeating)
+// see RegionPlaylist::IsInPlaylist()
+int RgnPlaylistTimeline::FindPos(double _pos, int _startWithItem)
+{
+	for (int pass=0; pass<(m_repeat?2:1); pass++)
+		for (int i=0; i<(int)m_segs.size(); i++)
+		{
+			RgnPlaylistSegment* seg = &m_segs[i];
+			if (!seg->m_loop && (pass ? seg->m_itemId<_startWithItem : seg->m_itemId>=_startWithItem) &&
+				_pos>=seg->m_pos && _pos<=seg->m_end)
+			{
+				return i;
+			}
+		}
+	return -1;
+}
+
+int RgnPlaylistScheduler::QueueNext()
+{
+	if (RgnPlaylistSegment* next = m_tl ? m_tl->Get(m_next) : NULL)
+	{
+		m_seekPos = next->m_pos;
+		return RGNPL_EVT_SEEK;
+	}
+	m_next = -1;
+	return RGNPL_EVT_SEEK|RGNPL_EVT_END;
+}
+
+// _seg: segment to play next, -1 to end the playlist
+// _keepCur: true to keep on playing the current segment until the seek (e.g. 
+//           previous/next actions while playing), false otherwise (e.g. play)
+int RgnPlaylistScheduler::Seek(int _seg, bool _keepCur)
+{
+	if (!_keepCur)
+		m_cur = -1;
+	m_next = _seg;
+	m_unsync = false;
+	m_lastPos = DBL_MAX; // as if the play position has just looped
+	return QueueNext();
+}
+
+// re-maps current/next segments after a timeline rebuild
+// _nextSeg: only used when the current segment is unknown
+int RgnPlaylistScheduler::Resync(int _curSeg, int _nextSeg)
+{
+	m_cur = _curSeg;
+	m_next = _curSeg>=0 && m_tl ? m_tl->GetNext(_curSeg) : _nextSeg;
+	m_unsync = false;
+	return QueueNext();
+}
+
+// _pos: play position (audio buffer position)
+// returns RGNPL_EVT_xxx flags
+int RgnPlaylistScheduler::Process(double _pos)
+{
+	int evt = 0;
+	if (!m_tl)
+		return evt;
+
+	RgnPlaylistSegment* cur = m_tl->Get(m_cur);
+	RgnPlaylistSegment* next = m_tl->Get(m_next);
+
+	// the lookahead only applies once the current region has been left: the 
+	// smooth seek has been performed already (adjacent regions, see issue 886)
+	bool inCur = cur && _pos>=cur->m_pos && _pos<=cur->m_end;
+	if (next && (_pos>=next->m_pos || (!inCur && (_pos+m_lookahead)>=next->m_pos)) && _pos<=next->m_end)
+	{
+		// same region as the current one (region loops, playlist loops, etc): 
+		// wait for the smooth seek, i.e. for the play position to go back
+		if (!cur || m_unsync || cur->m_pos!=next->m_pos || cur->m_end!=next->m_end || _pos<m_lastPos)
+		{
+			m_cur = m_next;
+			m_next = m_tl->GetNext(m_cur);
+			evt |= RGNPL_EVT_NEXT|QueueNext();
+		}
+		m_unsync = false;
+	}
+	else if (cur)
+	{
+		// seek requested, waiting for region switch..
+		if ((_pos+RGNPL_SYNC_TOLERANCE)>=cur->m_pos && _pos<=cur->m_end)
+		{
+			m_unsync = false;
+		}
+		// playlist no more in sync? (ignored when stopping, see RGNPL_EVT_END)
+		else if (!m_unsync && m_next>=0)
+		{
+			m_unsync = true;
+			int seg = m_tl->FindPos(_pos, cur->m_itemId);
+			if (seg>=0) {
+				m_cur = -1;
+				m_next = seg;
+			}
+			// else: try to resync the expected region, best effort
+			evt |= RGNPL_EVT_UNSYNC|QueueNext();
+		}
+	}
+	m_lastPos = _pos;
+	return evt;
+}
+
+// remaining loops of the current item, see g_rgnLoop
+int RgnPlaylistScheduler::GetLoopsLeft()
+{
+	RgnPlaylistSegment* cur = m_tl ? m_tl->Get(m_cur) : NULL;
+	RgnPlaylistSegment* next = m_tl ? m_tl->Get(m_next) : NULL;
+	if (!next)
+		return 0;
+	if (next->m_loops<0)
+		return -1;
+	if (cur && cur->m_itemId==next->m_itemId)
+		return next->m_loops - next->m_loop;
+	return 0;
+}
+
+// deterministic offline simulation of a playlist
+// emulates a transport that starts with _startSeg, that is polled every _tick
+// seconds, and that performs smooth seeks at the end of the region being played
+// returns the number of performed seeks (including the 1st one), see _seeksOut
+int SimulateRegionPlaylist(RgnPlaylistTimeline* _tl, int _startSeg, double _lookahead, double _tick, double _maxTime, std::vector<RgnPlaylistSimSeek>* _seeksOut)
+{
+	if (!_tl || !_seeksOut || _tick<=0.0 || !_tl->Get(_startSeg))
+		return 0;
+	_seeksOut->clear();
+
+	RgnPlaylistScheduler sched;
+	sched.Init(_tl, _lookahead);
+	sched.Seek(_startSeg, false);
+
+	// transport stopped: the 1st seek is immediate
+	RgnPlaylistSimSeek seek = { 0.0, 0.0, 0.0, sched.GetSeekPos(), false, false };
+	_seeksOut->push_back(seek);
+
+	double t=0.0, pos=seek.m_to, playEnd=_tl->Get(_startSeg)->m_end, pendingEnd=0.0;
+	bool pending = false;
+	for (;;)
+	{
+		int evt = sched.Process(pos);
+		if (evt & RGNPL_EVT_SEEK) // replaces any pending seek, like smooth seeks do
+		{
+			RgnPlaylistSegment* next = _tl->Get(sched.GetNext());
+			seek.m_reqTime = t;
+			seek.m_to = next ? next->m_pos : pos;
+			seek.m_end = (evt & RGNPL_EVT_END) != 0;
+			seek.m_late = pos>playEnd;
+			pendingEnd = next ? next->m_end : pos;
+			pending = true;
+		}
+
+		if (t>=_maxTime)
+			break;
+
+		double newPos = pos+_tick;
+		if (pending && newPos>=playEnd)
+		{
+			// smooth seek at the end of the region, or asap when requested too late
+			double dt = pos>=playEnd ? 0.0 : playEnd-pos;
+			seek.m_time = t+dt;
+			seek.m_from = pos+dt;
+			_seeksOut->push_back(seek);
+			if (seek.m_end)
+				break;
+			newPos = seek.m_to+(_tick-dt);
+			playEnd = pendingEnd;
+			pending = false;
+		}
+		t += _tick;
+		pos = newPos;
+	}
+	return (int)_seeksOut->size();
+}
@@ -0,0 +1,114 @@
+/******************************************************************************
+/ SnM_RegionPlaylistTimeline.h
+/
+/ Copyright (c) 2012 and later Jeffos
+/
+/
+/ Permission is hereby granted, free of charge, to any person obtaining a copy
+/ of this software and associated documentation files (the "Software"), to deal
+/ in the Software without restriction, including without limitation the rights to
+/ use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+/ of the Software, and to permit persons to whom the Software is furnished to
+/ do so, subject to the following conditions:
+/ 
+/ The above copyright notice and this permission notice shall be included in all
+/ copies or substantial portions of the Software.
+/ 
+/ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+/ EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+/ OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+/ NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+/ HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+/ WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+/ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+/ OTHER DEALINGS IN THE SOFTWARE.
+/
+******************************************************************************/
+
+//#pragma once
+
+#ifndef _SNM_REGIONPLAYLISTTIMELINE_H_
+#define _SNM_REGIONPLAYLISTTIMELINE_H_
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Playlist engine, see PlaylistRun()
+// note: no REAPER API calls (nor WDL) here, the timeline is built from plain
+// playlist item data (region bounds included) so that the engine can be 
+// simulated offline, see SimulateRegionPlaylist() and tests/
+///////////////////////////////////////////////////////////////////////////////
+
+// one playlist item with the bounds of its region
+struct RgnPlaylistTimelineItem {
+	int m_rgnId;   // <=0 for invalid items (e.g. region removed)
+	int m_cnt;     // loop count, <0 for infinite loops
+	double m_pos, m_end;
+};
+
+// one region play of the flattened playlist (i.e. regions x loop counts)
+struct RgnPlaylistSegment {
+	int m_itemId;  // playlist item index
+	int m_rgnId;
+	int m_loop;    // 0-based loop index (always 0 for infinite loops)
+	int m_loops;   // item loop count, <0 for infinite loops
+	double m_pos, m_end;
+};
+
+class RgnPlaylistTimeline {
+public:
+	RgnPlaylistTimeline() : m_repeat(false) {}
+	void Build(const std::vector<RgnPlaylistTimelineItem>& _items, bool _repeat);
+	void Clear() { m_segs.clear(); }
+	int GetSize() { return (int)m_segs.size(); }
+	RgnPlaylistSegment* Get(int _seg) { return _seg>=0 && _seg<(int)m_segs.size() ? &m_segs[_seg] : NULL; }
+	int GetNext(int _seg);
+	int FindItem(int _itemId, int _loop = 0);
+	int FindPos(double _pos, int _startWithItem);
+private:
+	std::vector<RgnPlaylistSegment> m_segs;
+	bool m_repeat;
+};
+
+enum {
+  RGNPL_EVT_NEXT=1,   // entered the next segment
+  RGNPL_EVT_SEEK=2,   // (smooth) seek requested, see RgnPlaylistScheduler::GetSeekPos()
+  RGNPL_EVT_END=4,    // end of playlist reached (with RGNPL_EVT_SEEK)
+  RGNPL_EVT_UNSYNC=8  // play position is no more part of the playlist
+};
+
+// decides when to enter the next segment, and which seek must be queued:
+// we always look one segment ahead, the transition itself is performed by 
+// REAPER's smooth seek at the end of the current region
+class RgnPlaylistScheduler {
+public:
+	RgnPlaylistScheduler() : m_tl(NULL), m_lookahead(0.0), m_lastPos(0.0), m_seekPos(0.0), m_cur(-1), m_next(-1), m_unsync(false) {}
+	void Init(RgnPlaylistTimeline* _tl, double _lookahead) { m_tl=_tl; m_lookahead=_lookahead; m_cur=m_next=-1; m_unsync=false; }
+	void SetLookahead(double _lookahead) { m_lookahead = _lookahead; }
+	int Seek(int _seg, bool _keepCur);
+	int Resync(int _curSeg, int _nextSeg);
+	int Process(double _pos);
+	int GetCur() { return m_cur; }
+	int GetNext() { return m_next; }
+	double GetSeekPos() { return m_seekPos; }
+	bool IsUnsync() { return m_unsync; }
+	int GetLoopsLeft();
+private:
+	int QueueNext();
+	RgnPlaylistTimeline* m_tl;
+	double m_lookahead, m_lastPos, m_seekPos;
+	int m_cur, m_next; // segment indexes, -1 when not relevant (m_next: -1 means "the end")
+	bool m_unsync;
+};
+
+// offline playlist simulation report, times in seconds (transport time)
+struct RgnPlaylistSimSeek {
+	double m_reqTime; // when the seek was requested
+	double m_time;    // when the seek was performed
+	double m_from, m_to;
+	bool m_end;       // end of playlist
+	bool m_late;      // requested after the end of the region being played
+};
+
+int SimulateRegionPlaylist(RgnPlaylistTimeline* _tl, int _startSeg, double _lookahead, double _tick, double _maxTime, std::vector<RgnPlaylistSimSeek>* _seeksOut);
+
+#endif
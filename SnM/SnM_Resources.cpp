@@ -705,8 +705,9 @@ void ResourcesView::SetItemText(SWS_ListItem* item, int iCol, const char* str)
 							UntieResFileFromProject(fn, g_resType);
 							TieResFileToProject(newFn, g_resType);
 
-							ListView_SetItemText(m_hwndList, GetEditingItem(), DisplayToDataCol(2), (LPSTR)pItem->m_shortPath.Get());
-							// ^^ direct GUI update because Update() is no-op when editing
+							ListView_RedrawItems(m_hwndList, GetEditingItem(), GetEditingItem());
+							// ^^ direct GUI update because Update() only refreshes the rows when editing
+							//    (owner data list: no item text to set, the redraw pulls the new name)
 						}
 					}
 				}
@@ -30,13 +30,58 @@
 #include "WDL/projectcontext.h"
 #include "../reaper/localize.h"
 #include "../Utility/Base64.h"
+#include "WDL/zlib/zlib.h"
 #include "SnapshotClass.h"
 #include "Snapshots.h"
 
+void SnapshotPayloadWriter::AddBytes(const void* p, int iLen)
+{
+	int iPos = m_buf.GetSize();
+	if (iLen > 0 && m_buf.Resize(iPos + iLen, false))
+		memcpy(m_buf.Get() + iPos, p, iLen);
+}
+
+void SnapshotPayloadWriter::AddString(const char* str)
+{
+	int iLen = str ? (int)strlen(str) : 0;
+	AddInt(iLen);
+	AddBytes(str, iLen);
+}
+
+bool SnapshotPayloadReader::GetBytes(void* p, int iLen)
+{
+	if (m_bErr || iLen < 0 || iLen > m_iLen - m_iPos)
+	{
+		m_bErr = true;
+		return false;
+	}
+	memcpy(p, m_p + m_iPos, iLen);
+	m_iPos += iLen;
+	return true;
+}
+
+const char* SnapshotPayloadReader::GetString(WDL_FastString* str)
+{
+	int iLen = GetInt();
+	if (m_bErr || iLen < 0 || iLen > m_iLen - m_iPos)
+	{
+		m_bErr = true;
+		str->Set("");
+	}
+	else
+	{
+		str->Set((const char*)m_p + m_iPos, iLen);
+		m_iPos += iLen;
+	}
+	return str->Get();
+}
+
 FXSnapshot::FXSnapshot(MediaTrack* tr, int fx)
 {
 	m_iCurParam = 0;
 	TrackFX_GetFXName(tr, fx, m_cName, 256);
+	const GUID* g = TrackFX_GetFXGUID(tr, fx);
+	m_guid = g ? *g : GUID_NULL;
 	m_iNumParams = TrackFX_GetNumParams(tr, fx);
 	if (m_iNumParams)
 		m_dParams = new double[m_iNumParams];
@@ -51,6 +96,7 @@ FXSnapshot::FXSnapshot(FXSnapshot& fx)
 {
 	m_iNumParams = fx.m_iNumParams;
 	m_iCurParam  = fx.m_iCurParam;
+	m_guid       = fx.m_guid;
 	strcpy(m_cName, fx.m_cName);
 	if (m_iNumParams)
 	{
@@ -66,8 +112,13 @@ FXSnapshot::FXSnapshot(LineParser* lp)
 	m_iCurParam = 0;
 	strncpy(m_cName, lp->gettoken_str(1), 256);
 	m_cName[255] = 0;
+	m_guid = GUID_NULL;
 	if (strcmp("<FX", lp->gettoken_str(0)) == 0)
+	{
 		m_iNumParams = lp->gettoken_int(2);
+		if (lp->getnumtokens() > 3)
+			stringToGuid(lp->gettoken_str(3), &m_guid);
+	}
 	else
 		m_iNumParams = lp->getnumtokens() - 2;
 
@@ -81,6 +132,26 @@ FXSnapshot::FXSnapshot(LineParser* lp)
 			m_dParams[i] = lp->gettoken_float(i+2);
 }
 
+FXSnapshot::FXSnapshot(SnapshotPayloadReader* r)
+{
+	WDL_FastString name;
+	lstrcpyn(m_cName, r->GetString(&name), 256);
+	r->GetBytes(&m_guid, sizeof(GUID));
+	m_iNumParams = r->GetInt();
+	m_iCurParam = 0;
+	if (r->Error() || m_iNumParams < 0)
+		m_iNumParams = 0;
+
+	if (m_iNumParams)
+	{
+		m_dParams = new double[m_iNumParams];
+		if (!r->GetBytes(m_dParams, m_iNumParams * sizeof(double)))
+			memset(m_dParams, 0, m_iNumParams * sizeof(double));
+	}
+	else
+		m_dParams = NULL;
+}
+
 FXSnapshot::~FXSnapshot()
 {
 	delete [] m_dParams;
@@ -88,7 +159,9 @@ FXSnapshot::~FXSnapshot()
 
 void FXSnapshot::GetChunk(WDL_FastString *chunk)
 {
-	chunk->AppendFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "<FX \"%s\" %d\n", m_cName, m_iNumParams);
+	char guidStr[64];
+	guidToString(&m_guid, guidStr);
+	chunk->AppendFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "<FX \"%s\" %d %s\n", m_cName, m_iNumParams, guidStr);
 	int iDoublesLeft = m_iNumParams;
 	int iLine = 0;
 	Base64 b64;
@@ -107,6 +180,15 @@ void FXSnapshot::GetChunk(WDL_FastString *chunk)
 	chunk->Append(">\n");
 }
 
+// Params are stored as raw doubles, no more text lines
+void FXSnapshot::GetPayload(SnapshotPayloadWriter* w)
+{
+	w->AddString(m_cName);
+	w->AddBytes(&m_guid, sizeof(GUID));
+	w->AddInt(m_iNumParams);
+	w->AddBytes(m_dParams, m_iNumParams * sizeof(double));
+}
+
 void FXSnapshot::RestoreParams(const char* str)
 {
 	Base64 b64;
@@ -121,41 +203,48 @@ void FXSnapshot::RestoreParams(const char* str)
 		m_dParams[m_iCurParam++] = newDoubles[i];
 }
 
-int FXSnapshot::UpdateReaper(MediaTrack* tr, bool* bMatched, int num)
+// Match the FX by GUID, or by name if not found (or if no GUID was stored), plus the param count
+static int FindFX(FXSnapshot* fxs, MediaTrack* tr, bool* bMatched, int num)
 {
-	// Match the name and count of the FX
-	int fx;
+	if (!GuidsEqual(&fxs->m_guid, &GUID_NULL))
+		for (int fx = 0; fx < num; fx++)
+			if ((!bMatched || !bMatched[fx]) && GuidsEqual(&fxs->m_guid, TrackFX_GetFXGUID(tr, fx)) && fxs->m_iNumParams == TrackFX_GetNumParams(tr, fx))
+				return fx;
+
 	char name[256];
-	for (fx = 0; fx < num; fx++)
+	for (int fx = 0; fx < num; fx++)
 	{
 		TrackFX_GetFXName(tr, fx, name, 256);
-		if (!bMatched[fx] && strcmp(m_cName, name) == 0 && m_iNumParams == TrackFX_GetNumParams(tr, fx))
-			break;
+		if ((!bMatched || !bMatched[fx]) && strcmp(fxs->m_cName, name) == 0 && fxs->m_iNumParams == TrackFX_GetNumParams(tr, fx))
+			return fx;
 	}
+	return -1;
+}
 
-	if (fx >= num)
+// Only sets the params that differ from the current ones, iParamsSet is incremented accordingly
+int FXSnapshot::UpdateReaper(MediaTrack* tr, bool* bMatched, int num, int* iParamsSet)
+{
+	int fx = FindFX(this, tr, bMatched, num);
+	if (fx < 0)
 		return -1;
 
+	double dMin, dMax;
 	for (int i = 0; i < m_iNumParams; i++)
-		TrackFX_SetParam(tr, fx, i, m_dParams[i]);
+	{
+		double dCur = TrackFX_GetParam(tr, fx, i, &dMin, &dMax);
+		if (fabs(dCur - m_dParams[i]) > FX_PARAM_TOLERANCE * max(1.0, fabs(dMax - dMin)))
+		{
+			TrackFX_SetParam(tr, fx, i, m_dParams[i]);
+			(*iParamsSet)++;
+		}
+	}
 
 	return fx;
 }
 
 bool FXSnapshot::Exists(MediaTrack* tr)
 {
-	// Match the name and count of the FX
-	int fx;
-	char name[256];
-	int num = TrackFX_GetCount(tr);
-	for (fx = 0; fx < num; fx++)
-	{
-		TrackFX_GetFXName(tr, fx, name, 256);
-		if (strcmp(m_cName, name) == 0 && m_iNumParams == TrackFX_GetNumParams(tr, fx))
-			break;
-	}
-
-	return fx < num;
+	return FindFX(this, tr, NULL, TrackFX_GetCount(tr)) >= 0;
 }
 
 TrackSnapshot::TrackSnapshot(MediaTrack* tr, int mask)
@@ -270,13 +359,39 @@ TrackSnapshot::TrackSnapshot(LineParser* lp)
 		m_iTrackNum = -1;
 }
 
+// Builds the track from the payload, the remaining text data (sends, FX chain and envelopes)
+// is returned in tail and still goes through the chunk parser
+TrackSnapshot::TrackSnapshot(SnapshotPayloadReader* r, WDL_FastString* tail)
+{
+	r->GetBytes(&m_guid, sizeof(GUID));
+	m_dVol		= r->GetDouble();
+	m_dPan		= r->GetDouble();
+	m_bMute		= r->GetInt() ? true : false;
+	m_iSolo		= r->GetInt();
+	m_iFXEn		= r->GetInt();
+	m_iVis		= r->GetInt();
+	m_iSel		= r->GetInt();
+	m_iPanMode	= r->GetInt();
+	m_dPanWidth	= r->GetDouble();
+	m_dPanL		= r->GetDouble();
+	m_dPanR		= r->GetDouble();
+	m_dPanLaw	= r->GetDouble();
+	r->GetString(&m_sName);
+	m_iTrackNum	= r->GetInt();
+
+	int iNumFX = r->GetInt();
+	for (int i = 0; i < iNumFX && !r->Error(); i++)
+		m_fx.Add(new FXSnapshot(r));
+	r->GetString(tail);
+}
+
 TrackSnapshot::~TrackSnapshot()
 {
 	m_fx.Empty(true);
 }
 
 // Returns true if cannot find the track to update!
-bool TrackSnapshot::UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix)
+bool TrackSnapshot::UpdateReaper(int mask, bool bSelOnly, int* fxErr, int* fxParamsSet, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix)
 {
 	MediaTrack* tr = GuidToTrack(&m_guid);
 	if (!tr)
@@ -329,7 +444,7 @@ bool TrackSnapshot::UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantC
 			memset(bMatched, 0, sizeof(bool) * numFX);
 			for (int i = 0; i < m_fx.GetSize(); i++)
 			{
-				int match = m_fx.Get(i)->UpdateReaper(tr, bMatched, numFX);
+				int match = m_fx.Get(i)->UpdateReaper(tr, bMatched, numFX, fxParamsSet);
 				if (match >= 0)
 					bMatched[match] = true;
 				else
@@ -401,6 +516,42 @@ void TrackSnapshot::GetChunk(WDL_FastString* chunk)
 	chunk->Append(">\n");
 }
 
+void TrackSnapshot::GetPayload(SnapshotPayloadWriter* w)
+{
+	w->AddBytes(&m_guid, sizeof(GUID));
+	w->AddDouble(m_dVol);
+	w->AddDouble(m_dPan);
+	w->AddInt(m_bMute ? 1 : 0);
+	w->AddInt(m_iSolo);
+	w->AddInt(m_iFXEn);
+	w->AddInt(m_iVis);
+	w->AddInt(m_iSel);
+	w->AddInt(m_iPanMode);
+	w->AddDouble(m_dPanWidth);
+	w->AddDouble(m_dPanL);
+	w->AddDouble(m_dPanR);
+	w->AddDouble(m_dPanLaw);
+	w->AddString(m_sName.Get());
+	w->AddInt(m_iTrackNum);
+
+	w->AddInt(m_fx.GetSize());
+	for (int i = 0; i < m_fx.GetSize(); i++)
+		m_fx.Get(i)->GetPayload(w);
+
+	WDL_FastString tail;
+	m_sends.GetChunk(&tail);
+	if (m_sFXChain.GetSize())
+		tail.Append(m_sFXChain.Get());
+	tail.Append(m_sVolEnv.Get());
+	tail.Append(m_sVolEnv2.Get());
+	tail.Append(m_sPanEnv.Get());
+	tail.Append(m_sPanEnv2.Get());
+	tail.Append(m_sWidthEnv.Get());
+	tail.Append(m_sWidthEnv2.Get());
+	tail.Append(m_sMuteEnv.Get());
+	w->AddString(tail.Get());
+}
+
 void TrackSnapshot::GetDetails(WDL_FastString* details, int iMask)
 {
 	MediaTrack* tr = GuidToTrack(&m_guid);
@@ -668,6 +819,10 @@ Snapshot::Snapshot(int slot, int mask, bool bSelOnly, const char* name, const ch
 	m_time = (int)time(NULL);
 	m_cName = NULL;
 	m_cNotes = NULL;
+	m_iFXParamsSet = 0;
+	m_bDecoded = true;
+	m_iPayloadTracks = 0;
+	m_bPayloadMaster = false;
 	SetName(name);
 	SetNotes(notes);
 
@@ -689,13 +844,24 @@ Snapshot::Snapshot(int slot, int mask, bool bSelOnly, const char* name, const ch
 
 // Build a snapshot from an XML/RPP chunk from the clipboard/RPP/undo/etc
 Snapshot::Snapshot(const char* chunk)
+{
+	m_cName = NULL;
+	m_cNotes = NULL;
+	m_iFXParamsSet = 0;
+	m_bDecoded = true;
+	m_iPayloadTracks = 0;
+	m_bPayloadMaster = false;
+	ParseChunk(chunk, NULL);
+	RegisterGetCommand(m_iSlot);
+}
+
+// Parses both the text format and the PAYLOAD lines (binary track data, see GetChunk())
+// ts is non-NULL when parsing the text tail of a decoded payload track
+void Snapshot::ParseChunk(const char* chunk, TrackSnapshot* ts)
 {
 	char line[4096];
 	int pos = 0;
 	LineParser lp(false);
-	TrackSnapshot* ts = NULL;
-	m_cName = NULL;
-	m_cNotes = NULL;
 
 	int auxEnvsOccurence = -1;
 
@@ -737,6 +903,26 @@ Snapshot::Snapshot(const char* chunk)
 			else
 				SetNotes("");
 		}
+		else if (strcmp("PAYLOAD", lp.gettoken_str(0)) == 0)
+		{	// The encoded data runs up to the end of the snapshot, just keep it until needed
+			m_iPayloadTracks = lp.gettoken_int(1);
+			m_bPayloadMaster = lp.gettoken_int(2) ? true : false;
+			WDL_FastString encoded;
+			while(GetChunkLine(chunk, line, 4096, &pos, false))
+			{
+				if (lp.parse(line) || lp.gettoken_str(0)[0] == '>')
+					break;
+				encoded.Append(lp.gettoken_str(0));
+			}
+			Base64 b64;
+			int iLen;
+			const char* pData = b64.Decode(encoded.Get(), &iLen);
+			if (pData && iLen > 0 && m_payload.Resize(iLen, false))
+			{
+				memcpy(m_payload.Get(), pData, iLen);
+				m_bDecoded = false;
+			}
+		}
 		else if (strcmp("TRACK", lp.gettoken_str(0)) == 0 || strcmp("<TRACK", lp.gettoken_str(0)) == 0)
 		{
 			ts = m_tracks.Add(new TrackSnapshot(&lp));
@@ -819,34 +1005,164 @@ Snapshot::Snapshot(const char* chunk)
 			else if (ts->ProcessEnv(chunk, line, 4096, &pos, "<MUTEENV", &ts->m_sMuteEnv)) {}
 		}
 	}
-	RegisterGetCommand(m_iSlot);
+}
+
+// Container header + track data, compressed when it's worth it
+#define SSPAYLOAD_HEADER 10
+
+void Snapshot::EncodePayload(WDL_HeapBuf* payload)
+{
+	SnapshotPayloadWriter w;
+	w.AddInt(m_tracks.GetSize());
+	for (int i = 0; i < m_tracks.GetSize(); i++)
+		m_tracks.Get(i)->GetPayload(&w);
+
+	int iRawLen = w.m_buf.GetSize();
+	uLongf iDataLen = compressBound(iRawLen);
+	unsigned char* p = (unsigned char*)payload->Resize(SSPAYLOAD_HEADER + max((int)iDataLen, iRawLen), false);
+	if (!p)
+	{
+		payload->Resize(0, false);
+		return;
+	}
+	memcpy(p, "SWSS", 4);
+	p[4] = SNAPSHOT_PAYLOAD_VERSION;
+	p[5] = SSPAYLOAD_ZLIB;
+	memcpy(p + 6, &iRawLen, 4);
+	if (compress2(p + SSPAYLOAD_HEADER, &iDataLen, w.m_buf.Get(), iRawLen, Z_DEFAULT_COMPRESSION) != Z_OK || (int)iDataLen >= iRawLen)
+	{	// Store as is
+		p[5] = 0;
+		memcpy(p + SSPAYLOAD_HEADER, w.m_buf.Get(), iRawLen);
+		iDataLen = iRawLen;
+	}
+	payload->Resize(SSPAYLOAD_HEADER + (int)iDataLen, false);
+}
+
+// Returns false if the payload is unusable (corrupt or from a newer version)
+bool Snapshot::DecodePayload()
+{
+	const unsigned char* p = (const unsigned char*)m_payload.Get();
+	int iLen = m_payload.GetSize();
+	if (iLen < SSPAYLOAD_HEADER || memcmp(p, "SWSS", 4) || p[4] > SNAPSHOT_PAYLOAD_VERSION)
+		return false;
+
+	int iRawLen;
+	memcpy(&iRawLen, p + 6, 4);
+	if (iRawLen < 0)
+		return false;
+
+	WDL_HeapBuf raw;
+	const unsigned char* pRaw = p + SSPAYLOAD_HEADER;
+	if (p[5] & SSPAYLOAD_ZLIB)
+	{
+		uLongf iDestLen = iRawLen;
+		if (!raw.Resize(iRawLen, false) ||
+			uncompress((Bytef*)raw.Get(), &iDestLen, pRaw, iLen - SSPAYLOAD_HEADER) != Z_OK || (int)iDestLen != iRawLen)
+			return false;
+		pRaw = (const unsigned char*)raw.Get();
+	}
+	else if (iRawLen != iLen - SSPAYLOAD_HEADER)
+		return false;
+
+	SnapshotPayloadReader r(pRaw, iRawLen);
+	int iNumTracks = r.GetInt();
+	WDL_FastString tail;
+	for (int i = 0; i < iNumTracks && !r.Error(); i++)
+	{
+		TrackSnapshot* ts = new TrackSnapshot(&r, &tail);
+		if (r.Error())
+		{
+			delete ts;
+			break;
+		}
+		m_tracks.Add(ts);
+		if (tail.GetLength())
+			ParseChunk(tail.Get(), ts);
+	}
+	return !r.Error();
+}
+
+WDL_PtrList<TrackSnapshot>* Snapshot::GetTracks()
+{
+	if (!m_bDecoded)
+	{
+		m_bDecoded = true; // Even on failure, the snapshot then just has no (or less) tracks
+		DecodePayload();
+		m_payload.Resize(0, false);
+	}
+	return &m_tracks;
+}
+
+// Pending staged recall, see Snapshot::UpdateReaper()
+class SnapshotStagedRecall
+{
+public:
+	SnapshotStagedRecall(Snapshot* ss, int mask, bool bSelOnly)
+	:m_ss(ss),m_proj(EnumProjects(-1, NULL, 0)),m_iMask(mask),m_bSelOnly(bSelOnly),m_iTrack(0),m_iTrackErr(0),m_iFXErr(0),m_dTimePerTrack(0.0) {}
+	~SnapshotStagedRecall() { m_sendFixes.Empty(true); }
+
+	Snapshot* m_ss;
+	ReaProject* m_proj;
+	int m_iMask;
+	bool m_bSelOnly;
+	int m_iTrack;
+	int m_iTrackErr;
+	int m_iFXErr;
+	double m_dTimePerTrack; // measured, including the chunk writes
+	WDL_PtrList<TrackSendFix> m_sendFixes;
+};
+
+static SnapshotStagedRecall* g_pStagedRecall = NULL;
+static bool g_bInStagedRecall = false;
+
+static bool IsOpenProject(ReaProject* proj)
+{
+	int i = 0;
+	while (ReaProject* p = EnumProjects(i++, NULL, 0))
+		if (p == proj)
+			return true;
+	return false;
 }
 
 Snapshot::~Snapshot()
 {
+	if (g_pStagedRecall && g_pStagedRecall->m_ss == this)
+		CancelStagedRecall();
 	delete [] m_cName;
 	delete [] m_cNotes;
 	m_tracks.Empty(true);
 }
 
-bool Snapshot::UpdateReaper(int mask, bool bSelOnly, bool bHideNewVis)
+// bStaged: mixer properties are set right away, FX chains and sends are then applied
+// from the timer (see StagedRecallSlice()), a few tracks at a time
+bool Snapshot::UpdateReaper(int mask, bool bSelOnly, bool bHideNewVis, bool bStaged)
 {
-	char str[256];
+	GetTracks();
+	CancelStagedRecall();
+
 	int trackErr = 0, fxErr = 0;
 	WDL_PtrList<TrackSendFix> sendFixes;
+	m_iFXParamsSet = 0;
+	bStaged = bStaged && m_tracks.GetSize() && (mask & m_iMask & (FXCHAIN_MASK | SENDS_MASK));
 
 	PreventUIRefresh(1);
 
 	// Do "non-chunk" stuff first
 	for (int i = 0; i < m_tracks.GetSize(); i++)
-		m_tracks.Get(i)->UpdateReaper(mask & m_iMask, bSelOnly, &fxErr, false, &sendFixes);
+		m_tracks.Get(i)->UpdateReaper(mask & m_iMask, bSelOnly, &fxErr, &m_iFXParamsSet, false, &sendFixes);
 
 	// Then cache all ObjectState changes for the chunk updating
-	SWS_CacheObjectState(true);
-	for (int i = 0; i < m_tracks.GetSize(); i++)
-		if (m_tracks.Get(i)->UpdateReaper(mask & m_iMask, bSelOnly, &fxErr, true, &sendFixes))
-			trackErr++;
-	SWS_CacheObjectState(false);
+	if (bStaged)
+		g_pStagedRecall = new SnapshotStagedRecall(this, mask & m_iMask & (FXCHAIN_MASK | SENDS_MASK), bSelOnly);
+	else
+	{
+		SWS_CacheObjectState(true);
+		for (int i = 0; i < m_tracks.GetSize(); i++)
+			if (m_tracks.Get(i)->UpdateReaper(mask & m_iMask, bSelOnly, &fxErr, &m_iFXParamsSet, true, &sendFixes))
+				trackErr++;
+		SWS_CacheObjectState(false);
+	}
+	sendFixes.Empty(true);
 
 	if (mask & m_iMask & VIS_MASK)
 	{
@@ -876,8 +1192,20 @@ bool Snapshot::UpdateReaper(int mask, bool bSelOnly, bool bHideNewVis)
 
 	PreventUIRefresh(-1);
 
-	sprintf(str, __LOCALIZE_VERFMT("Load snapshot %s","sws_undo"), m_cName);
-	Undo_OnStateChangeEx(str, UNDO_STATE_ALL, -1);
+	if (bStaged)
+	{
+		if (g_pStagedRecall)
+			g_pStagedRecall->m_iFXErr = fxErr;
+		UpdateSnapshotsDialog();
+		return false;
+	}
+	return OnRecallDone(trackErr, fxErr);
+}
+
+// Undo point and error reporting, returns true if tracks were removed from the snapshot
+bool Snapshot::OnRecallDone(int trackErr, int fxErr)
+{
+	AddRecallUndoPoint(NULL, false);
 
 	if (trackErr || fxErr)
 	{
@@ -902,19 +1230,119 @@ bool Snapshot::UpdateReaper(int mask, bool bSelOnly, bool bHideNewVis)
 	return false;
 }
 
+// bCancelled: staged recall stopped midway, what was applied so far stays (mixer properties and the first tracks)
+void Snapshot::AddRecallUndoPoint(ReaProject* proj, bool bCancelled)
+{
+	char str[256];
+	sprintf(str, __LOCALIZE_VERFMT("Load snapshot %s","sws_undo"), m_cName);
+	if (m_iFXParamsSet)
+	{
+		int n = (int)strlen(str);
+		_snprintf(str + n, sizeof(str) - n, __LOCALIZE_VERFMT(" (%d FX parameter(s) changed)","sws_undo"), m_iFXParamsSet);
+		str[sizeof(str) - 1] = 0;
+	}
+	if (bCancelled)
+	{
+		int n = (int)strlen(str);
+		_snprintf(str + n, sizeof(str) - n, "%s", __LOCALIZE(" (cancelled)","sws_undo"));
+		str[sizeof(str) - 1] = 0;
+	}
+	Undo_OnStateChangeEx2(proj, str, UNDO_STATE_ALL, -1);
+}
+
+void Snapshot::StagedRecallSlice()
+{
+	SnapshotStagedRecall* r = g_pStagedRecall;
+	if (!r || g_bInStagedRecall) // re-entrance, e.g. missing send dialog box
+		return;
+
+	if (r->m_proj != EnumProjects(-1, NULL, 0)) // project tab switch
+	{
+		CancelStagedRecall();
+		return;
+	}
+
+	Snapshot* ss = r->m_ss;
+
+	// Snapshot tracks can get deleted meanwhile (snapshots window), nothing left means done
+	int nbLeft = ss->m_tracks.GetSize() - r->m_iTrack;
+	if (nbLeft > 0)
+	{
+		g_bInStagedRecall = true;
+
+		// Number of tracks that fit in the slice, based on the previous ones
+		int nbTracks = r->m_dTimePerTrack > 0.0 ? (int)(STAGED_RECALL_SLICE / r->m_dTimePerTrack) : 1;
+		nbTracks = BOUNDED(nbTracks, 1, nbLeft);
+
+		int nbDone = 0;
+		double dStart = time_precise();
+		PreventUIRefresh(1);
+		SWS_CacheObjectState(true);
+		for (; nbDone < nbTracks && g_pStagedRecall == r && r->m_iTrack < ss->m_tracks.GetSize(); nbDone++)
+			if (ss->m_tracks.Get(r->m_iTrack++)->UpdateReaper(r->m_iMask, r->m_bSelOnly, &r->m_iFXErr, &ss->m_iFXParamsSet, true, &r->m_sendFixes))
+				r->m_iTrackErr++;
+		SWS_CacheObjectState(false);
+		PreventUIRefresh(-1);
+		if (nbDone)
+			r->m_dTimePerTrack = (time_precise() - dStart) / nbDone;
+
+		g_bInStagedRecall = false;
+	}
+
+	if (g_pStagedRecall != r) // cancelled meanwhile
+		delete r;
+	else if (r->m_iTrack >= ss->m_tracks.GetSize())
+	{
+		int trackErr = r->m_iTrackErr, fxErr = r->m_iFXErr;
+		g_pStagedRecall = NULL;
+		delete r;
+		ss->OnRecallDone(trackErr, fxErr);
+	}
+	UpdateSnapshotsDialog();
+}
+
+void Snapshot::CancelStagedRecall()
+{
+	if (g_pStagedRecall)
+	{
+		SnapshotStagedRecall* r = g_pStagedRecall;
+		g_pStagedRecall = NULL;
+
+		// Mixer properties and the tracks done so far stay applied, make them undoable
+		if (IsOpenProject(r->m_proj))
+			r->m_ss->AddRecallUndoPoint(r->m_proj, true);
+
+		if (!g_bInStagedRecall) // else deleted at the end of the slice
+			delete r;
+		UpdateSnapshotsDialog();
+	}
+}
+
+int Snapshot::GetStagedRecallProgress(Snapshot* ss)
+{
+	if (!g_pStagedRecall || g_pStagedRecall->m_ss != ss || !ss->m_tracks.GetSize())
+		return -1;
+	return (100 * g_pStagedRecall->m_iTrack) / ss->m_tracks.GetSize();
+}
+
 char* Snapshot::Tooltip(char* str, int maxLen)
 {
 	int n = 0;
-	// Look to see if the master track is included in the snapshot
-	int i;
-	for (i = 0; i < m_tracks.GetSize(); i++)
-		if (GuidsEqual(&m_tracks.Get(i)->m_guid, &GUID_NULL))
-			break;
+	// Look to see if the master track is included in the snapshot (no need to decode the payload for that)
+	int iTracks = m_iPayloadTracks;
+	bool bMaster = m_bPayloadMaster;
+	if (m_bDecoded)
+	{
+		iTracks = m_tracks.GetSize();
+		bMaster = false;
+		for (int i = 0; !bMaster && i < iTracks; i++)
+			bMaster = GuidsEqual(&m_tracks.Get(i)->m_guid, &GUID_NULL);
+	}
 
-	if (i < m_tracks.GetSize())
-		n = _snprintf(str, maxLen, __LOCALIZE_VERFMT("Master + %d track(s)","sws_DLG_101"), m_tracks.GetSize() - 1);
+	if (bMaster)
+		n = _snprintf(str, maxLen, __LOCALIZE_VERFMT("Master + %d track(s)","sws_DLG_101"), iTracks - 1);
 	else
-		n = _snprintf(str + n, maxLen - n, __LOCALIZE_VERFMT("%d track(s)","sws_DLG_101"), m_tracks.GetSize());
+		n = _snprintf(str + n, maxLen - n, __LOCALIZE_VERFMT("%d track(s)","sws_DLG_101"), iTracks);
 
 	if (m_iMask & VOL_MASK && n < maxLen) {
 		n += _snprintf(str + n, maxLen - n, "%s", ", ");
@@ -995,6 +1423,7 @@ void Snapshot::SetNotes(const char* notes)
 
 void Snapshot::AddSelTracks()
 {
+	GetTracks();
 	for (int i = 0; i <= GetNumTracks(); i++)
 	{
 		MediaTrack* tr = CSurf_TrackFromID(i, false);
@@ -1006,6 +1435,7 @@ void Snapshot::AddSelTracks()
 
 void Snapshot::DelSelTracks()
 {
+	GetTracks();
 	for (int i = 0; i < m_tracks.GetSize(); i++)
 	{
 		MediaTrack* tr = GuidToTrack(&m_tracks.Get(i)->m_guid);
@@ -1019,6 +1449,7 @@ void Snapshot::DelSelTracks()
 
 void Snapshot::SelectTracks()
 {
+	GetTracks();
 	int iSel = 1;
 	ClearSelected();
 	for (int i = 0; i < m_tracks.GetSize(); i++)
@@ -1031,6 +1462,7 @@ void Snapshot::SelectTracks()
 
 int Snapshot::Find(MediaTrack* tr)
 {
+	GetTracks();
 	for (int i = 0; i < m_tracks.GetSize(); i++)
 		if (tr == GuidToTrack(&m_tracks.Get(i)->m_guid))
 			return i;
@@ -1087,12 +1519,41 @@ char* Snapshot::GetTimeString(char* str, int iStrMax, bool bDate)
 }
 
 // Get chunk for writing out
-void Snapshot::GetChunk(WDL_FastString* chunk)
+// bCompact: track data as an encoded PAYLOAD (project/undo states), otherwise the text format (clipboard/export)
+void Snapshot::GetChunk(WDL_FastString* chunk, bool bCompact)
 {
 	WDL_FastString notes;
 	makeEscapedConfigString(m_cNotes, &notes);
 	chunk->SetFormatted(SNM_MAX_CHUNK_LINE_LENGTH, "<SWSSNAPSHOT \"%s\" %d %d %d %s\n", m_cName, m_iSlot, m_iMask, m_time, notes.Get());
-	for (int i = 0; i < m_tracks.GetSize(); i++)
+	if (bCompact)
+	{
+		// Not decoded yet: nothing changed since load, write it back as is
+		WDL_HeapBuf payload;
+		if (m_bDecoded)
+		{
+			EncodePayload(&payload);
+			m_iPayloadTracks = m_tracks.GetSize();
+			m_bPayloadMaster = false;
+			for (int i = 0; !m_bPayloadMaster && i < m_tracks.GetSize(); i++)
+				m_bPayloadMaster = GuidsEqual(&m_tracks.Get(i)->m_guid, &GUID_NULL);
+		}
+		WDL_HeapBuf* pPayload = m_bDecoded ? &payload : &m_payload;
+
+		if (pPayload->GetSize())
+		{
+			chunk->AppendFormatted(64, "PAYLOAD %d %d\n", m_iPayloadTracks, m_bPayloadMaster ? 1 : 0);
+			Base64 b64;
+			const char* encoded = b64.Encode((const char*)pPayload->Get(), pPayload->GetSize());
+			for (int iLen = (int)strlen(encoded); iLen > 0; iLen -= PAYLOAD_CHARS_PER_LINE, encoded += PAYLOAD_CHARS_PER_LINE)
+			{
+				chunk->Append(encoded, min(iLen, PAYLOAD_CHARS_PER_LINE));
+				chunk->Append("\n");
+			}
+			chunk->Append(">\n");
+			return;
+		}
+	}
+	for (int i = 0; i < GetTracks()->GetSize(); i++)
 		m_tracks.Get(i)->GetChunk(chunk);
 	chunk->Append(">\n");
 }
@@ -1100,6 +1561,7 @@ void Snapshot::GetChunk(WDL_FastString* chunk)
 // Get a human-readable string that explains the snapshot
 void Snapshot::GetDetails(WDL_FastString* details)
 {
+	GetTracks();
 	char cTemp[100];
 	details->AppendFormatted(100, __LOCALIZE_VERFMT("Snapshot %d \"%s\", stored","sws_DLG_101"), m_iSlot, m_cName);
 	details->Append(" ");
@@ -1125,6 +1587,7 @@ void Snapshot::GetDetails(WDL_FastString* details)
 
 bool Snapshot::IncludesSelTracks()
 {
+	GetTracks();
 	for (int i = 0; i < m_tracks.GetSize(); i++)
 	{
 		MediaTrack* tr = GuidToTrack(&m_tracks.Get(i)->m_guid);
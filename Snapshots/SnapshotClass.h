@@ -28,6 +28,39 @@
 #pragma once
 
 #define DOUBLES_PER_LINE 8
+#define PAYLOAD_CHARS_PER_LINE 128
+#define SNAPSHOT_PAYLOAD_VERSION 1
+#define STAGED_RECALL_SLICE 0.015 // max time (in seconds) spent applying FX chains/sends per timer tick
+#define FX_PARAM_TOLERANCE 1e-7 // relative to the param range
+
+// Compact project storage of the track data, see Snapshot::GetChunk()
+// Container: "SWSS" magic, version byte, flags byte (SSPAYLOAD_ZLIB), raw length (4 bytes), data
+#define SSPAYLOAD_ZLIB	0x01
+
+class SnapshotPayloadWriter
+{
+public:
+	void AddBytes(const void* p, int iLen);
+	void AddInt(int i)			{ AddBytes(&i, sizeof(int)); }
+	void AddDouble(double d)	{ AddBytes(&d, sizeof(double)); }
+	void AddString(const char* str);
+	WDL_TypedBuf<unsigned char> m_buf;
+};
+
+class SnapshotPayloadReader
+{
+public:
+	SnapshotPayloadReader(const unsigned char* p, int iLen):m_p(p),m_iLen(iLen),m_iPos(0),m_bErr(false) {}
+	bool GetBytes(void* p, int iLen);
+	int GetInt()				{ int i = 0; GetBytes(&i, sizeof(int)); return i; }
+	double GetDouble()			{ double d = 0.0; GetBytes(&d, sizeof(double)); return d; }
+	const char* GetString(WDL_FastString* str);
+	bool Error()				{ return m_bErr; }
+private:
+	const unsigned char* m_p;
+	int m_iLen, m_iPos;
+	bool m_bErr;
+};
 
 class FXSnapshot
 {
@@ -35,13 +68,16 @@ public:
     FXSnapshot(MediaTrack* tr, int fx);
 	FXSnapshot(FXSnapshot& fx);
     FXSnapshot(LineParser* lp);
+    FXSnapshot(SnapshotPayloadReader* r);
     ~FXSnapshot();
 
 	void GetChunk(WDL_FastString* chunk);
+	void GetPayload(SnapshotPayloadWriter* w);
     void RestoreParams(const char* str);
-    int UpdateReaper(MediaTrack* tr, bool* bMatched, int num);
+    int UpdateReaper(MediaTrack* tr, bool* bMatched, int num, int* iParamsSet);
 	bool Exists(MediaTrack* tr);
 
+	GUID m_guid; // GUID_NULL for snapshots saved before FX GUIDs were stored
     double* m_dParams;
     int m_iNumParams;
 	int m_iCurParam;
@@ -55,11 +91,13 @@ public:
     TrackSnapshot(MediaTrack* tr, int mask);
 	TrackSnapshot(TrackSnapshot& ts);
     TrackSnapshot(LineParser* lp);
+    TrackSnapshot(SnapshotPayloadReader* r, WDL_FastString* tail);
     ~TrackSnapshot();
 
-	bool UpdateReaper(int mask, bool bSelOnly, int* fxErr, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix);
+	bool UpdateReaper(int mask, bool bSelOnly, int* fxErr, int* fxParamsSet, bool wantChunk, WDL_PtrList<TrackSendFix>* pFix);
 	bool Cleanup();
 	void GetChunk(WDL_FastString* chunk);
+	void GetPayload(SnapshotPayloadWriter* w);
 	void GetDetails(WDL_FastString* details, int iMask);
 
 	static void GetSetEnvelope(MediaTrack* tr, WDL_FastString* str, const char* env, bool bSet);
@@ -121,7 +159,7 @@ public:
     Snapshot(int slot, int mask, bool bSelOnly, const char* name, const char* desc);   // For capture
 	Snapshot(const char* chunk); // For project load
     ~Snapshot();
-    bool UpdateReaper(int mask, bool bSelOnly, bool bHideNewVis);
+    bool UpdateReaper(int mask, bool bSelOnly, bool bHideNewVis, bool bStaged = false);
     char* Tooltip(char* str, int maxLen);
     void SetName(const char* name);
     void SetNotes(const char* notes);
@@ -131,16 +169,35 @@ public:
 	int Find(MediaTrack* tr);
 	static void RegisterGetCommand(int iSlot);
 	char* GetTimeString(char* str, int iStrMax, bool bDate);
-	void GetChunk(WDL_FastString* chunk);
+	void GetChunk(WDL_FastString* chunk, bool bCompact = false);
 	void GetDetails(WDL_FastString* details);
 	bool IncludesSelTracks();
+	WDL_PtrList<TrackSnapshot>* GetTracks(); // Decodes the payload if needed
+
+	// Staged recall: only one at a time, a new recall cancels the pending one
+	static void StagedRecallSlice();
+	static void CancelStagedRecall();
+	static int GetStagedRecallProgress(Snapshot* ss); // percentage, -1 if ss is not being recalled
 
 // TODO these should be private
 	char* m_cName;
 	char* m_cNotes;
+	int m_iFXParamsSet; // number of FX params changed by the last recall, reported in its undo point
     int m_iSlot;
     int m_iMask;
 	int m_time;
-    
+
+private:
+	void ParseChunk(const char* chunk, TrackSnapshot* ts);
+	bool OnRecallDone(int trackErr, int fxErr);
+	void AddRecallUndoPoint(ReaProject* proj, bool bCancelled);
+	void EncodePayload(WDL_HeapBuf* payload);
+	bool DecodePayload();
+
     WDL_PtrList<TrackSnapshot> m_tracks;
+	// Project loads keep the encoded track data until the snapshot is actually used
+	WDL_HeapBuf m_payload;
+	bool m_bDecoded;
+	int m_iPayloadTracks;
+	bool m_bPayloadMaster;
 };
\ No newline at end of file
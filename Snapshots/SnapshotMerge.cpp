@@ -190,9 +190,9 @@ INT_PTR WINAPI mergeWndProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 					AddToMenu(contextMenu, __LOCALIZE("Select source track","sws_DLG_112"), 0, -1, false, MF_GRAYED);
 
 					char menuText[80];
-					for (int i = 0; i < g_ss->m_tracks.GetSize(); i++)
+					for (int i = 0; i < g_ss->GetTracks()->GetSize(); i++)
 					{
-						TrackSnapshot* ts = g_ss->m_tracks.Get(i);
+						TrackSnapshot* ts = g_ss->GetTracks()->Get(i);
 						if (GuidsEqual(&ts->m_guid, &GUID_NULL))
 							strcpy(menuText, __LOCALIZE("(master)","sws_DLG_112"));
 						else if (ts->m_sName.GetLength())
@@ -236,7 +236,7 @@ INT_PTR WINAPI mergeWndProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 							if (mv->IsSelected(i))
 							{
 								mi = (SWS_SSMergeItem*)mv->GetListItem(i);
-								mi->m_ts = g_ss->m_tracks.Get(iCmd-1);
+								mi->m_ts = g_ss->GetTracks()->Get(iCmd-1);
 							}
 					}
 					else // iCol == 1
@@ -274,9 +274,9 @@ INT_PTR WINAPI mergeWndProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 				{
 					// Add a line, using same as 1) first sel, 2) matching index in snapshot 3) last in list
 					SWS_SSMergeItem* item = (SWS_SSMergeItem*)mv->EnumSelected(NULL);
-					if (!item && g_mergeItems.GetSize() < g_ss->m_tracks.GetSize())
+					if (!item && g_mergeItems.GetSize() < g_ss->GetTracks()->GetSize())
 					{
-						item = g_mergeItems.Add(new SWS_SSMergeItem(g_ss->m_tracks.Get(g_mergeItems.GetSize()), NULL));
+						item = g_mergeItems.Add(new SWS_SSMergeItem(g_ss->GetTracks()->Get(g_mergeItems.GetSize()), NULL));
 						item->m_destTr = GuidToTrack(&item->m_ts->m_guid);
 					}
 					else
@@ -328,9 +328,9 @@ INT_PTR WINAPI mergeWndProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 					// Update the snapshot and "recall it"
 					// 1) Save the existing snapshot's tracks
 					WDL_PtrList<TrackSnapshot> oldTrackSS;
-					for (int i = 0; i < g_ss->m_tracks.GetSize(); i++)
-						oldTrackSS.Add(g_ss->m_tracks.Get(i));
-					g_ss->m_tracks.Empty();
+					for (int i = 0; i < g_ss->GetTracks()->GetSize(); i++)
+						oldTrackSS.Add(g_ss->GetTracks()->Get(i));
+					g_ss->GetTracks()->Empty();
 
 					// 2) Create new TrackSnapshot tracks from the user's selections
 					for (int i = 0; i < g_mergeItems.GetSize(); i++)
@@ -345,7 +345,7 @@ INT_PTR WINAPI mergeWndProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 								GetSetMediaTrackInfo(g_mergeItems.Get(i)->m_destTr, "P_NAME", (void*)g_mergeItems.Get(i)->m_ts->m_sName.Get());
 							}
 
-							TrackSnapshot* ts = g_ss->m_tracks.Add(new TrackSnapshot(*g_mergeItems.Get(i)->m_ts));
+							TrackSnapshot* ts = g_ss->GetTracks()->Add(new TrackSnapshot(*g_mergeItems.Get(i)->m_ts));
 							if (CSurf_TrackToID(g_mergeItems.Get(i)->m_destTr, false) == 0)
 								ts->m_guid = GUID_NULL;
 							else
@@ -354,9 +354,9 @@ INT_PTR WINAPI mergeWndProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 					}
 
 					// Now go through and try to auto-resolve any send-track issues 
-					for (int i = 0; i < g_ss->m_tracks.GetSize(); i++)
+					for (int i = 0; i < g_ss->GetTracks()->GetSize(); i++)
 					{
-						WDL_PtrList<TrackSend>* pSends = &g_ss->m_tracks.Get(i)->m_sends.m_sends;
+						WDL_PtrList<TrackSend>* pSends = &g_ss->GetTracks()->Get(i)->m_sends.m_sends;
 						for (int j = 0; j < pSends->GetSize(); j++)
 							if (!GuidToTrack(pSends->Get(j)->GetGuid()))
 							{	// Perhaps the recv was in the snapshot and the user matched it with a different track?
@@ -394,9 +394,9 @@ INT_PTR WINAPI mergeWndProc(HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPara
 					// Restore snapshot's tracks if we're not saving, else delete the old
 					if (IsDlgButtonChecked(hwndDlg, IDC_SAVE) != BST_CHECKED)
 					{
-						g_ss->m_tracks.Empty(true);
+						g_ss->GetTracks()->Empty(true);
 						for (int i = 0; i < oldTrackSS.GetSize(); i++)
-							g_ss->m_tracks.Add(oldTrackSS.Get(i));
+							g_ss->GetTracks()->Add(oldTrackSS.Get(i));
 					}
 					else
 						oldTrackSS.Empty(true);
@@ -438,22 +438,22 @@ bool MergeSnapshots(Snapshot* ss)
 {
 	g_ss = ss;
 
-	if (!ss || !ss->m_tracks.GetSize())
+	if (!ss || !ss->GetTracks()->GetSize())
 		return false;
 
 	g_iMask = ss->m_iMask;
 
 	// If the paste is occuring with matching selected tracks, use those
-	if (ss->m_tracks.GetSize() == CountSelectedTracks(NULL))
+	if (ss->GetTracks()->GetSize() == CountSelectedTracks(NULL))
 	{
-		for (int i = 0; i < ss->m_tracks.GetSize(); i++)
-			g_mergeItems.Add(new SWS_SSMergeItem(ss->m_tracks.Get(i), GetSelectedTrack(NULL, i)));
+		for (int i = 0; i < ss->GetTracks()->GetSize(); i++)
+			g_mergeItems.Add(new SWS_SSMergeItem(ss->GetTracks()->Get(i), GetSelectedTrack(NULL, i)));
 	}
 	// If there's no tracks, by default set to "create"
 	else if (GetNumTracks() == 0)
 	{
-		for (int i = 0; i < ss->m_tracks.GetSize(); i++)
-			g_mergeItems.Add(new SWS_SSMergeItem(ss->m_tracks.Get(i), CREATETRACK));
+		for (int i = 0; i < ss->GetTracks()->GetSize(); i++)
+			g_mergeItems.Add(new SWS_SSMergeItem(ss->GetTracks()->Get(i), CREATETRACK));
 	}
 	else
 	{	// Next try matching with GUIDS
@@ -462,9 +462,9 @@ bool MergeSnapshots(Snapshot* ss)
 			projTracks.Add(CSurf_TrackFromID(i, false));
 
 		// First try to "match" with the GUID  (and fill g_mergeItems)
-		for (int i = 0; i < ss->m_tracks.GetSize(); i++)
+		for (int i = 0; i < ss->GetTracks()->GetSize(); i++)
 		{
-			SWS_SSMergeItem* mi = g_mergeItems.Add(new SWS_SSMergeItem(ss->m_tracks.Get(i), NULL));
+			SWS_SSMergeItem* mi = g_mergeItems.Add(new SWS_SSMergeItem(ss->GetTracks()->Get(i), NULL));
 			// check for master first
 			if (GuidsEqual(&mi->m_ts->m_guid, &GUID_NULL))
 				mi->m_destTr = CSurf_TrackFromID(0, false);
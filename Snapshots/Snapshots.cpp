@@ -69,6 +69,7 @@ public:
 static SWSProjConfig<ProjSnapshot> g_ss;
 SWS_SnapshotsWnd* g_pSSWnd=NULL;
 void PasteSnapshot(COMMAND_T*);
+void ToggleStagedRecall(COMMAND_T*);
 void MergeSnapshot(Snapshot* ss);
 void DeleteSnapshot(Snapshot* ss);
 void DeleteAllSnapshots(COMMAND_T* = NULL);
@@ -81,6 +82,7 @@ static int g_iSavedType;
 static bool g_bApplyFilterOnRecall = true;
 static bool g_bHideNewOnRecall = true;
 static bool g_bPromptOnNew = false;
+static bool g_bStagedRecall = false;
 static bool g_bHideOptions = false;
 static bool g_bShowSelOnly = false;
 
@@ -123,7 +125,7 @@ Snapshot* GetSnapshotFromClipboard()
 			{
 				ss = new Snapshot(clipData);
 				GlobalUnlock(clipBoard);
-				if (!ss->m_tracks.GetSize())
+				if (!ss->GetTracks()->GetSize())
 				{
 					MessageBox(g_hwndParent, __LOCALIZE("Clipboard does not contain a valid snapshot.","sws_DLG_101"), __LOCALIZE("SWS Snapshot Paste Error","sws_DLG_101"), MB_OK);
 					delete ss;
@@ -185,7 +187,7 @@ void ImportSnapshot()
 			delete cfg;
 
 			Snapshot* ss = new Snapshot(chunk.Get());
-			if (!ss->m_tracks.GetSize())
+			if (!ss->GetTracks()->GetSize())
 			{
 				MessageBox(g_hwndParent, __LOCALIZE("File does not contain a valid snapshot.","sws_DLG_101"), __LOCALIZE("SWS Snapshot Import Error","sws_DLG_101"), MB_OK);
 				delete ss;
@@ -276,11 +278,16 @@ void SWS_SnapshotsView::GetItemText(SWS_ListItem* item, int iCol, char* str, int
 		_snprintf(str, iStrMax, "%d", ss->m_iSlot);
 		break;
 	case 1:
-		if (ss->m_cName)
+	{
+		int iProgress = Snapshot::GetStagedRecallProgress(ss);
+		if (iProgress >= 0)
+			_snprintf(str, iStrMax, __LOCALIZE_VERFMT("%s (recalling %d%%)","sws_DLG_101"), ss->m_cName ? ss->m_cName : "", iProgress);
+		else if (ss->m_cName)
 			lstrcpyn(str, ss->m_cName, iStrMax);
 		else
 			str[0] = 0;
 		break;
+	}
 	case 2:
 		ss->GetTimeString(str, iStrMax, true);
 		break;
@@ -316,7 +323,7 @@ void SWS_SnapshotsView::OnItemClk(SWS_ListItem* item, int iCol, int iKeyState)
 	if (!(iKeyState & LVKF_SHIFT) && !(iKeyState & LVKF_CONTROL) && !(iKeyState & LVKF_ALT))
 	{
 		g_ss.Get()->m_pCurSnapshot = ss;
-		if (ss->UpdateReaper(g_bApplyFilterOnRecall ? g_iMask : ALL_MASK, g_bSelOnly_OnRecall, g_bHideNewOnRecall))
+		if (ss->UpdateReaper(g_bApplyFilterOnRecall ? g_iMask : ALL_MASK, g_bSelOnly_OnRecall, g_bHideNewOnRecall, g_bStagedRecall))
 			Update();
 	}
 	// Save (ctrl click)
@@ -360,7 +367,7 @@ SWS_SnapshotsWnd::SWS_SnapshotsWnd()
 {
 	// Restore state
 	char str[32];
-	GetPrivateProfileString(SWS_INI, SNAP_OPTIONS_KEY, "559 0 0 0 1 0 0 0 0", str, 32, get_ini_file());
+	GetPrivateProfileString(SWS_INI, SNAP_OPTIONS_KEY, "559 0 0 0 1 0 0 0 0 0", str, 32, get_ini_file());
 	LineParser lp(false);
 	if (!lp.parse(str))
 	{
@@ -373,6 +380,7 @@ SWS_SnapshotsWnd::SWS_SnapshotsWnd()
 		m_iSelType = lp.gettoken_int(6);
 		g_bSelOnly_OnRecall = lp.gettoken_int(7) ? true : false;
 		g_bShowSelOnly = lp.gettoken_int(8) ? true : false;
+		g_bStagedRecall = lp.gettoken_int(9) ? true : false;
 	}
 	// Remove deprecated FXATM
 	if (g_iMask & FXATM_MASK)
@@ -491,7 +499,7 @@ void SWS_SnapshotsWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 			if (ss)
 			{
 				g_ss.Get()->m_pCurSnapshot = ss;
-				if (ss->UpdateReaper(g_bApplyFilterOnRecall ? g_iMask : ALL_MASK, g_bSelOnly_OnRecall, g_bHideNewOnRecall))
+				if (ss->UpdateReaper(g_bApplyFilterOnRecall ? g_iMask : ALL_MASK, g_bSelOnly_OnRecall, g_bHideNewOnRecall, g_bStagedRecall))
 					Update();
 			}
 			break;
@@ -512,7 +520,7 @@ void SWS_SnapshotsWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 			if (ss)
 			{
 				g_ss.Get()->m_pCurSnapshot = ss;
-				if (ss->UpdateReaper(g_bApplyFilterOnRecall ? g_iMask : ALL_MASK, g_bSelOnly_OnRecall, g_bHideNewOnRecall))
+				if (ss->UpdateReaper(g_bApplyFilterOnRecall ? g_iMask : ALL_MASK, g_bSelOnly_OnRecall, g_bHideNewOnRecall, g_bStagedRecall))
 					Update();
 			}
 			break;
@@ -523,7 +531,7 @@ void SWS_SnapshotsWnd::OnCommand(WPARAM wParam, LPARAM lParam)
 			if (ss)
 			{
 				g_ss.Get()->m_pCurSnapshot = ss;
-				if (ss->UpdateReaper(g_bApplyFilterOnRecall ? g_iMask : ALL_MASK, g_bSelOnly_OnRecall, g_bHideNewOnRecall))
+				if (ss->UpdateReaper(g_bApplyFilterOnRecall ? g_iMask : ALL_MASK, g_bSelOnly_OnRecall, g_bHideNewOnRecall, g_bStagedRecall))
 					Update();
 			}
 			break;
@@ -724,6 +732,8 @@ HMENU SWS_SnapshotsWnd::OnContextMenu(int x, int y, bool* wantDefaultItems)
 	AddToMenu(contextMenu, __LOCALIZE("New snapshot","sws_DLG_101"), SWSGetCommandID(NewSnapshot));
 	AddToMenu(contextMenu, __LOCALIZE("Paste snapshot","sws_DLG_101"), SWSGetCommandID(PasteSnapshot));
 	AddToMenu(contextMenu, __LOCALIZE("Delete all snapshots","sws_DLG_101"), SWSGetCommandID(DeleteAllSnapshots));
+	AddToMenu(contextMenu, SWS_SEPARATOR, 0);
+	AddToMenu(contextMenu, __LOCALIZE("Staged recall (FX chains/sends in the background)","sws_DLG_101"), SWSGetCommandID(ToggleStagedRecall), -1, false, g_bStagedRecall ? MFS_CHECKED : MFS_UNCHECKED);
 
 	return contextMenu;
 }
@@ -774,7 +784,7 @@ void SWS_SnapshotsWnd::OnDestroy()
 	char str[256];
 
 	// Save window state
-	sprintf(str, "%d %d %d %d %d %d %d %d %d",
+	sprintf(str, "%d %d %d %d %d %d %d %d %d %d",
 		g_iMask,
 		g_bApplyFilterOnRecall ? 1 : 0,
 		g_bHideOptions ? 1 : 0,
@@ -783,7 +793,8 @@ void SWS_SnapshotsWnd::OnDestroy()
 		g_bSelOnly_OnSave ? 1 : 0,
 		m_iSelType,
 		g_bSelOnly_OnRecall ? 1 : 0,
-		g_bShowSelOnly ? 1 : 0);
+		g_bShowSelOnly ? 1 : 0,
+		g_bStagedRecall ? 1 : 0);
 	WritePrivateProfileString(SWS_INI, SNAP_OPTIONS_KEY, str, get_ini_file());
 
 #ifdef _SNAP_TINY_BUTTONS
@@ -966,7 +977,7 @@ void GetSnapshot(int slot, int iMask, bool bSelOnly)
 		if (g_ss.Get()->m_snapshots.Get(i)->m_iSlot == slot)
 		{
 			g_ss.Get()->m_pCurSnapshot = g_ss.Get()->m_snapshots.Get(i);
-			if (g_ss.Get()->m_snapshots.Get(i)->UpdateReaper(iMask, bSelOnly, g_bHideNewOnRecall))
+			if (g_ss.Get()->m_snapshots.Get(i)->UpdateReaper(iMask, bSelOnly, g_bHideNewOnRecall, g_bStagedRecall))
 				g_pSSWnd->Update();
 			return;
 		}
@@ -1030,6 +1041,7 @@ void ToggleSelOnlySave(COMMAND_T*)	{ g_bSelOnly_OnSave = !g_bSelOnly_OnSave; Upd
 void ToggleSelOnlyRecall(COMMAND_T*){ g_bSelOnly_OnRecall = !g_bSelOnly_OnRecall; UpdateSnapshotsDialog(); }
 void ToggleShowForSelTracks(COMMAND_T*){ g_bShowSelOnly = !g_bShowSelOnly; UpdateSnapshotsDialog(); }
 void ToggleAppToRec(COMMAND_T*)	 { g_bApplyFilterOnRecall = !g_bApplyFilterOnRecall; UpdateSnapshotsDialog(); }
+void ToggleStagedRecall(COMMAND_T*) { g_bStagedRecall = !g_bStagedRecall; if (!g_bStagedRecall) Snapshot::CancelStagedRecall(); }
 void ClearFilter(COMMAND_T*)	 { g_pSSWnd->SetFilterType(2); g_iMask = 0; UpdateSnapshotsDialog(); }
 void SaveFilter(COMMAND_T*)		 { g_iSavedMask = g_iMask; g_iSavedType = g_pSSWnd->GetFilterType(); }
 void RestoreFilter(COMMAND_T*)	 { g_pSSWnd->SetFilterType(g_iSavedType); g_iMask = g_iSavedMask; UpdateSnapshotsDialog(); }
@@ -1046,6 +1058,8 @@ int IsSnapParamEn(COMMAND_T* ct)
 		return g_bShowSelOnly;
 	else if (ct->doCommand == ToggleAppToRec)
 		return g_bApplyFilterOnRecall;
+	else if (ct->doCommand == ToggleStagedRecall)
+		return g_bStagedRecall;
 	return false;
 }
 
@@ -1199,6 +1213,7 @@ static COMMAND_T g_commandTable[] =
 	{ { DEFACCEL, "SWS: Toggle snapshot selected only on recall" },			"SWSSNAPSHOT_SELONLYRECALL",ToggleSelOnlyRecall,	NULL, 0,			IsSnapParamEn },
 	{ { DEFACCEL, "SWS: Toggle snapshot apply filter to recall" },			"SWSSNAPSHOT_APPLYLOAD",	ToggleAppToRec,			NULL, 0,			IsSnapParamEn },
 	{ { DEFACCEL, "SWS: Toggle snapshot show only for selected tracks" },	"SWSSNAPSHOT_SHOWONLYSEL",	ToggleShowForSelTracks, NULL, 0,			IsSnapParamEn },
+	{ { DEFACCEL, "SWS: Toggle snapshot staged recall (FX chains/sends in the background)" },	"SWSSNAPSHOT_STAGEDRECALL",	ToggleStagedRecall, NULL, 0,	IsSnapParamEn },
 
 	{ { DEFACCEL, "SWS: Clear all snapshot filter options" },				"SWSSNAPSHOT_CLEARFILT", ClearFilter,    NULL, },
 	{ { DEFACCEL, "SWS: Save current snapshot filter options" },			"SWSSNAPSHOT_SAVEFILT",  SaveFilter,     NULL, },
@@ -1226,7 +1241,7 @@ static void SaveExtensionConfig(ProjectStateContext *ctx, bool isUndo, struct pr
 	for (int i = 0; i < g_ss.Get()->m_snapshots.GetSize(); i++)
 	{
 		Snapshot* ss = g_ss.Get()->m_snapshots.Get(i);
-		ss->GetChunk(&chunk);
+		ss->GetChunk(&chunk, true);
 		int iPos = 0;
 		while(GetChunkLine(chunk.Get(), line, 4096, &iPos, false))
 			ctx->AddLine("%s",line);
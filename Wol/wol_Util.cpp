@@ -71,6 +71,7 @@ void SetTrackHeight(MediaTrack* track, int height, bool useChunk)
 	if (!useChunk)
 	{
 		GetSetMediaTrackInfo(track, "I_HEIGHTOVERRIDE", &height);
+		BR_TcpLayout::Invalidate();
 
 		PreventUIRefresh(1);
 		Main_OnCommand(41327, 0);
@@ -87,6 +88,7 @@ void SetTrackHeight(MediaTrack* track, int height, bool useChunk)
 			_snprintfSafe(pTrackLine, BUFFER_SIZE, "%d", height);
 			p.ParsePatch(SNM_SET_CHUNK_CHAR, 1, "TRACK", "TRACKHEIGHT", 0, 1, pTrackLine);
 		}
+		BR_TcpLayout::Invalidate(); // chunk gets committed when p goes out of scope, layout is rebuilt on next use anyway
 	}
 }
 
@@ -29,6 +29,7 @@
 #include "../SnM/SnM_Dlg.h"
 #include "../reaper/localize.h"
 #include "Parameters.h"
+#include "../Breeder/BR_TcpLayout.h"
 
 using namespace std;
 
@@ -251,6 +252,7 @@ void DoSelTraxHeightA(COMMAND_T*)
 			GetSetMediaTrackInfo(CurTrack,"I_HEIGHTOVERRIDE",&g_command_params.TrackHeightA);
 	}
 	TrackList_AdjustWindows(false);
+	BR_TcpLayout::Invalidate();
 	UpdateTimeline();
 }
 
@@ -263,6 +265,7 @@ void DoSelTraxHeightB(COMMAND_T*)
 			GetSetMediaTrackInfo(CurTrack,"I_HEIGHTOVERRIDE",&g_command_params.TrackHeightB);
 	}
 	TrackList_AdjustWindows(false);
+	BR_TcpLayout::Invalidate();
 	UpdateTimeline();
 }
 
@@ -297,6 +300,7 @@ void DoRecallSelectedTrackHeights(COMMAND_T*)
 		}
 	}
 	TrackList_AdjustWindows(false);
+	BR_TcpLayout::Invalidate();
 	UpdateTimeline();
 }
 
@@ -714,6 +718,7 @@ void DoToggleTrackHeightAB(COMMAND_T*)
 		GetSetMediaTrackInfo(TheTracks[i],"I_HEIGHTOVERRIDE",&newHei);
 	}
 	TrackList_AdjustWindows(false);
+	BR_TcpLayout::Invalidate();
 	UpdateTimeline();
 }
 
@@ -130,6 +130,7 @@ void VertZoomRange(int iFirst, int iNum, bool* bZoomed, bool bMinimizeOthers, bo
 		for (int i = 0; i <= GetNumTracks(); i++)
 			GetSetMediaTrackInfo(CSurf_TrackFromID(i, false), "I_HEIGHTOVERRIDE", &g_i0);
 		Main_OnCommand(40112, 0); // Zoom out vert to minimize envelope lanes too (since vZoom is now 0) (calls refresh)
+		BR_TcpLayout::Invalidate();
 		//TrackList_AdjustWindows(false);
 		//UpdateTimeline();
 
@@ -206,6 +207,7 @@ void VertZoomRange(int iFirst, int iNum, bool* bZoomed, bool bMinimizeOthers, bo
 			}
 		}
 		TrackList_AdjustWindows(false);
+		BR_TcpLayout::Invalidate();
 		UpdateTimeline();
 	}
 	else
@@ -263,6 +265,7 @@ void VertZoomRange(int iFirst, int iNum, bool* bZoomed, bool bMinimizeOthers, bo
 			GetSetMediaTrackInfo(CSurf_TrackFromID(i, false), "I_HEIGHTOVERRIDE", &g_i0);
 		*(int*)GetConfigVar("vzoom2") = iZoom;
 		TrackList_AdjustWindows(false);
+		BR_TcpLayout::Invalidate();
 		UpdateTimeline();
 	}
 
@@ -551,6 +554,7 @@ public:
 			}
 
 			TrackList_AdjustWindows(false);
+			BR_TcpLayout::Invalidate();
 			UpdateTimeline();
 
 			SetVertPos(hTrackView, iYPos, true);
@@ -633,22 +637,11 @@ MediaTrack* TrackAtPoint(HWND hTrackView, int iY, int* iOffset, int* iYMin, int*
 	si.fMask = SIF_ALL;
 	CoolSB_GetScrollInfo(hTrackView, SB_VERT, &si);
 
-	int iVPos = -si.nPos; // Account for current scroll pos
-	int iTrack = 0;
-	int iTrackH = 0;
-
-	// Find the current track #
-	while (iTrack <= GetNumTracks())
-	{
-		MediaTrack* track = CSurf_TrackFromID(iTrack, false);
-		iTrackH = *(int*)GetSetMediaTrackInfo(track, "I_WNDH", NULL);
-		if (iVPos + iTrackH > iY)
-			break;
-		if (iTrack == 0 && TcpVis(track) && iTrackH != 0)
-			iTrackH += GetMasterTcpGap();
-		iVPos += iTrackH;
-		iTrack++;
-	}
+	// Find the current track # (binary search in the cached TCP layout)
+	BR_TcpLayout* layout = BR_TcpLayout::Get();
+	int iTrack = layout->GetIdFromWndY(iY + si.nPos);
+	int iTrackH = layout->GetWndH(iTrack);
+	int iVPos = ((iTrack >= 0) ? layout->GetOffset(iTrack) : layout->GetTotalHeight()) - si.nPos; // Account for current scroll pos
 
 	// Set extents if outside of std region
 	if (iYMin)
@@ -656,7 +649,7 @@ MediaTrack* TrackAtPoint(HWND hTrackView, int iY, int* iOffset, int* iYMin, int*
 	if (iYMax)
 		*iYMax = iVPos;
 
-	if (iTrack <= GetNumTracks())
+	if (iTrack >= 0)
 	{
 		if (iYMin)
 			*iYMin = iVPos;
@@ -697,6 +690,23 @@ MediaItem* ItemAtPoint(HWND hTrackView, POINT p, RECT* rExtents, MediaTrack** pT
 	double dPos = (p.x + si.nPos) / GetHZoomLevel();
 
 	// Then, maybe find an item
+	if (BR_TrackItemIndex* index = BR_TrackItemIndex::Get(tr))
+	{
+		int i = index->GetFirstAt(dPos);
+		if (i < 0)
+			return NULL;
+		if (index->IsUpToDate(i))
+		{
+			if (rExtents)
+			{
+				rExtents->left  = (int)(GetHZoomLevel() * index->GetStart(i) + 0.5) - si.nPos;
+				rExtents->right = (int)(GetHZoomLevel() * index->GetEnd(i) + 0.5) - si.nPos;
+			}
+			return index->GetItem(i);
+		}
+		BR_TrackItemIndex::Invalidate(); // stale, fall back to the linear scan
+	}
+
 	for (int i = 0; i < GetTrackNumMediaItems(tr); i++)
 	{
 		MediaItem* mi = GetTrackMediaItem(tr, i);
@@ -788,6 +798,7 @@ public:
 			GetSetMediaTrackInfo(CSurf_TrackFromID(i, false), "I_HEIGHTOVERRIDE", &(m_iTrackHeights.Get()[i]));
 
 		TrackList_AdjustWindows(false);
+		BR_TcpLayout::Invalidate();
 		UpdateTimeline();
 
 		// Restore positions
@@ -41,38 +41,216 @@
 
 
 // #781, peak/RMS
+// Windowed RMS pass gets every statistic at once (peaks, RMS over entire item and windowed RMS), results are memoized per
+// item state so asking for peak, average RMS and peak RMS of the same item decodes it only once. Queries that don't need
+// windowed RMS use a cached result when there is one, the cheaper non-windowed pass otherwise (not memoized)
+struct NF_AudioStats
+{
+	char key[41];
+	double windowSize; // window used for windowedRMS values
+	double sampleRate;
+	int channels;
+	double maxPeak, avgRMS, windowedRMS;
+	INT64 maxPeakSample;
+	vector<double> peaks, avgRMSs, windowedRMSs;
+	vector<INT64> peakSamples, windowedRMSsamples;
+};
+
+static WDL_PtrList_DeleteOnDestroy<NF_AudioStats> g_audioStats; // most recently used first
+const int AUDIO_STATS_MAX = 64;
+
+// Item/take properties that change item's audio (not position, selection, ids... so copies of an item share results) and
+// identity of the source file (edited outside REAPER etc.). Only used when they describe the audio completely: active
+// take playing a plain file, no take FX and no take envelopes (their bypass state etc. is only available in the chunk)
+static bool GetAudioStatsPropertiesState(MediaItem* item, WDL_FastString* state)
+{
+	MediaItem_Take* take = GetActiveTake(item);
+	if (!take || TakeFX_GetCount(take) > 0 || CountTakeEnvelopes(take) > 0)
+		return false;
+
+	PCM_source* source = GetMediaItemTake_Source(take);
+	if (!source || source->GetSource() || !source->GetFileName() || !*source->GetFileName())
+		return false;
+
+	struct stat s;
+	if (statUTF8(source->GetFileName(), &s))
+		return false;
+
+	state->SetFormatted(SNM_MAX_PATH + 64, "SRC %s %lld %lld", source->GetFileName(), (long long)s.st_size, (long long)s.st_mtime);
+	state->AppendFormatted(512, " ITEM %.14g %.14g %d %d %.14g %.14g %.14g %.14g %d %d %.14g %.14g",
+		GetMediaItemInfo_Value(item, "D_LENGTH"), GetMediaItemInfo_Value(item, "D_VOL"),
+		(int)GetMediaItemInfo_Value(item, "B_MUTE"), (int)GetMediaItemInfo_Value(item, "B_LOOPSRC"),
+		GetMediaItemInfo_Value(item, "D_FADEINLEN"), GetMediaItemInfo_Value(item, "D_FADEOUTLEN"),
+		GetMediaItemInfo_Value(item, "D_FADEINLEN_AUTO"), GetMediaItemInfo_Value(item, "D_FADEOUTLEN_AUTO"),
+		(int)GetMediaItemInfo_Value(item, "C_FADEINSHAPE"), (int)GetMediaItemInfo_Value(item, "C_FADEOUTSHAPE"),
+		GetMediaItemInfo_Value(item, "D_FADEINDIR"), GetMediaItemInfo_Value(item, "D_FADEOUTDIR"));
+	state->AppendFormatted(512, " TAKE %.14g %.14g %.14g %d %d %.14g %.14g %.14g %d",
+		GetMediaItemTakeInfo_Value(take, "D_STARTOFFS"), GetMediaItemTakeInfo_Value(take, "D_PLAYRATE"),
+		GetMediaItemTakeInfo_Value(take, "D_PITCH"), (int)GetMediaItemTakeInfo_Value(take, "B_PPITCH"),
+		(int)GetMediaItemTakeInfo_Value(take, "I_PITCHMODE"), GetMediaItemTakeInfo_Value(take, "D_VOL"),
+		GetMediaItemTakeInfo_Value(take, "D_PAN"), GetMediaItemTakeInfo_Value(take, "D_PANLAW"),
+		(int)GetMediaItemTakeInfo_Value(take, "I_CHANMODE"));
+
+	int stretchMarkers = GetTakeNumStretchMarkers(take);
+	state->AppendFormatted(64, " SM %d", stretchMarkers);
+	for (int i = 0; i < stretchMarkers; i++)
+	{
+		double position, srcPosition;
+		GetTakeStretchMarker(take, i, &position, &srcPosition);
+		state->AppendFormatted(128, " %.14g %.14g %.14g", position, srcPosition, GetTakeStretchMarkerSlope(take, i));
+	}
+	return true;
+}
+
+// Fallback for everything else: item chunk without position, selection, ids... and source file identity
+static bool GetAudioStatsChunkState(MediaItem* item, WDL_FastString* state)
+{
+	char* chunk = GetSetObjectState(item, "");
+	if (!chunk)
+		return false;
+
+	static const char* const s_skip[] = { "POSITION", "SNAPOFFS", "SEL", "LOCK", "GROUP", "IGUID", "IID", "GUID", "NAME", NULL };
+
+	state->Set("");
+	const char* line = chunk;
+	while (*line)
+	{
+		const char* end = strchr(line, '\n');
+		if (!end)
+			end = line + strlen(line);
+
+		const char* token = line;
+		while (*token == ' ' || *token == '\t')
+			++token;
+
+		bool skip = false;
+		for (int i = 0; s_skip[i] && !skip; i++)
+		{
+			size_t len = strlen(s_skip[i]);
+			skip = !strncmp(token, s_skip[i], len) && (token[len] == ' ' || token[len] == '\r' || token[len] == '\n' || !token[len]);
+		}
+		if (!skip)
+			state->Append(line, (int)(end - line + (*end ? 1 : 0)));
+
+		line = *end ? end + 1 : end;
+	}
+	FreeHeapPtr(chunk);
+
+	if (MediaItem_Take* take = GetActiveTake(item))
+	{
+		PCM_source* source = GetMediaItemTake_Source(take);
+		while (source && source->GetSource())
+			source = source->GetSource();
+
+		struct stat s;
+		if (source && source->GetFileName() && *source->GetFileName() && !statUTF8(source->GetFileName(), &s))
+			state->AppendFormatted(SNM_MAX_PATH + 64, "%s %lld %lld", source->GetFileName(), (long long)s.st_size, (long long)s.st_mtime);
+	}
+	return true;
+}
+
+// Hash of everything that changes item's audio, from item/take properties when possible (cheap) or item chunk
+// (states start with "SRC" and "<ITEM" respectively so they can't collide)
+static bool GetAudioStatsKey(MediaItem* item, char* key)
+{
+	WDL_FastString state;
+	if (!GetAudioStatsPropertiesState(item, &state) && !GetAudioStatsChunkState(item, &state))
+		return false;
+
+	GetHashString(state.Get(), key);
+	return true;
+}
+
+// windowSize <= 0.0: the caller needs only peaks or RMS over entire item, stats->windowedRMS* are then unspecified
+static bool GetAudioStats(MediaItem* item, double windowSize, NF_AudioStats* stats)
+{
+	// Only the windowed pass is memoized: other queries skip the key (item state hash) when nothing is cached
+	bool fullPass = windowSize > 0.0;
+	char key[41];
+	bool hasKey = (fullPass || g_audioStats.GetSize()) && GetAudioStatsKey(item, key);
+	if (hasKey)
+	{
+		for (int i = 0; i < g_audioStats.GetSize(); i++)
+		{
+			NF_AudioStats* cached = g_audioStats.Get(i);
+			if (!strcmp(cached->key, key) && (windowSize <= 0.0 || cached->windowSize == windowSize))
+			{
+				g_audioStats.Delete(i, false);
+				g_audioStats.Insert(0, cached);
+				*stats = *cached;
+				return true;
+			}
+		}
+	}
+
+	// Not cached: no windowed RMS if not needed (way cheaper)
+	if (!fullPass)
+		windowSize = 0.0;
+
+	int iChannels = ((PCM_source*)item)->GetNumChannels();
+	if (!iChannels)
+		return false;
+
+	stats->windowSize = windowSize;
+	stats->sampleRate = ((PCM_source*)item)->GetSampleRate();
+	stats->channels = iChannels;
+	stats->peaks.resize(iChannels);
+	stats->avgRMSs.resize(iChannels);
+	stats->windowedRMSs.resize(iChannels);
+	stats->peakSamples.resize(iChannels);
+	stats->windowedRMSsamples.resize(iChannels);
+
+	ANALYZE_PCM a;
+	memset(&a, 0, sizeof(a));
+	a.iChannels = iChannels;
+	a.dWindowSize = windowSize;
+	a.dPeakVals = &stats->peaks[0];
+	a.peakSamples = &stats->peakSamples[0];
+	a.dAvgRMSs = &stats->avgRMSs[0];
+	a.dRMSs = &stats->windowedRMSs[0];
+	a.peakRMSsamples = &stats->windowedRMSsamples[0];
+
+	if (!AnalyzeItem(item, &a))
+		return false;
+
+	stats->maxPeak = a.dPeakVal;
+	stats->maxPeakSample = a.peakSample;
+	stats->avgRMS = a.dAvgRMS;
+	stats->windowedRMS = a.dRMS;
+
+	if (hasKey && fullPass)
+	{
+		lstrcpyn(stats->key, key, sizeof(stats->key));
+		for (int i = g_audioStats.GetSize() - 1; i >= 0; i--)
+			if (!strcmp(g_audioStats.Get(i)->key, key))
+				g_audioStats.Delete(i, true);
+		while (g_audioStats.GetSize() >= AUDIO_STATS_MAX)
+			g_audioStats.Delete(g_audioStats.GetSize() - 1, true);
+		g_audioStats.Insert(0, new NF_AudioStats(*stats));
+	}
+	return true;
+}
+
 double DoGetMediaItemMaxPeakAndMaxPeakPos(MediaItem* item, double* maxPeakPosOut) // maxPeakPosOut == NULL: peak only
 {
 	double sampleRate = ((PCM_source*)item)->GetSampleRate();
 	if (sampleRate == 0.0) return -150.0;
 
-	double curPeak = -150.0;
 	double maxPeak = -150.0;
 
-	int iChannels = ((PCM_source*)item)->GetNumChannels();
-	if (iChannels)
+	NF_AudioStats stats;
+	if (GetAudioStats(item, 0.0, &stats))
 	{
-		ANALYZE_PCM a;
-		memset(&a, 0, sizeof(a));
-		a.iChannels = iChannels;
-		a.dPeakVals = new double[iChannels];
-
-		if (AnalyzeItem(item, &a))
-		{
-			for (int i = 0; i < iChannels; i++) {
-				curPeak = VAL2DB(a.dPeakVals[i]);
-				if (maxPeak < curPeak) {
-					maxPeak = curPeak;
-				}
+		for (int i = 0; i < stats.channels; i++) {
+			double curPeak = VAL2DB(stats.peaks[i]);
+			if (maxPeak < curPeak) {
+				maxPeak = curPeak;
 			}
-			if (maxPeakPosOut)
-				*maxPeakPosOut = a.peakSample / sampleRate; // relative to item position
 		}
-		delete[] a.dPeakVals;
-		return maxPeak;
+		if (maxPeakPosOut)
+			*maxPeakPosOut = stats.maxPeakSample / sampleRate; // relative to item position
 	}
-	else // empty item or failed for some reason
-		return -150.0;
+	return maxPeak;
 }
 
 double DoGetMediaItemAverageRMS(MediaItem* item) // average RMS of all channels combined over entire item
@@ -80,20 +258,11 @@ double DoGetMediaItemAverageRMS(MediaItem* item) // average RMS of all channels
 	if (!((PCM_source*)item)->GetSampleRate())
 		return -150;
 
-	int iChannels = ((PCM_source*)item)->GetNumChannels();
-	if (iChannels)
-	{
-		ANALYZE_PCM a;
-		memset(&a, 0, sizeof(a));
-		a.dWindowSize = 0.0; // non-windowed
-
-		if (AnalyzeItem(item, &a))
-			return VAL2DB(a.dRMS);
-	}
+	NF_AudioStats stats;
+	if (GetAudioStats(item, 0.0, &stats))
+		return VAL2DB(stats.avgRMS);
 	else
 		return -150.0;
-
-	return -150;
 }
 
 double DoGetMediaItemPeakRMS_NonWindowed(MediaItem* item) // highest RMS of all channels over entire item
@@ -101,32 +270,19 @@ double DoGetMediaItemPeakRMS_NonWindowed(MediaItem* item) // highest RMS of all
 	if (!((PCM_source*)item)->GetSampleRate())
 		return -150.0;
 
-	double curPeakRMS = -150.0;
 	double maxPeakRMS = -150.0;
 
-	int iChannels = ((PCM_source*)item)->GetNumChannels();
-	if (iChannels)
+	NF_AudioStats stats;
+	if (GetAudioStats(item, 0.0, &stats))
 	{
-		ANALYZE_PCM a;
-		memset(&a, 0, sizeof(a));
-		a.iChannels = iChannels;
-		a.dRMSs = new double[iChannels];
-
-		if (AnalyzeItem(item, &a))
-		{
-			for (int i = 0; i < iChannels; i++) {
-				curPeakRMS = VAL2DB(a.dRMSs[i]);
-				if (maxPeakRMS < curPeakRMS) {
-					maxPeakRMS = curPeakRMS;
-				}
+		for (int i = 0; i < stats.channels; i++) {
+			double curPeakRMS = VAL2DB(stats.avgRMSs[i]);
+			if (maxPeakRMS < curPeakRMS) {
+				maxPeakRMS = curPeakRMS;
 			}
 		}
-
-		delete[] a.dRMSs;
-		return maxPeakRMS;
 	}
-	else
-		return -150.0;
+	return maxPeakRMS;
 }
 
 double DoGetMediaItemPeakRMS_Windowed(MediaItem* item) // highest RMS window of all channels
@@ -134,12 +290,12 @@ double DoGetMediaItemPeakRMS_Windowed(MediaItem* item) // highest RMS window of
 	if (!((PCM_source*)item)->GetSampleRate())
 		return -150.0;
 
-	ANALYZE_PCM a;
-	memset(&a, 0, sizeof(a));
-	NF_GetRMSOptions(NULL, &a.dWindowSize);
+	double windowSize;
+	NF_GetRMSOptions(NULL, &windowSize);
 
-	if (AnalyzeItem(item, &a))
-		return VAL2DB(a.dRMS);
+	NF_AudioStats stats;
+	if (GetAudioStats(item, windowSize, &stats))
+		return VAL2DB(stats.windowedRMS);
 	else
 		return -150.0;
 }
@@ -178,22 +334,16 @@ bool NF_AnalyzeMediaItemPeakAndRMS(MediaItem* item, double windowSize, void* rea
 	if (samplerate == 0.0)
 		return false;
 
-	bool success = false;
-	ANALYZE_PCM a;
-	memset(&a, 0, sizeof(a));
-	a.dWindowSize = windowSize;
-	a.iChannels = ((PCM_source*)item)->GetNumChannels();
-
-	// alloc. i/o arrays
-	a.dPeakVals = new double[a.iChannels];
-	a.peakSamples = new INT64[a.iChannels];
-	a.dRMSs = new double[a.iChannels];
-	a.peakRMSsamples = new INT64[a.iChannels];
-	
-	if (a.iChannels) 
+	NF_AudioStats stats;
+	bool success = GetAudioStats(item, windowSize, &stats);
+	if (success)
 	{
-		if (AnalyzeItem(item, &a))
-			success = true;
+		// windowSize == 0.0: RMS over entire item, no RMS positions
+		if (windowSize <= 0.0)
+		{
+			stats.windowedRMSs = stats.avgRMSs;
+			stats.windowedRMSsamples.assign(stats.channels, -666);
+		}
 
 		// cast reaperarrays to double*
 		double* d_reaperarray_peaks = static_cast<double*>(reaperarray_peaks);
@@ -212,47 +362,42 @@ bool NF_AnalyzeMediaItemPeakAndRMS(MediaItem* item, double windowSize, void* rea
 
 		// write analyzed values to reaperarrays
 		// never write to [0] in reaperarrays!!!
-		for (int i = 1; i <= a.iChannels; i++) {
+		for (int i = 1; i <= stats.channels; i++) {
 			if (d_reaperarray_peaksCurSize < ((uint32_t*)(d_reaperarray_peaks))[1]) { // higher 32 bits in 1st entry: max alloc. size
-				d_reaperarray_peaks[i] = VAL2DB(a.dPeakVals[i - 1]);
+				d_reaperarray_peaks[i] = VAL2DB(stats.peaks[i - 1]);
 				d_reaperarray_peaksCurSize++;
 			}
 			else
 				break;
 		}
 
-		for (int i = 1; i <= a.iChannels; i++) {
+		for (int i = 1; i <= stats.channels; i++) {
 			if (d_reaperarray_peakpositionsCurSize < ((uint32_t*)(d_reaperarray_peakpositions))[1]) {
-				d_reaperarray_peakpositions[i] = GetPosInItem(a.peakSamples[i - 1], samplerate);
+				d_reaperarray_peakpositions[i] = GetPosInItem(stats.peakSamples[i - 1], samplerate);
 				d_reaperarray_peakpositionsCurSize++;
 			}
 			else
 				break;
 		}
 
-		for (int i = 1; i <= a.iChannels; i++) {
+		for (int i = 1; i <= stats.channels; i++) {
 			if (d_reaperarray_RMSsCurSize < ((uint32_t*)(d_reaperarray_RMSs))[1]) {
-				d_reaperarray_RMSs[i] = VAL2DB(a.dRMSs[i - 1]);
+				d_reaperarray_RMSs[i] = VAL2DB(stats.windowedRMSs[i - 1]);
 				d_reaperarray_RMSsCurSize++;
 			}
 			else
 				break;
 		}
 
-		for (int i = 1; i <= a.iChannels; i++) {
+		for (int i = 1; i <= stats.channels; i++) {
 			if (d_reaperarray_RMSpositionsCurSize < ((uint32_t*)(d_reaperarray_RMSpositions))[1]) {
-				d_reaperarray_RMSpositions[i] = GetPosInItem(a.peakRMSsamples[i - 1], samplerate);
+				d_reaperarray_RMSpositions[i] = GetPosInItem(stats.windowedRMSsamples[i - 1], samplerate);
 				d_reaperarray_RMSpositionsCurSize++;
 			}
 			else
 				break;
 		}
 	}
-
-	delete[] a.dPeakVals;
-	delete[] a.peakSamples;
-	delete[] a.dRMSs;
-	delete[] a.peakRMSsamples;
 	return success;
 }
 
@@ -482,6 +482,7 @@ public:
 		SNM_CSurfRun();
 		ZoomSlice();
 		MiscSlice();
+		Snapshot::StagedRecallSlice();
 
 		if (m_bChanged)
 		{
@@ -508,6 +509,8 @@ public:
 		AutoColorTrack(false);
 		AutoColorMarkerRegion(false);
 		SNM_CSurfSetTrackListChange();
+		BR_CSurf_SetTrackListChange();
+		InvalidateGuidIndex();
 		m_iACIgnore = GetNumTracks() + 1;
 	}
 	// For every SetTrackListChange we get NumTracks+1 SetTrackTitle calls, but we only
@@ -860,6 +863,7 @@ error:
 		IMPAPI(GetTakeEnvelopeByName);
 		IMPAPI(GetTakeName);
 		IMPAPI(GetTakeStretchMarker);
+		IMPAPI(GetTakeStretchMarkerSlope); // v5.0pre4+
 		IMPAPI(GetSetTrackSendInfo);
 		IMPAPI(GetSetTrackState);
 		IMPAPI(GetSet_LoopTimeRange);
@@ -1118,6 +1122,11 @@ error:
 		// Optional API functions (check for NULL if using!) 
 		IMPAP_OPT(GetSetTrackGroupMembershipHigh); // v5.70+
 		IMPAP_OPT(TrackFX_GetOffline); // v5.95+
+		IMPAP_OPT(TrackFX_SetOffline); // v5.95+
+		IMPAP_OPT(TakeFX_GetEnabled);
+		IMPAP_OPT(TakeFX_SetEnabled);
+		IMPAP_OPT(TakeFX_GetOffline); // v5.95+
+		IMPAP_OPT(TakeFX_SetOffline); // v5.95+
 
 		// Look for SWS dupe/clone
 		if (rec->GetFunc("SNM_GetIntConfigVar"))
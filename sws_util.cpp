@@ -30,6 +30,9 @@
 #include "Breeder/BR_Util.h"
 #include "WDL/sha.h"
 #include "reaper/localize.h"
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 // Globals
 double g_d0 = 0.0;
@@ -355,16 +358,6 @@ const GUID* TrackToGuid(MediaTrack* tr)
 	return NULL;
 }
 
-MediaTrack* GuidToTrack(const GUID* guid)
-{
-	if (guid)
-		for (int i=0; i<=GetNumTracks(); i++)
-			if (MediaTrack* tr = CSurf_TrackFromID(i, false))
-				if (TrackMatchesGuid(tr, guid))
-					return tr;
-	return NULL;
-}
-
 bool GuidsEqual(const GUID* g1, const GUID* g2)
 {
 	return g1 && g2 && !memcmp(g1, g2, sizeof(GUID));
@@ -383,6 +376,326 @@ bool TrackMatchesGuid(MediaTrack* tr, const GUID* g)
 	return false;
 }
 
+// GUID -> track/item/take index
+// Built on demand for one project (tracks and items/takes separately) and
+// dropped on track list changes, see SWSTimeSlice::SetTrackListChange() which
+// is also our notification of project tab changes.
+// Hits are checked against the project before any dereference (stale entries
+// force a rebuild). Misses rebuild when the project signature (state change,
+// track, item and take counts) changed, otherwise they fall back to a linear
+// search like before the index existed and rebuild if that one finds it.
+class SWS_GuidIndex
+{
+public:
+	enum { TRACK=0, ITEM, TAKE, NB_TYPES };
+
+	SWS_GuidIndex() : m_proj(NULL), m_stateCount(0), m_trackCount(0), m_itemCount(0), m_takeCount(0) { Invalidate(); }
+
+	void Invalidate() { m_built[TRACK] = m_built[ITEM] = false; }
+
+	void* Find(int type, const GUID* guid, ReaProject* proj)
+	{
+		if (!guid)
+			return NULL;
+		if (!proj)
+			proj = EnumProjects(-1, NULL, 0);
+
+		int built = type == TRACK ? TRACK : ITEM; // items and takes are built together
+		if (!m_built[built] || m_proj != proj)
+			Build(built, proj);
+
+		bool stale = false;
+		if (void* p = Lookup(type, guid, proj, &stale))
+			return p;
+		if (stale || HasChanged(built, proj))
+		{
+			Build(built, proj);
+			return Lookup(type, guid, proj, &stale);
+		}
+
+		// the signature can't see everything (e.g. GUIDs changed through chunks), don't trust a miss
+		void* p = LinearFind(type, guid, proj);
+		if (p)
+			Build(built, proj);
+		return p;
+	}
+
+private:
+	struct GuidLess {
+		bool operator()(const GUID& g1, const GUID& g2) const { return memcmp(&g1, &g2, sizeof(GUID)) < 0; }
+	};
+
+	// where to find the object back, so that entries can be checked without dereferencing them
+	struct Entry {
+		void* obj;
+		MediaTrack* tr;
+		int trIdx; // -1: master
+		MediaItem* item;
+		int itemIdx, takeIdx;
+	};
+
+	typedef std::map<GUID, Entry, GuidLess> GuidMap;
+
+	bool HasChanged(int built, ReaProject* proj)
+	{
+		if (GetProjectStateChangeCount(proj) != m_stateCount || CountTracks(proj) != m_trackCount)
+			return true;
+		if (built == TRACK)
+			return false;
+
+		// O(N) but only called on misses
+		int itemCount, takeCount;
+		CountItemsAndTakes(proj, &itemCount, &takeCount);
+		return itemCount != m_itemCount || takeCount != m_takeCount;
+	}
+
+	void CountItemsAndTakes(ReaProject* proj, int* itemCount, int* takeCount)
+	{
+		*itemCount = *takeCount = 0;
+		const int trackCount = CountTracks(proj);
+		for (int i=0; i < trackCount; i++)
+			if (MediaTrack* tr = GetTrack(proj, i))
+			{
+				const int count = CountTrackMediaItems(tr);
+				for (int j=0; j < count; j++)
+					if (MediaItem* item = GetTrackMediaItem(tr, j))
+					{
+						(*itemCount)++;
+						*takeCount += GetMediaItemNumTakes(item);
+					}
+			}
+	}
+
+	// same search as GuidToTrack() & co. did before the index
+	void* LinearFind(int type, const GUID* guid, ReaProject* proj)
+	{
+		if (type == TRACK)
+		{
+			MediaTrack* master = GetMasterTrack(proj);
+			if (master && (GuidsEqual(GetTrackGUID(master), guid) || GuidsEqual(guid, &GUID_NULL)))
+				return master;
+		}
+
+		const int trackCount = CountTracks(proj);
+		for (int i=0; i < trackCount; i++)
+		{
+			MediaTrack* tr = GetTrack(proj, i);
+			if (!tr)
+				continue;
+			if (type == TRACK)
+			{
+				if (GuidsEqual(GetTrackGUID(tr), guid))
+					return tr;
+				continue;
+			}
+
+			const int itemCount = CountTrackMediaItems(tr);
+			for (int j=0; j < itemCount; j++)
+			{
+				MediaItem* item = GetTrackMediaItem(tr, j);
+				if (!item)
+					continue;
+				if (type == ITEM)
+				{
+					if (GuidsEqual((const GUID*)GetSetMediaItemInfo(item, "GUID", NULL), guid))
+						return item;
+					continue;
+				}
+
+				const int takeCount = GetMediaItemNumTakes(item);
+				for (int k=0; k < takeCount; k++)
+					if (MediaItem_Take* tk = GetMediaItemTake(item, k))
+						if (GuidsEqual((const GUID*)GetSetMediaItemTakeInfo(tk, "GUID", NULL), guid))
+							return tk;
+			}
+		}
+		return NULL;
+	}
+
+	void Build(int built, ReaProject* proj)
+	{
+		if (m_proj != proj)
+		{
+			m_proj = proj;
+			Invalidate();
+		}
+		m_stateCount = GetProjectStateChangeCount(proj);
+		m_trackCount = CountTracks(proj);
+
+		if (built == TRACK)
+		{
+			GuidMap& tracks = m_guids[TRACK];
+			tracks.clear();
+			Entry e = {};
+			if (MediaTrack* master = GetMasterTrack(proj))
+			{
+				e.obj = e.tr = master;
+				e.trIdx = -1;
+				tracks[GUID_NULL] = e; // see TrackToGuid()
+				if (const GUID* g = GetTrackGUID(master))
+					tracks[*g] = e;
+			}
+			for (int i=0; i < m_trackCount; i++)
+				if (MediaTrack* tr = GetTrack(proj, i))
+					if (const GUID* g = GetTrackGUID(tr))
+					{
+						e.obj = e.tr = tr;
+						e.trIdx = i;
+						tracks.insert(GuidMap::value_type(*g, e)); // 1st one wins, as with a linear search
+					}
+		}
+		else
+		{
+			GuidMap& items = m_guids[ITEM];
+			GuidMap& takes = m_guids[TAKE];
+			items.clear();
+			takes.clear();
+			m_itemCount = m_takeCount = 0;
+			Entry e = {};
+			for (int i=0; i < m_trackCount; i++)
+			{
+				MediaTrack* tr = GetTrack(proj, i);
+				const int itemCount = tr ? CountTrackMediaItems(tr) : 0;
+				for (int j=0; j < itemCount; j++)
+				{
+					MediaItem* item = GetTrackMediaItem(tr, j);
+					if (!item)
+						continue;
+					m_itemCount++;
+
+					e.tr = tr;
+					e.trIdx = i;
+					e.item = item;
+					e.itemIdx = j;
+					e.takeIdx = -1;
+					if (const GUID* g = (const GUID*)GetSetMediaItemInfo(item, "GUID", NULL))
+					{
+						e.obj = item;
+						items.insert(GuidMap::value_type(*g, e));
+					}
+
+					const int takeCount = GetMediaItemNumTakes(item);
+					m_takeCount += takeCount;
+					for (int k=0; k < takeCount; k++)
+						if (MediaItem_Take* tk = GetMediaItemTake(item, k))
+							if (const GUID* g = (const GUID*)GetSetMediaItemTakeInfo(tk, "GUID", NULL))
+							{
+								e.obj = tk;
+								e.takeIdx = k;
+								takes.insert(GuidMap::value_type(*g, e));
+							}
+				}
+			}
+		}
+		m_built[built] = true;
+	}
+
+	void* Lookup(int type, const GUID* guid, ReaProject* proj, bool* stale)
+	{
+		GuidMap::iterator it = m_guids[type].find(*guid);
+		if (it == m_guids[type].end())
+			return NULL;
+
+		const Entry& e = it->second;
+		bool valid = (e.trIdx < 0 ? GetMasterTrack(proj) : GetTrack(proj, e.trIdx)) == e.tr;
+		if (valid && type != TRACK)
+			valid = GetTrackMediaItem(e.tr, e.itemIdx) == e.item;
+		if (valid && type == TAKE)
+			valid = GetMediaItemTake(e.item, e.takeIdx) == e.obj;
+
+		// the object is alive, check it still has that GUID
+		if (valid)
+		{
+			switch (type)
+			{
+				case TRACK: valid = GuidsEqual(GetTrackGUID(e.tr), guid) || (e.trIdx < 0 && GuidsEqual(guid, &GUID_NULL)); break;
+				case ITEM:  valid = GuidsEqual((const GUID*)GetSetMediaItemInfo(e.item, "GUID", NULL), guid); break;
+				case TAKE:  valid = GuidsEqual((const GUID*)GetSetMediaItemTakeInfo((MediaItem_Take*)e.obj, "GUID", NULL), guid); break;
+			}
+		}
+
+		if (valid)
+			return e.obj;
+		*stale = true;
+		return NULL;
+	}
+
+	ReaProject* m_proj;
+	bool m_built[2];
+	int m_stateCount, m_trackCount, m_itemCount, m_takeCount;
+	GuidMap m_guids[NB_TYPES];
+};
+
+static SWS_GuidIndex g_guidIndex;
+
+MediaTrack* GuidToTrack(const GUID* guid, ReaProject* proj)
+{
+	return (MediaTrack*)g_guidIndex.Find(SWS_GuidIndex::TRACK, guid, proj);
+}
+
+MediaItem* GuidToMediaItem(const GUID* guid, ReaProject* proj)
+{
+	return (MediaItem*)g_guidIndex.Find(SWS_GuidIndex::ITEM, guid, proj);
+}
+
+namespace {
+struct GuidIdx
+{
+	GUID guid;
+	int idx;
+	bool operator<(const GuidIdx& g) const { return memcmp(&guid, &g.guid, sizeof(GUID)) < 0; }
+};
+}
+
+void GuidsToMediaItems(const GUID* guids, int nGuids, MediaItem** items, ReaProject* proj, MediaTrack* tr)
+{
+	if (nGuids <= 0)
+		return;
+	memset(items, 0, nGuids * sizeof(MediaItem*));
+
+	// temporary sorted index of the requested GUIDs, looked up once per item
+	std::vector<GuidIdx> requested(nGuids);
+	for (int i = 0; i < nGuids; i++)
+	{
+		requested[i].guid = guids[i];
+		requested[i].idx = i;
+	}
+	std::sort(requested.begin(), requested.end());
+
+	int nFound = 0;
+	int nTracks = tr ? 1 : CountTracks(proj);
+	for (int i = 0; i < nTracks && nFound < nGuids; i++)
+	{
+		MediaTrack* track = tr ? tr : GetTrack(proj, i);
+		int nItems = CountTrackMediaItems(track);
+		for (int j = 0; j < nItems && nFound < nGuids; j++)
+		{
+			MediaItem* item = GetTrackMediaItem(track, j);
+			GuidIdx key;
+			key.guid = *(GUID*)GetSetMediaItemInfo(item, "GUID", NULL);
+			std::pair<std::vector<GuidIdx>::iterator, std::vector<GuidIdx>::iterator> range = std::equal_range(requested.begin(), requested.end(), key);
+			for (std::vector<GuidIdx>::iterator it = range.first; it != range.second; ++it)
+			{
+				if (!items[it->idx])
+				{
+					items[it->idx] = item;
+					nFound++;
+				}
+			}
+		}
+	}
+}
+
+MediaItem_Take* GuidToTake(const GUID* guid, ReaProject* proj)
+{
+	return (MediaItem_Take*)g_guidIndex.Find(SWS_GuidIndex::TAKE, guid, proj);
+}
+
+void InvalidateGuidIndex()
+{
+	g_guidIndex.Invalidate();
+}
+
 const char *stristr(const char* a, const char* b)
 {
   int i;
@@ -521,6 +834,18 @@ bool SWS_IsWindow(HWND hwnd)
 #endif
 }
 
+int SWS_GetNumCPUs()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	int cpus = (int)info.dwNumberOfProcessors;
+#else
+	int cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return (cpus > 0) ? cpus : 1;
+}
+
 bool SWS_IsTrackHeightLocked(MediaTrack* track)
 {
 	// NF: REAPER version check and chunk parsing could be removed when REAPER 5.95+ becomes required for SWS
@@ -230,7 +230,12 @@ HWND GetTrackWnd();
 HWND GetRulerWnd();
 char* GetHashString(const char* in, char* out);
 const GUID* TrackToGuid(MediaTrack* tr);
-MediaTrack* GuidToTrack(const GUID* guid);
+MediaTrack* GuidToTrack(const GUID* guid, ReaProject* proj = NULL); // GUID_NULL: master track, see TrackToGuid()
+MediaItem* GuidToMediaItem(const GUID* guid, ReaProject* proj = NULL);
+// batch version: one pass through the items of tr (or of all tracks), items[i] is NULL if guids[i] isn't found
+void GuidsToMediaItems(const GUID* guids, int nGuids, MediaItem** items, ReaProject* proj = NULL, MediaTrack* tr = NULL);
+MediaItem_Take* GuidToTake(const GUID* guid, ReaProject* proj = NULL);
+void InvalidateGuidIndex();
 bool GuidsEqual(const GUID* g1, const GUID* g2);
 bool TrackMatchesGuid(MediaTrack* tr, const GUID* g);
 const char *stristr(const char* a, const char* b);
@@ -257,6 +262,7 @@ void SWS_GetSelectedMediaItems(WDL_TypedBuf<MediaItem*>* buf);
 void SWS_GetSelectedMediaItemsOnTrack(WDL_TypedBuf<MediaItem*>* buf, MediaTrack* tr);
 int SWS_GetModifiers();
 bool SWS_IsWindow(HWND hwnd);
+int SWS_GetNumCPUs();
 
 // NF: #966, no API currently (R5.78) to get/set track height lock state
 // so use chunk parsing for now
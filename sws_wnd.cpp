@@ -51,6 +51,18 @@
 #define TOOLTIP_TIMER		0x1001
 #define TOOLTIP_TIMEOUT		350
 
+// FNV-1a, 0 is reserved for "unknown" (SWS_ListView's virtual mode)
+static unsigned int CellHash(const char* str)
+{
+	unsigned int h = 2166136261u;
+	while (*str)
+	{
+		h ^= (unsigned char)*str++;
+		h *= 16777619u;
+	}
+	return h ? h : 1;
+}
+
 
 SWS_DockWnd::SWS_DockWnd(int iResource, const char* cWndTitle, const char* cId, int iCmdID)
 :m_hwnd(NULL), m_iResource(iResource), m_wndTitle(cWndTitle), m_id(cId), m_bUserClosed(false), m_iCmdID(iCmdID), m_bSaveStateOnDestroy(true)
@@ -718,6 +730,10 @@ SWS_ListView::SWS_ListView(HWND hwndList, HWND hwndEdit, int iCols, SWS_LVColumn
 #endif
 {
 	memset(m_oldColors,0,sizeof(m_oldColors));
+	m_bVirtual = (GetWindowLongPtr(hwndList, GWL_STYLE) & LVS_OWNERDATA) != 0;
+	m_vHashStride = 0;
+	m_vSortCol = 0;
+	m_bVirtualUpdating = false;
 	SetWindowLongPtr(hwndList, GWLP_USERDATA, (LONG_PTR)this);
 	if (m_hwndEdit)
 		SetWindowLongPtr(m_hwndEdit, GWLP_USERDATA, 0xdeadf00b);
@@ -815,6 +831,12 @@ SWS_ListItem* SWS_ListView::GetListItem(int index, int* iState)
 {
 	if (index < 0)
 		return NULL;
+	if (m_bVirtual)
+	{
+		if (iState)
+			*iState = ListView_GetItemState(m_hwndList, index, LVIS_SELECTED | LVIS_FOCUSED);
+		return m_vRows.Get(index);
+	}
 	LVITEM li;
 	li.mask = LVIF_PARAM | (iState ? LVIF_STATE : 0);
 	li.stateMask = LVIS_SELECTED | LVIS_FOCUSED;
@@ -841,6 +863,22 @@ SWS_ListItem* SWS_ListView::EnumSelected(int* i, int iOffset)
 	int temp = 0;
 	if (!i)
 		i = &temp;
+
+	if (m_bVirtual)
+	{
+		while (*i < m_vRows.GetSize())
+		{
+			int iItem = (*i)++;
+			if (ListView_GetItemState(m_hwndList, iItem, LVIS_SELECTED))
+			{
+				if (iOffset != 0 && (iItem + iOffset) >= 0 && (iItem + iOffset) < m_vRows.GetSize())
+					iItem += iOffset;
+				return m_vRows.Get(iItem);
+			}
+		}
+		return NULL;
+	}
+
 	LVITEM li;
 	li.mask = LVIF_PARAM | LVIF_STATE;
 	li.stateMask = LVIS_SELECTED;
@@ -875,29 +913,100 @@ int SWS_ListView::CountSelected ()
 
 bool SWS_ListView::SelectByItem(SWS_ListItem* _item, bool bSelectOnly, bool bEnsureVisible)
 {
-	if (_item)
+	int i = _item ? FindListItem(_item) : -1;
+	if (i >= 0)
 	{
-		for (int i = 0; i < GetListItemCount(); i++)
-		{
-			SWS_ListItem* item = GetListItem(i);
-			if (item == _item)
-			{
-				if (bSelectOnly)
-					ListView_SetItemState(m_hwndList, -1, 0, LVIS_SELECTED);
-				ListView_SetItemState(m_hwndList, i, LVIS_SELECTED, LVIS_SELECTED);
-				if (bEnsureVisible)
-					ListView_EnsureVisible(m_hwndList, i, true);
-				return true;
-			}
-		}
+		if (bSelectOnly)
+			ListView_SetItemState(m_hwndList, -1, 0, LVIS_SELECTED);
+		ListView_SetItemState(m_hwndList, i, LVIS_SELECTED, LVIS_SELECTED);
+		if (bEnsureVisible)
+			ListView_EnsureVisible(m_hwndList, i, true);
+		return true;
 	}
 	return false;
 }
 
+// Returns the listview index of item, -1 if not found
+int SWS_ListView::FindListItem(SWS_ListItem* item)
+{
+	if (m_bVirtual)
+	{
+		int iItem = m_vRowIdx.Get((INT_PTR)item, -1);
+		return (item && m_vRows.Get(iItem) == item) ? iItem : -1;
+	}
+#ifdef _WIN32
+	LVFINDINFO fi;
+	fi.flags = LVFI_PARAM;
+	fi.lParam = (LPARAM)item;
+	return ListView_FindItem(m_hwndList, -1, &fi);
+#else
+	LVITEM li;
+	li.mask = LVIF_PARAM;
+	li.iSubItem = 0;
+	for (int i = 0; i < ListView_GetItemCount(m_hwndList); i++)
+	{
+		li.iItem = i;
+		ListView_GetItem(m_hwndList, &li);
+		if ((SWS_ListItem*)li.lParam == item)
+			return i;
+	}
+	return -1;
+#endif
+}
+
 int SWS_ListView::OnNotify(WPARAM wParam, LPARAM lParam)
 {
 	NMLISTVIEW* s = (NMLISTVIEW*)lParam;
 
+	if (m_bVirtual)
+	{
+		// Virtual mode: cell texts are pulled here, for displayed rows only
+#ifdef _WIN32
+		if (s->hdr.code == LVN_GETDISPINFOA || s->hdr.code == LVN_GETDISPINFOW)
+#else
+		if (s->hdr.code == LVN_GETDISPINFO)
+#endif
+		{
+			NMLVDISPINFO* di = (NMLVDISPINFO*)lParam;
+			if ((di->item.mask & LVIF_TEXT) && di->item.pszText && di->item.cchTextMax > 0)
+			{
+				di->item.pszText[0] = 0;
+				if (SWS_ListItem* item = m_vRows.Get(di->item.iItem))
+					GetItemText(item, DisplayToDataCol(di->item.iSubItem), di->item.pszText, di->item.cchTextMax);
+#if defined(_WIN32) && !defined(WDL_NO_SUPPORT_UTF8)
+				if (s->hdr.code == LVN_GETDISPINFOW)
+					WDL_UTF8_ListViewConvertDispInfoToW(di);
+#endif
+			}
+			return 0;
+		}
+#ifdef _WIN32
+		// Owner data listviews notify range and "all items" state changes at once
+		if (!m_bDisableUpdates && s->hdr.code == LVN_ODSTATECHANGED)
+		{
+			NMLVODSTATECHANGE* od = (NMLVODSTATECHANGE*)lParam;
+			if ((od->uNewState ^ od->uOldState) & LVIS_SELECTED)
+				for (int i = od->iFrom; i <= od->iTo && i < m_vRows.GetSize(); i++)
+				{
+					int iState;
+					SWS_ListItem* item = GetListItem(i, &iState);
+					OnItemSelChanged(item, iState);
+				}
+			return 0;
+		}
+		if (!m_bDisableUpdates && s->hdr.code == LVN_ITEMCHANGED && s->iItem < 0 && s->uChanged & LVIF_STATE && (s->uNewState ^ s->uOldState) & LVIS_SELECTED)
+		{
+			for (int i = 0; i < m_vRows.GetSize(); i++)
+			{
+				int iState;
+				SWS_ListItem* item = GetListItem(i, &iState);
+				OnItemSelChanged(item, iState);
+			}
+			return 0;
+		}
+#endif
+	}
+
 #ifdef _WIN32
 	if (!m_bDisableUpdates && s->hdr.code == LVN_ITEMCHANGING && s->iItem >= 0 && (s->uNewState ^ s->uOldState) & LVIS_SELECTED)
 	{
@@ -1170,11 +1279,46 @@ int SWS_ListView::LVKeyHandler(MSG* msg, int iKeyState)
 
 void SWS_ListView::Update()
 {
+	// Virtual mode: rows point to the derived class items, which might be freed by now and
+	// cell texts are pulled at paint time, so the rows are refreshed even when editing or
+	// when updates are disabled (texts, selection and sorting wait for the next full update)
+	if (m_bVirtual && (m_iEditingItem != -1 || m_bDisableUpdates))
+	{
+		if (!m_bVirtualUpdating)
+		{
+			bool bDisableUpdates = m_bDisableUpdates;
+			m_bDisableUpdates = true; // no selection notifications while rows move
+			m_bVirtualUpdating = true;
+			SWS_ListItem* editedItem = m_vRows.Get(m_iEditingItem); // compared only, not dereferenced
+			UpdateVirtual(true);
+			if (m_iEditingItem != -1)
+			{
+				int iRow = FindListItem(editedItem);
+				if (iRow < 0)
+					EditListItemEnd(false); // edited item is gone
+				else
+					m_iEditingItem = iRow;
+			}
+			m_bVirtualUpdating = false;
+			m_bDisableUpdates = bDisableUpdates;
+		}
+		return;
+	}
+
 	// Fill in the data by pulling it from the derived class
 	if (m_iEditingItem == -1 && !m_bDisableUpdates)
 	{
 		m_bDisableUpdates = true;
 
+		if (m_bVirtual)
+		{
+			m_bVirtualUpdating = true;
+			UpdateVirtual();
+			m_bVirtualUpdating = false;
+			m_bDisableUpdates = false;
+			return;
+		}
+
 		char str[CELL_MAX_LEN]="";
 		bool bRemovedItems = false;
 
@@ -1193,9 +1337,15 @@ void SWS_ListView::Update()
 			ListView_DeleteAllItems(m_hwndList);
 
 		// The list is sorted, use that to our advantage here:
+		// used items are flagged rather than deleted from the item list (no memmove per row)
+		WDL_TypedBuf<char> used;
+		used.Resize(items.GetSize(), false);
+		memset(used.Get(), 0, used.GetSize());
+		int nUsed = 0, iNext = 0;
+
 		int lvItemCount = ListView_GetItemCount(m_hwndList);
 		int newIndex = lvItemCount;
-		for (int i = 0; items.GetSize() || i < lvItemCount; i++)
+		for (int i = 0; nUsed < items.GetSize() || i < lvItemCount; i++)
 		{
 			bool bFound = false;
 			SWS_ListItem* pItem;
@@ -1203,7 +1353,7 @@ void SWS_ListView::Update()
 			{	// First check items in the listview, match to item list
 				pItem = GetListItem(i);
 				int iIndex = items.Find(pItem);
-				if (iIndex == -1)
+				if (iIndex == -1 || used.Get()[iIndex])
 				{
 					// Delete items from listview that aren't in the item list
 					ListView_DeleteItem(m_hwndList, i);
@@ -1215,14 +1365,18 @@ void SWS_ListView::Update()
 				}
 				else
 				{
-					// Delete item from item list to indicate "used"
-					items.Delete(iIndex);
+					used.Get()[iIndex] = 1;
+					nUsed++;
 					bFound = true;
 				}
 			}
 			else
 			{	// Items left in the item list are new
-				pItem = items.Remove();
+				while (used.Get()[iNext])
+					iNext++;
+				pItem = items.Get(iNext);
+				used.Get()[iNext] = 1;
+				nUsed++;
 			}
 
 			// We have an item pointer, and a listview index, add/edit the listview
@@ -1320,6 +1474,224 @@ void SWS_ListView::Update()
 	}
 }
 
+// Virtual mode update: O(1) item -> row matching, cell texts are only pulled for
+// the sort column (all rows) and the displayed rows, whose cells are diffed
+// against their hashes so that only the modified rows get redrawn
+// bRowsOnly: only drop the removed items/append the new ones, no cell text is pulled
+void SWS_ListView::UpdateVirtual(bool bRowsOnly)
+{
+	SWS_ListItemList items;
+	GetItemList(&items);
+
+	int nDispCols = 0;
+	for (int k = 0; k < m_iCols; k++)
+		if (m_pCols[k].iPos != -1)
+			nDispCols++;
+	if (m_vHashStride != nDispCols + 1)
+	{
+		ResetVirtual();
+		m_vHashStride = nDispCols + 1;
+	}
+	const int stride = m_vHashStride;
+
+	bool bResort = m_vSortCol != m_iSortCol;
+	m_vSortCol = m_iSortCol;
+
+	// Match items with the current rows
+	int nOld = m_vRows.GetSize(), nKept = 0;
+	WDL_TypedBuf<SWS_ListItem*> kept;
+	kept.Resize(nOld, false);
+	memset(kept.Get(), 0, kept.GetSize() * sizeof(SWS_ListItem*));
+	WDL_PtrList<SWS_ListItem> added;
+	for (int i = 0; i < items.GetSize(); i++)
+	{
+		SWS_ListItem* item = items.Get(i);
+		int iRow = FindListItem(item);
+		if (iRow < 0)
+			added.Add(item);
+		else if (!kept.Get()[iRow])
+		{
+			kept.Get()[iRow] = item;
+			nKept++;
+		}
+	}
+
+	bool bRedrawAll = false;
+	if (added.GetSize() || nKept != nOld)
+	{
+		// Rows keep their order (and selection state), new items are appended
+		int nNew = nKept + added.GetSize();
+		WDL_TypedBuf<unsigned int> hashes;
+		hashes.Resize(nNew * stride, false);
+		memset(hashes.Get(), 0, hashes.GetSize() * sizeof(unsigned int));
+		WDL_TypedBuf<int> states;
+		states.Resize(nNew, false);
+		memset(states.Get(), 0, states.GetSize() * sizeof(int));
+
+		int iRow = 0;
+		for (int i = 0; i < nOld; i++)
+			if (kept.Get()[i])
+			{
+				states.Get()[iRow] = ListView_GetItemState(m_hwndList, i, LVIS_SELECTED | LVIS_FOCUSED);
+				memcpy(hashes.Get() + iRow * stride, m_vHashes.Get() + i * stride, stride * sizeof(unsigned int));
+				iRow++;
+			}
+
+		m_vRows.Empty();
+		for (int i = 0; i < nOld; i++)
+			if (kept.Get()[i])
+				m_vRows.Add(kept.Get()[i]);
+		for (int i = 0; i < added.GetSize(); i++)
+			m_vRows.Add(added.Get(i));
+		m_vHashes.Resize(hashes.GetSize(), false);
+		memcpy(m_vHashes.Get(), hashes.Get(), hashes.GetSize() * sizeof(unsigned int));
+
+		m_vRowIdx.DeleteAll();
+		for (int i = 0; i < m_vRows.GetSize(); i++)
+			m_vRowIdx.AddUnsorted((INT_PTR)m_vRows.Get(i), i);
+		m_vRowIdx.Resort();
+
+		ListView_SetItemCount(m_hwndList, nNew);
+		ListView_SetItemState(m_hwndList, -1, 0, LVIS_SELECTED | LVIS_FOCUSED);
+		for (int i = 0; i < nNew; i++)
+			if (states.Get()[i])
+				ListView_SetItemState(m_hwndList, i, states.Get()[i], LVIS_SELECTED | LVIS_FOCUSED);
+
+		bResort |= added.GetSize() > 0;
+		bRedrawAll = true;
+	}
+
+	if (bRowsOnly)
+	{
+		if (bRedrawAll)
+			InvalidateRect(m_hwndList, NULL, FALSE);
+		return;
+	}
+
+	// Selection states
+	for (int i = 0; i < m_vRows.GetSize(); i++)
+	{
+		int iNewState = GetItemState(m_vRows.Get(i));
+		if (iNewState >= 0)
+		{
+			int iCurState = ListView_GetItemState(m_hwndList, i, LVIS_SELECTED | LVIS_FOCUSED);
+			if (iNewState && !(iCurState & LVIS_SELECTED))
+				ListView_SetItemState(m_hwndList, i, LVIS_SELECTED, LVIS_SELECTED);
+			else if (!iNewState && (iCurState & LVIS_SELECTED))
+				ListView_SetItemState(m_hwndList, i, 0, LVIS_SELECTED | ((iCurState & LVIS_FOCUSED) ? LVIS_FOCUSED : 0));
+		}
+	}
+
+	// Resort only if the sorted column has changed
+	char str[CELL_MAX_LEN]="";
+	int iSortCol = abs(m_iSortCol) - 1;
+	if (iSortCol >= 0 && iSortCol < m_iCols)
+		for (int i = 0; i < m_vRows.GetSize(); i++)
+		{
+			GetItemText(m_vRows.Get(i), iSortCol, str, sizeof(str));
+			unsigned int h = CellHash(str);
+			if (m_vHashes.Get()[i * stride] != h)
+			{
+				m_vHashes.Get()[i * stride] = h;
+				bResort = true;
+			}
+		}
+
+	if (bResort)
+	{
+		Sort();
+		bRedrawAll = true;
+	}
+
+	// Displayed rows: redraw the modified ones only
+	// (hashes of hidden rows can be stale, worst case is a redundant redraw)
+	int iFirst = max(0, ListView_GetTopIndex(m_hwndList));
+	int iLast = min(m_vRows.GetSize() - 1, iFirst + ListView_GetCountPerPage(m_hwndList));
+	for (int i = iFirst; i <= iLast; i++)
+	{
+		bool bChanged = false;
+		unsigned int* h = m_vHashes.Get() + i * stride + 1;
+		int iCol = 0;
+		for (int k = 0; k < m_iCols; k++)
+			if (m_pCols[k].iPos != -1)
+			{
+				GetItemText(m_vRows.Get(i), k, str, sizeof(str));
+				unsigned int cellHash = CellHash(str);
+				if (h[iCol] != cellHash)
+				{
+					h[iCol] = cellHash;
+					bChanged = true;
+				}
+				iCol++;
+			}
+		if (bChanged && !bRedrawAll)
+			ListView_RedrawItems(m_hwndList, i, i);
+	}
+
+	if (bRedrawAll)
+		InvalidateRect(m_hwndList, NULL, FALSE);
+}
+
+struct SWS_ListView::VirtualRowCompare
+{
+	SWS_ListView* m_lv;
+	VirtualRowCompare(SWS_ListView* lv) : m_lv(lv) {}
+	bool operator()(int a, int b) const { return m_lv->OnItemSort(m_lv->m_vRows.Get(a), m_lv->m_vRows.Get(b)) < 0; }
+};
+
+// Sorts the rows, their hashes and selection states follow
+void SWS_ListView::SortVirtual()
+{
+	const int n = m_vRows.GetSize();
+	if (n < 2)
+		return;
+
+	std::vector<int> order(n);
+	for (int i = 0; i < n; i++)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), VirtualRowCompare(this));
+
+	WDL_PtrList<SWS_ListItem> rows;
+	WDL_TypedBuf<unsigned int> hashes;
+	hashes.Resize(m_vHashes.GetSize(), false);
+	WDL_TypedBuf<int> states;
+	states.Resize(n, false);
+	for (int i = 0; i < n; i++)
+	{
+		rows.Add(m_vRows.Get(order[i]));
+		if (m_vHashStride)
+			memcpy(hashes.Get() + i * m_vHashStride, m_vHashes.Get() + order[i] * m_vHashStride, m_vHashStride * sizeof(unsigned int));
+		states.Get()[i] = ListView_GetItemState(m_hwndList, i, LVIS_SELECTED | LVIS_FOCUSED);
+	}
+
+	m_vRows.Empty();
+	m_vRowIdx.DeleteAll();
+	for (int i = 0; i < n; i++)
+	{
+		m_vRows.Add(rows.Get(i));
+		m_vRowIdx.AddUnsorted((INT_PTR)rows.Get(i), i);
+	}
+	m_vRowIdx.Resort();
+	memcpy(m_vHashes.Get(), hashes.Get(), hashes.GetSize() * sizeof(unsigned int));
+
+	bool bDisableUpdates = m_bDisableUpdates;
+	m_bDisableUpdates = true;
+	for (int i = 0; i < n; i++)
+		if (states.Get()[order[i]] != states.Get()[i])
+			ListView_SetItemState(m_hwndList, i, states.Get()[order[i]], LVIS_SELECTED | LVIS_FOCUSED);
+	m_bDisableUpdates = bDisableUpdates;
+
+	InvalidateRect(m_hwndList, NULL, FALSE);
+}
+
+void SWS_ListView::ResetVirtual()
+{
+	m_vRows.Empty();
+	m_vRowIdx.DeleteAll();
+	m_vHashes.Resize(0, false);
+	m_vHashStride = 0;
+}
+
 // Return TRUE if a the column header was clicked
 bool SWS_ListView::DoColumnMenu(int x, int y)
 {
@@ -1392,6 +1764,7 @@ bool SWS_ListView::DoColumnMenu(int x, int y)
 			}
 
 			ListView_DeleteAllItems(m_hwndList);
+			ResetVirtual();
 			while(ListView_DeleteColumn(m_hwndList, 0));
 			ShowColumns();
 			Update();
@@ -1441,26 +1814,7 @@ SWS_ListItem* SWS_ListView::GetHitItem(int x, int y, int* iCol)
 void SWS_ListView::EditListItem(SWS_ListItem* item, int iCol)
 {
 	// Convert to index and call edit
-#ifdef _WIN32
-	LVFINDINFO fi;
-	fi.flags = LVFI_PARAM;
-	fi.lParam = (LPARAM)item;
-	int iItem = ListView_FindItem(m_hwndList, -1, &fi);
-#else
-	int iItem = -1;
-	LVITEM li;
-	li.mask = LVIF_PARAM;
-	for (int i = 0; i < ListView_GetItemCount(m_hwndList); i++)
-	{
-		li.iItem = i;
-		ListView_GetItem(m_hwndList, &li);
-		if ((SWS_ListItem*)li.lParam == item)
-		{
-			iItem = i;
-			break;
-		}
-	}
-#endif
+	int iItem = FindListItem(item);
 	if (iItem >= 0)
 		EditListItem(iItem, iCol);
 }
@@ -1532,11 +1886,19 @@ bool SWS_ListView::EditListItemEnd(bool bSave, bool bResort)
 			{
 				SetItemText(item, editedCol, newStr);
 				GetItemText(item, editedCol, newStr, sizeof(newStr));
-				ListView_SetItemText(m_hwndList, m_iEditingItem, DataToDisplayCol(editedCol), newStr);
+				if (m_bVirtual)
+					ListView_RedrawItems(m_hwndList, m_iEditingItem, m_iEditingItem);
+				else
+					ListView_SetItemText(m_hwndList, m_iEditingItem, DataToDisplayCol(editedCol), newStr);
 				updated = true;
 			}
 			if (bResort)
-				ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
+			{
+				if (m_bVirtual)
+					SortVirtual();
+				else
+					ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
+			}
 			// TODO resort? Just call update?
 			// Update is likely called when SetItemText is called too...
 		}
@@ -1598,7 +1960,10 @@ void SWS_ListView::ShowColumns()
 
 void SWS_ListView::Sort()
 {
-	ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
+	if (m_bVirtual)
+		SortVirtual();
+	else
+		ListView_SortItems(m_hwndList, sListCompare, (LPARAM)this);
 	int iCol = abs(m_iSortCol) - 1;
 	iCol = DataToDisplayCol(iCol) + 1;
 	if (m_iSortCol < 0)
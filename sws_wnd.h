@@ -106,6 +106,7 @@ public:
 	HWND GetHWND() { return m_hwndList; }
 	HWND GetEditHWND() { return m_hwndEdit; }
 	virtual bool HideGridLines() {return false;}
+	bool IsVirtual() { return m_bVirtual; } // i.e. the listview has the LVS_OWNERDATA style
 
 protected:
 	void EditListItem(int iIndex, int iCol);
@@ -149,6 +150,11 @@ protected:
 private:
 	void ShowColumns();
 	void Sort();
+	void UpdateVirtual(bool bRowsOnly = false);
+	void SortVirtual();
+	void ResetVirtual();
+	int FindListItem(SWS_ListItem* item);
+	struct VirtualRowCompare;
 
 #ifndef _WIN32
 	int m_iClickedCol;
@@ -161,6 +167,15 @@ private:
 	HWND m_hwndEdit;
 	SWS_LVColumn* m_pDefaultCols;
 	const char* m_cINIKey;
+
+	// Virtual mode: the rows are owned here and cell texts are only pulled when displayed
+	bool m_bVirtual;
+	WDL_PtrList<SWS_ListItem> m_vRows;
+	WDL_PtrKeyedArray<int> m_vRowIdx;		// item -> row
+	WDL_TypedBuf<unsigned int> m_vHashes;	// per row: sort column + displayed cells hashes, 0 = unknown
+	int m_vHashStride;
+	int m_vSortCol;
+	bool m_bVirtualUpdating;
 };
 
 #pragma pack(push, 4)
@@ -0,0 +1,480 @@
+/******************************************************************************
+/ tests/BR_GridSnapshot_test.cpp
+/
+/ Compares BR_GridSnapshot against the grid division functions it replaced
+/ (copied below as they were before the snapshot) on randomly generated tempo
+/ maps. Both run on the same mock of REAPER's TimeMap API so results must match
+/ exactly.
+/
+******************************************************************************/
+#include "stdafx.h"
+#include <unistd.h>
+#include "../Breeder/BR_GridSnapshot.h"
+
+/******************************************************************************
+* Mock tempo map                                                              *
+******************************************************************************/
+struct ReaProject;
+
+struct MockMeasure { double qn; int num, den; };
+struct MockTempo   { double qn, bpm, time; };
+struct MockMarker  { double time; int measure; double beat, bpm; int num, den; };
+
+static vector<MockMeasure> g_measures;  // measures after the last one keep its time signature
+static vector<int>         g_fullBeats; // full beat count at start of g_measures[i], one more entry at the end
+static vector<MockTempo>   g_tempos;    // first one at qn 0, constant tempo until next one
+static vector<MockMarker>  g_markers;
+static double              g_gridDiv = 1;
+static unsigned int        g_seed    = 1;
+
+static unsigned int Rand ()          { g_seed = g_seed * 1103515245 + 12345; return (g_seed >> 16) & 0x7FFF; }
+static int          RandInt (int n)  { return (int)(Rand() % n); }
+static double       RandDouble ()    { return Rand() / 32768.0; }
+
+static double QNToTimeMock (double qn)
+{
+	int i = (int)g_tempos.size() - 1;
+	while (i > 0 && g_tempos[i].qn > qn) --i;
+	return g_tempos[i].time + (qn - g_tempos[i].qn) * 60 / g_tempos[i].bpm;
+}
+
+static double TimeToQNMock (double time)
+{
+	int i = (int)g_tempos.size() - 1;
+	while (i > 0 && g_tempos[i].time > time) --i;
+	return g_tempos[i].qn + (time - g_tempos[i].time) * g_tempos[i].bpm / 60;
+}
+
+static void MeasureSig (int m, int* num, int* den)
+{
+	const MockMeasure& measure = (m < 0) ? g_measures.front() : (m >= (int)g_measures.size()) ? g_measures.back() : g_measures[m];
+	*num = measure.num;
+	*den = measure.den;
+}
+
+static double MeasureLenQN (int m)
+{
+	int num, den; MeasureSig(m, &num, &den);
+	return num * 4.0 / den;
+}
+
+static double MeasureStartQN (int m)
+{
+	int count = (int)g_measures.size();
+	if (m < 0)      return m * MeasureLenQN(m);
+	if (m >= count) return g_measures.back().qn + (m - count + 1) * MeasureLenQN(m);
+	return g_measures[m].qn;
+}
+
+static int MeasureFullBeats (int m)
+{
+	int count = (int)g_measures.size();
+	int num, den; MeasureSig(m, &num, &den);
+	if (m < 0)      return m * num;
+	if (m >= count) return g_fullBeats[count] + (m - count) * num;
+	return g_fullBeats[m];
+}
+
+static int MeasureFromQN (double qn)
+{
+	int m = (qn < 0) ? (int)floor(qn / MeasureLenQN(-1)) : 0;
+	while (MeasureStartQN(m + 1) <= qn + 1E-9) ++m; // snap to measure start like REAPER, otherwise rounding errors create grid lines that never advance
+	return m;
+}
+
+double TimeMap2_timeToBeats (ReaProject*, double tpos, int* measures, int* cml, double* fullbeats, int* cdenom)
+{
+	double qn = TimeToQNMock(tpos);
+	int m = MeasureFromQN(qn);
+	int num, den; MeasureSig(m, &num, &den);
+
+	double beats = (qn - MeasureStartQN(m)) * den / 4;
+	double full  = MeasureFullBeats(m) + beats;
+	if (measures)  *measures  = m;
+	if (cml)       *cml       = num;
+	if (cdenom)    *cdenom    = den;
+	if (fullbeats) *fullbeats = full;
+	return (measures) ? beats : full; // same as REAPER: beats since measure start if measures is requested
+}
+
+double TimeMap2_beatsToTime (ReaProject*, double tpos, const int* measuresIn)
+{
+	int m = (measuresIn) ? *measuresIn : 0;
+	double beats = tpos;
+	int num, den;
+	while (MeasureSig(m, &num, &den), beats >= num) { beats -= num; ++m; }
+	while (beats < 0) { --m; MeasureSig(m, &num, &den); beats += num; }
+	return QNToTimeMock(MeasureStartQN(m) + beats * 4 / den);
+}
+
+double TimeMap_timeToQN (double tpos)                   { return TimeToQNMock(tpos); }
+double TimeMap_QNToTime (double qn)                     { return QNToTimeMock(qn); }
+double TimeMap_timeToQN_abs (ReaProject*, double tpos)  { return TimeToQNMock(tpos); }
+double TimeMap_QNToTime_abs (ReaProject*, double qn)    { return QNToTimeMock(qn); }
+int    CountTempoTimeSigMarkers (ReaProject*)           { return (int)g_markers.size(); }
+
+bool GetTempoTimeSigMarker (ReaProject*, int id, double* timepos, int* measurepos, double* beatpos, double* bpm, int* num, int* den, bool* linear)
+{
+	if (id < 0 || id >= (int)g_markers.size())
+		return false;
+	const MockMarker& marker = g_markers[id];
+	if (timepos)    *timepos    = marker.time;
+	if (measurepos) *measurepos = marker.measure;
+	if (beatpos)    *beatpos    = marker.beat;
+	if (bpm)        *bpm        = marker.bpm;
+	if (num)        *num        = marker.num;
+	if (den)        *den        = marker.den;
+	if (linear)     *linear     = false;
+	return true;
+}
+
+static void BuildRandomTempoMap ()
+{
+	static const int dens[] = {2, 4, 8, 16};
+	const int measureCount = 16 + RandInt(48);
+
+	g_measures.clear(); g_fullBeats.clear(); g_tempos.clear(); g_markers.clear();
+
+	// Time signatures first, tempo markers sit on time signature changes and randomly in between
+	vector<pair<double,pair<int,int> > > markerQN; // qn, time signature (0 if tempo only)
+	MockMeasure measure = {0, 4, 4};
+	g_fullBeats.push_back(0);
+	for (int i = 0; i < measureCount; ++i)
+	{
+		bool sigChange = (i == 0) ? (RandInt(2) == 0) : (RandInt(6) == 0);
+		if (sigChange)
+		{
+			measure.num = 1 + RandInt(13);
+			measure.den = dens[RandInt(4)];
+			markerQN.push_back(make_pair(measure.qn, make_pair(measure.num, measure.den)));
+		}
+		g_measures.push_back(measure);
+		g_fullBeats.push_back(g_fullBeats.back() + measure.num);
+
+		double len = measure.num * 4.0 / measure.den;
+		if (RandInt(4) == 0)
+			markerQN.push_back(make_pair(measure.qn + len * (0.05 + 0.9 * RandDouble()), make_pair(0, 0)));
+		measure.qn += len;
+	}
+	sort(markerQN.begin(), markerQN.end());
+
+	MockTempo tempo = {0, 120, 0};
+	g_tempos.push_back(tempo);
+	for (size_t i = 0; i < markerQN.size(); ++i)
+	{
+		MockTempo next = {markerQN[i].first, 40 + RandInt(260) + RandInt(100) / 100.0, QNToTimeMock(markerQN[i].first)};
+		if (next.qn == 0) g_tempos[0] = next;
+		else              g_tempos.push_back(next);
+
+		int m = MeasureFromQN(next.qn);
+		int num, den; MeasureSig(m, &num, &den);
+		MockMarker marker = {next.time, m, (next.qn - MeasureStartQN(m)) * den / 4, next.bpm, markerQN[i].second.first, markerQN[i].second.second};
+		g_markers.push_back(marker);
+	}
+}
+
+/******************************************************************************
+* REAPER/BR functions used by the old implementation                          *
+******************************************************************************/
+const double SNM_FUDGE_FACTOR = 0.0000000001;
+template <typename T> void GetConfig (const char*, T& val) { val = 0; } // only "projgridframe", frame grid isn't tested
+template <typename T> bool CheckBounds (T val, T min, T max) {if (min > max) swap(min, max); if (val < min)  return false; if (val > max)  return false; return true;}
+template <typename T> T    IsEqual (T a, T b, T epsilon) {epsilon = abs(epsilon); return CheckBounds(a, b - epsilon, b + epsilon);}
+double GetGridDivSafe () { return g_gridDiv; }
+double GetHZoomLevel ()  { return 100; }
+void GetTimeInfoFromPosition (double, int*, int*, int*, int*) { abort(); }
+double GetPositionFromTimeInfo (int, int, int, int)          { abort(); return 0; }
+
+int BaselineFindPreviousTempoMarker (double position)
+{
+	int first = 0;
+	int last = CountTempoTimeSigMarkers(NULL);
+
+	while (first != last)
+	{
+		int mid = (first + last) / 2;
+		double currentPos; GetTempoTimeSigMarker(NULL, mid, &currentPos, NULL, NULL, NULL, NULL, NULL, NULL);
+
+		if (currentPos < position) first = mid + 1;
+		else                       last  = mid;
+
+	}
+	return first - 1;
+}
+
+double BaselineGetNextGridDiv (double position)
+{
+	/* This got a tiny bit complicated, but we're trying to replicate        *
+	*  REAPER behavior as closely as possible...I guess the ultimate test    *
+	*  would be inserting a bunch of really strange time signatures coupled  *
+	*  with possibly even stranger grid divisions, things any sane person    *
+	*  would never use - like 11/7 with grid division of 2/13...haha. As it  *
+	*  stands now, at REAPER v4.7, this function handles it all              */
+
+	if (position < 0)
+		return 0;
+
+	double nextGridPosition = position;
+
+	int projgridframe; GetConfig("projgridframe", projgridframe);
+	if (projgridframe > 0)
+	{
+		int hours, minutes, seconds, frames;
+		GetTimeInfoFromPosition(position, &hours, &minutes, &seconds, &frames);
+		++frames;
+
+		nextGridPosition = GetPositionFromTimeInfo(hours, minutes, seconds, frames);
+	}
+	else
+	{
+		// Grid dividing starts again from the measure in which tempo marker is so find location of first measure grid (obvious if grid division spans more measures)
+		int gridDivStartTempo = BaselineFindPreviousTempoMarker(position);
+		double gridDivStart;
+		if (gridDivStartTempo >= 0)
+		{
+			if (GetTempoTimeSigMarker(NULL, gridDivStartTempo + 1, &gridDivStart, NULL, NULL, NULL, NULL, NULL, NULL))
+			{
+				if (gridDivStart > position)
+					GetTempoTimeSigMarker(NULL, gridDivStartTempo, &gridDivStart, NULL, NULL, NULL, NULL, NULL, NULL);
+				else
+					gridDivStartTempo += 1;
+			}
+			else
+				GetTempoTimeSigMarker(NULL, gridDivStartTempo, &gridDivStart, NULL, NULL, NULL, NULL, NULL, NULL);
+		}
+		else
+		{
+			gridDivStart = 0;
+			gridDivStartTempo = 0; // if position is right at project start this would be -1 even if first tempo marker exists
+		}
+
+		// Get grid division translated into current time signature
+		int gridDivStartMeasure, num, den;
+		TimeMap2_timeToBeats(0, gridDivStart, &gridDivStartMeasure, &num, NULL, &den);
+		double gridDiv = GetGridDivSafe();
+		gridDiv = (den*gridDiv) / 4;
+
+		// How much measures must pass for grid diving to start anew? (again, obvious when grid division spans more measures)
+		int measureStep = (int)(gridDiv/num);
+		if (measureStep == 0) measureStep = 1;
+
+		// Find closest measure to our position, where grid diving starts again
+		int positionMeasure;
+		TimeMap2_timeToBeats(0, position, &positionMeasure, NULL, NULL, NULL);
+		gridDivStartMeasure += (int)((positionMeasure - gridDivStartMeasure) / measureStep) * measureStep;
+		gridDivStart = TimeMap2_beatsToTime(0, 0, &gridDivStartMeasure);
+
+		// Finally find next grid position (different cases for measures and beats)
+		if (gridDiv > num)
+		{
+			int gridDivEndMeasure = gridDivStartMeasure + measureStep;
+			double gridDivEnd = TimeMap2_beatsToTime(0, 0, &gridDivEndMeasure);
+
+			// Same as before, existing tempo markers can move end measure grid (where our next grid should be) so find if that's the case
+			if (measureStep > 1)
+			{
+				double tempoPosition;
+				while (GetTempoTimeSigMarker(NULL, ++gridDivStartTempo, &tempoPosition, NULL, NULL, NULL, NULL, NULL, NULL) && tempoPosition <= gridDivEnd)
+				{
+					int currentMeasure;
+					TimeMap2_timeToBeats(0, tempoPosition, &currentMeasure, NULL, NULL, NULL);
+
+					gridDivEndMeasure = currentMeasure + ((currentMeasure == positionMeasure) ? (measureStep) : (0));
+					gridDivEnd = TimeMap2_beatsToTime(0, 0, &gridDivEndMeasure);
+				}
+			}
+
+			nextGridPosition = TimeMap2_beatsToTime(0, 0, &gridDivEndMeasure);
+		}
+		else
+		{
+			double positionBeats = TimeMap2_timeToBeats(0, position, NULL, NULL, NULL, NULL) - TimeMap2_timeToBeats(0, gridDivStart, NULL, NULL, NULL, NULL);
+			//double nextGridBeats = ((int)(positionBeats / gridDiv) + 1) * gridDiv;
+			double nextGridBeats = (int)((positionBeats + gridDiv) / gridDiv) * gridDiv;
+			while (abs(nextGridBeats - positionBeats) < 1E-6) nextGridBeats += gridDiv; // rounding errors, yuck...
+
+			nextGridPosition = TimeMap2_beatsToTime(0, nextGridBeats, &gridDivStartMeasure);
+
+			// Check it didn't pass over into next measure
+			int gridDivEndMeasure = gridDivStartMeasure + measureStep;
+			double gridDivEnd     = TimeMap2_beatsToTime(0, 0, &gridDivEndMeasure);
+			if (nextGridPosition > gridDivEnd)
+				nextGridPosition = gridDivEnd;
+		}
+
+		// Not so perfect fix for this issue: http://forum.cockos.com/project.php?issueid=5263
+		if (nextGridPosition < position)
+		{
+			double gridDiv = GetGridDivSafe();
+
+			double tempoPosition, beat; int measure; GetTempoTimeSigMarker(NULL, gridDivStartTempo, &tempoPosition, &measure, &beat, NULL, NULL, NULL, NULL);
+			double offset =  gridDiv - fmod(TimeMap_timeToQN(TimeMap2_beatsToTime(0, 0, &measure)), gridDiv);
+
+			double gridLn = TimeMap_timeToQN(tempoPosition);
+			gridLn = TimeMap_QNToTime(gridLn - offset - fmod(gridLn, gridDiv));
+			while (gridLn < position + (MIN_GRID_DIST/2))
+				gridLn = TimeMap_QNToTime(TimeMap_timeToQN(gridLn) + gridDiv);
+
+			nextGridPosition = gridLn;
+		}
+	}
+
+	return nextGridPosition;
+}
+
+double BaselineGetPrevGridDiv (double position)
+{
+	if (position <= 0)
+		return 0;
+
+	double prevGridDivPos = position;
+
+	int projgridframe; GetConfig("projgridframe", projgridframe);
+	if (projgridframe > 0)
+	{
+		int hours, minutes, seconds, frames;
+		GetTimeInfoFromPosition(position, &hours, &minutes, &seconds, &frames);
+
+		GetHZoomLevel();
+		double currentFramePos = GetPositionFromTimeInfo(hours, minutes, seconds, frames);
+		if (IsEqual(currentFramePos, position, SNM_FUDGE_FACTOR))
+		{
+			--frames;
+			prevGridDivPos = GetPositionFromTimeInfo(hours, minutes, seconds, frames);
+		}
+		else
+		{
+			prevGridDivPos = currentFramePos;
+		}
+	}
+	else
+	{
+		// GetNextGridDiv is complicated enough, so let's not reinvent it here but reuse it (while less efficient than the real deal, it's really not that slower since GetNextGridDiv() is quite optimized)
+		prevGridDivPos = TimeMap_QNToTime_abs(NULL, TimeMap_timeToQN_abs(NULL, position) - 1.5*GetGridDivSafe());
+		while (true)
+		{
+			double tmp = BaselineGetNextGridDiv(prevGridDivPos);
+			if (tmp >= position)
+				break;
+			else
+				prevGridDivPos = tmp;
+		}
+	}
+	return prevGridDivPos;
+}
+
+
+/******************************************************************************
+* Snapshot project access on top of the mock                                 *
+******************************************************************************/
+BR_GridSnapshot::BR_GridSnapshot () :
+m_gridFrame  (0),
+m_gridDiv    (GetGridDivSafe()),
+m_tempoCount (CountTempoTimeSigMarkers(NULL))
+{
+	m_tempoMarkers.resize(m_tempoCount);
+}
+
+double BR_GridSnapshot::GetNextFrame (double) { abort(); return 0; }
+double BR_GridSnapshot::GetPrevFrame (double) { abort(); return 0; }
+
+void BR_GridSnapshot::ReadTempoMarker (int id, double* position, int* measure)
+{
+	GetTempoTimeSigMarker(NULL, id, position, measure, NULL, NULL, NULL, NULL, NULL);
+}
+
+void BR_GridSnapshot::ReadTimeSig (double position, int* measure, int* num, int* den)
+{
+	TimeMap2_timeToBeats(0, position, measure, num, NULL, den);
+}
+
+int BR_GridSnapshot::ReadMeasure (double position)
+{
+	int measure;
+	TimeMap2_timeToBeats(0, position, &measure, NULL, NULL, NULL);
+	return measure;
+}
+
+double BR_GridSnapshot::ReadFullBeats (double position)
+{
+	return TimeMap2_timeToBeats(0, position, NULL, NULL, NULL, NULL);
+}
+
+double BR_GridSnapshot::ReadTime (double beats, int measure)
+{
+	return TimeMap2_beatsToTime(0, beats, &measure);
+}
+
+double BR_GridSnapshot::TimeToQN (double position, bool abs)
+{
+	return (abs) ? (TimeMap_timeToQN_abs(NULL, position)) : (TimeMap_timeToQN(position));
+}
+
+double BR_GridSnapshot::QNToTime (double qn, bool abs)
+{
+	return (abs) ? (TimeMap_QNToTime_abs(NULL, qn)) : (TimeMap_QNToTime(qn));
+}
+
+/******************************************************************************
+* Test                                                                        *
+******************************************************************************/
+static int g_checks   = 0;
+static int g_failures = 0;
+
+static void Check (const char* what, int map, double position, double expected, double actual)
+{
+	++g_checks;
+	if (expected != actual && !(expected != expected && actual != actual))
+	{
+		if (++g_failures <= 20)
+			printf("FAIL map %d, grid %g: %s(%.12f) expected %.12f, got %.12f\n", map, g_gridDiv, what, position, expected, actual);
+		fflush(stdout);
+	}
+}
+
+int main ()
+{
+	static const double gridDivs[] = {1.0/16, 1.0/8, 1.0/6, 1.0/4, 1.0/3, 1.0/2, 2.0/3, 3.0/4, 1, 1.5, 2, 3, 4, 6, 8, 8.0/13, 16, 32};
+	alarm(60); // a broken GetNextGridDiv can leave GetPrevGridDiv looping forever, fail instead of hanging
+
+	for (int map = 0; map < 300; ++map)
+	{
+		BuildRandomTempoMap();
+		double end = QNToTimeMock(MeasureStartQN((int)g_measures.size() + 2));
+
+		for (size_t d = 0; d < sizeof(gridDivs) / sizeof(gridDivs[0]); ++d)
+		{
+			g_gridDiv = gridDivs[d];
+			BR_GridSnapshot snapshot;
+
+			// Positions of interest: random, tempo markers, measure starts and grid divisions themselves
+			vector<double> positions;
+			positions.push_back(0);
+			for (int i = 0; i < 40; ++i)                positions.push_back(end * RandDouble());
+			for (size_t i = 0; i < g_markers.size(); ++i) positions.push_back(g_markers[i].time);
+			for (int m = 0; m < (int)g_measures.size(); m += 3) positions.push_back(QNToTimeMock(MeasureStartQN(m)));
+
+			for (size_t i = 0; i < positions.size(); ++i)
+			{
+				double position = positions[i];
+				Check("GetNextGridDiv", map, position, BaselineGetNextGridDiv(position), snapshot.GetNextGridDiv(position));
+				Check("GetPrevGridDiv", map, position, BaselineGetPrevGridDiv(position), snapshot.GetPrevGridDiv(position));
+			}
+
+			// Walk the grid like the envelope/tempo actions do
+			double expected = 0, actual = 0;
+			for (int i = 0; i < 64 && expected < end; ++i)
+			{
+				double nextExpected = BaselineGetNextGridDiv(expected);
+				double nextActual   = snapshot.GetNextGridDiv(actual);
+				Check("GetNextGridDiv (walk)", map, expected, nextExpected, nextActual);
+				Check("GetPrevGridDiv (walk)", map, nextExpected, BaselineGetPrevGridDiv(nextExpected), snapshot.GetPrevGridDiv(nextActual));
+				expected = nextExpected;
+				actual   = nextActual;
+			}
+		}
+	}
+
+	printf("BR_GridSnapshot: %d checks, %d failures\n", g_checks, g_failures);
+	return (g_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,287 @@
+/******************************************************************************
+/ tests/BR_TcpLayout_test.cpp
+/
+/ Compares BR_TcpLayout against the linear walks it replaced (copied below as
+/ they were in GetTrackHeight(), BR_MouseUtil and Zoom.cpp) on random track
+/ heights, checks when the layout gets rebuilt and times both at 1k and 5k
+/ tracks.
+/
+******************************************************************************/
+#include "stdafx.h"
+#include <time.h>
+#include "../Breeder/BR_TcpLayout.h"
+
+/******************************************************************************
+* Mock tracks                                                                 *
+******************************************************************************/
+static vector<int>  g_heights;          // I_WNDH, 0 is master
+static bool         g_masterVis = true;
+static int          g_masterGap = 5;
+static int          g_stateCount = 0;
+static int          g_scrollMax  = 0;
+static unsigned int g_time       = 0;
+static unsigned int g_seed       = 1;
+
+static unsigned int Rand ()          { g_seed = g_seed * 1103515245 + 12345; return (g_seed >> 16) & 0x7FFF; }
+static int          RandInt (int n)  { return (int)(Rand() % n); }
+
+// Stands for GetSetMediaTrackInfo(CSurf_TrackFromID(id, false), "I_WNDH", NULL), which
+// is a lot more expensive in REAPER so timings below favor the linear walks
+__attribute__((noinline)) static int MockWndH (int id)
+{
+	return (id >= 0 && id < (int)g_heights.size()) ? g_heights[id] : 0;
+}
+
+static void BuildRandomTracks (int count, bool allowEmpty)
+{
+	g_heights.resize(count + 1);
+	g_masterVis = RandInt(4) != 0;
+	g_masterGap = RandInt(8);
+	for (int i = 0; i <= count; ++i)
+	{
+		int height = 24 + RandInt(200);
+		if (allowEmpty && i > 0 && RandInt(10) == 0) height = 0; // hidden in TCP (visible master can't be empty, see TcpVis())
+		if (i == 0 && !g_masterVis)         height = 0;
+		g_heights[i] = height;
+	}
+	++g_stateCount;
+}
+
+void BR_TcpLayout::ReadSignature (Signature* signature)
+{
+	signature->proj       = NULL;
+	signature->stateCount = g_stateCount;
+	signature->trackCount = (int)g_heights.size() - 1;
+	signature->vZoom      = 0;
+	signature->showMaster = 1;
+	signature->scrollMax  = g_scrollMax;
+}
+
+unsigned int BR_TcpLayout::ReadTime ()     { return g_time; }
+int BR_TcpLayout::ReadWndH (int id)        { return MockWndH(id); }
+bool BR_TcpLayout::ReadMasterVisible ()    { return g_masterVis; }
+int BR_TcpLayout::ReadMasterGap ()         { return g_masterGap; }
+
+/******************************************************************************
+* Baseline (linear walks)                                                     *
+******************************************************************************/
+// GetTrackHeight() offsetY of a non-master track
+static int BaselineTrackOffset (int id)
+{
+	int offset = 0;
+	for (int i = 1; i < id; ++i)
+		offset += MockWndH(i);
+	if (g_masterVis)
+		offset += MockWndH(0) + g_masterGap;
+	return offset;
+}
+
+// BR_MouseUtil's GetTrackAreaFromY()
+static int BaselineTrackAreaFromY (int y, int* offset)
+{
+	int id = -1;
+	int trackEnd = 0;
+	int trackOffset = 0;
+	for (int i = 0; i < (int)g_heights.size(); ++i)
+	{
+		int height = MockWndH(i);
+		if (i == 0 && g_masterVis)
+			height += g_masterGap;
+		trackEnd += height;
+
+		if (y >= trackOffset && y < trackEnd)
+		{
+			id = i;
+			break;
+		}
+		trackOffset += height;
+	}
+	*offset = (id >= 0) ? trackOffset : 0;
+	return id;
+}
+
+// Zoom.cpp's TrackAtPoint() (scroll position 0)
+static int BaselineTrackAtPoint (int y, int* vPos)
+{
+	int iVPos = 0;
+	int iTrack = 0;
+	while (iTrack < (int)g_heights.size())
+	{
+		int iTrackH = MockWndH(iTrack);
+		if (iVPos + iTrackH > y)
+			break;
+		if (iTrack == 0 && g_masterVis && iTrackH != 0)
+			iTrackH += g_masterGap;
+		iVPos += iTrackH;
+		iTrack++;
+	}
+	*vPos = iVPos;
+	return (iTrack < (int)g_heights.size()) ? iTrack : -1;
+}
+
+/******************************************************************************
+* Test                                                                        *
+******************************************************************************/
+static int g_checks   = 0;
+static int g_failures = 0;
+
+static void Check (const char* what, int arg, int expected, int actual)
+{
+	++g_checks;
+	if (expected != actual)
+	{
+		if (++g_failures <= 20)
+			printf("FAIL %d tracks: %s(%d) expected %d, got %d\n", (int)g_heights.size() - 1, what, arg, expected, actual);
+		fflush(stdout);
+	}
+}
+
+static void CheckLayout ()
+{
+	BR_TcpLayout* layout = BR_TcpLayout::Get();
+	Check("CountTracks", 0, (int)g_heights.size(), layout->CountTracks());
+
+	for (int id = 1; id < (int)g_heights.size(); ++id)
+		Check("GetTrackHeight offset", id, BaselineTrackOffset(id), layout->GetOffset(id) - (layout->IsMasterVisible() ? 0 : layout->GetWndH(0)));
+
+	int total = BaselineTrackOffset((int)g_heights.size()) + (g_masterVis ? 0 : MockWndH(0));
+	for (int y = -2; y < total + 300; y += 1 + RandInt(7))
+	{
+		int offset;
+		int id = BaselineTrackAreaFromY(y, &offset);
+		int actual = layout->GetIdFromY(y);
+		Check("GetIdFromY", y, id, actual);
+		Check("GetIdFromY offset", y, offset, (actual >= 0) ? layout->GetOffset(actual) : 0);
+
+		int vPos;
+		id = BaselineTrackAtPoint(y, &vPos);
+		actual = layout->GetIdFromWndY(y);
+		Check("GetIdFromWndY", y, id, actual);
+		Check("GetIdFromWndY offset", y, vPos, (actual >= 0) ? layout->GetOffset(actual) : layout->GetTotalHeight());
+	}
+}
+
+static void TestRandomLayouts ()
+{
+	for (int i = 0; i < 300; ++i)
+	{
+		BuildRandomTracks(RandInt(60), i % 2 == 0);
+		CheckLayout();
+	}
+}
+
+static void TestRebuilds ()
+{
+	BuildRandomTracks(100, false);
+	BR_TcpLayout::Get();
+	int builds = BR_TcpLayout::GetBuildCount();
+
+	// Nothing changed: reused
+	for (int i = 0; i < 10; ++i)
+		BR_TcpLayout::Get();
+	Check("no change rebuilds", 0, builds, BR_TcpLayout::GetBuildCount());
+
+	// Height set by some SWS action, which invalidates
+	g_heights[50] += 30;
+	BR_TcpLayout::Invalidate();
+	CheckLayout();
+	Check("Invalidate rebuilds", 0, builds + 1, BR_TcpLayout::GetBuildCount());
+
+	// Height changed outside SWS (i.e. by dragging): the scroll range follows total height...
+	g_heights[20] += 30;
+	g_scrollMax += 30;
+	CheckLayout();
+	Check("signature rebuilds", 0, builds + 2, BR_TcpLayout::GetBuildCount());
+
+	// ...unless it's clamped to the page, then the TTL catches it
+	g_heights[20] -= 30;
+	Check("stale within TTL", 20, g_heights[20] + 30, BR_TcpLayout::Get()->GetWndH(20));
+	g_time += 1000;
+	CheckLayout();
+	Check("TTL rebuilds", 0, builds + 3, BR_TcpLayout::GetBuildCount());
+
+	// Track list changes
+	g_heights.push_back(100);
+	CheckLayout();
+	Check("track count rebuilds", 0, builds + 4, BR_TcpLayout::GetBuildCount());
+}
+
+/******************************************************************************
+* Benchmark                                                                   *
+******************************************************************************/
+static double ElapsedNs (clock_t start, int queries)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / queries;
+}
+
+static void Benchmark (int count)
+{
+	const int queries = 20000;
+	BuildRandomTracks(count, false);
+	g_masterVis = true;
+	BR_TcpLayout::Invalidate();
+
+	int total = BR_TcpLayout::Get()->GetTotalHeight();
+	vector<int> ids(queries), ys(queries);
+	for (int i = 0; i < queries; ++i)
+	{
+		ids[i] = 1 + RandInt(count);
+		ys[i]  = (int)((double)Rand() / 32768 * total);
+	}
+
+	int builds = BR_TcpLayout::GetBuildCount();
+	long long expected = 0, actual = 0;
+
+	clock_t start = clock();
+	for (int i = 0; i < queries; ++i)
+		expected += BaselineTrackOffset(ids[i]);
+	double offsetLinear = ElapsedNs(start, queries);
+
+	start = clock();
+	for (int i = 0; i < queries; ++i)
+		actual += BR_TcpLayout::Get()->GetOffset(ids[i]);
+	double offsetCached = ElapsedNs(start, queries);
+	Check("benchmark offsets", count, (int)(expected % 1000000007), (int)(actual % 1000000007));
+
+	start = clock();
+	for (int i = 0; i < queries; ++i)
+	{
+		int offset;
+		expected += BaselineTrackAreaFromY(ys[i], &offset) + offset;
+	}
+	double hitLinear = ElapsedNs(start, queries);
+
+	start = clock();
+	for (int i = 0; i < queries; ++i)
+	{
+		BR_TcpLayout* layout = BR_TcpLayout::Get();
+		int id = layout->GetIdFromY(ys[i]);
+		actual += id + ((id >= 0) ? layout->GetOffset(id) : 0);
+	}
+	double hitCached = ElapsedNs(start, queries);
+	Check("benchmark hit-testing", count, (int)(expected % 1000000007), (int)(actual % 1000000007));
+	Check("benchmark rebuilds", count, builds, BR_TcpLayout::GetBuildCount());
+
+	// Worst case: a height setter runs before every query
+	start = clock();
+	for (int i = 0; i < queries; ++i)
+	{
+		BR_TcpLayout::Invalidate();
+		actual += BR_TcpLayout::Get()->GetOffset(ids[i]);
+	}
+	double offsetRebuilt = ElapsedNs(start, queries);
+
+	printf("BR_TcpLayout %d tracks (ns/query): offset linear %.0f, cached %.0f, rebuilt each time %.0f | y -> track linear %.0f, cached %.0f\n",
+		count, offsetLinear, offsetCached, offsetRebuilt, hitLinear, hitCached);
+}
+
+int main ()
+{
+	TestRandomLayouts();
+	TestRebuilds();
+	Benchmark(1000);
+	Benchmark(5000);
+
+	printf("BR_TcpLayout: %d checks, %d failures\n", g_checks, g_failures);
+	return (g_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,343 @@
+/******************************************************************************
+/ tests/SnM_ChunkParserPatcher_test.cpp
+/
+/ The line index of SNM_ChunkParserPatcher (ParsePatchIndexed()) checked
+/ against the line by line parser (ParsePatchCore()): both are run on the same
+/ random RPP-like chunks with the same sequences of built-in getter/setter
+/ calls and must return the same values and build the same chunks.
+/
+******************************************************************************/
+#include "stdafx.h"
+#include "wdl_standins.h"
+
+// REAPER/SWS stubs (only used when attached to a reaThing*)
+int g_disable_chunk_guid_filtering = 0;
+static const char* SWS_GetSetObjectState (void* obj, WDL_FastString* str, bool wantsMinState) { return NULL; }
+static void SWS_FreeHeapPtr (void* ptr) {}
+static int GetPlayStateEx (void* proj) { return 0; }
+static void* GetConfigVar (const char* name) { return NULL; }
+
+#include "../SnM/SnM_ChunkParserPatcher.h"
+
+static int g_checks   = 0;
+static int g_failures = 0;
+
+static void Check (bool ok, const char* test, int chunk, int query, const char* what)
+{
+	++g_checks;
+	if (!ok && ++g_failures <= 20)
+		printf("FAIL %s: chunk %d, query %d: %s\n", test, chunk, query, what);
+}
+
+// counts calls served by the line parser (the index does not notify)
+class TestPatcher : public SNM_ChunkParserPatcher
+{
+public:
+	TestPatcher (WDL_FastString* chunk, int useIndex) : SNM_ChunkParserPatcher(chunk, false), m_lineParserCalls(0), m_startElements(0)
+	{
+		if (useIndex >= 0) SetUseIndex(useIndex);
+	}
+	const char* Data ()                        { return m_chunk->Get(); }
+	int Length ()                              { return m_chunk->GetLength(); }
+	void Poke (int pos, char c)                { ((char*)m_chunk->Get())[pos] = c; } // same length in-place edit
+	void NotifyStartChunk (int mode)           { ++m_lineParserCalls; }
+	bool NotifyStartElement (int mode, LineParser* lp, const char* parsedLine, int linePos, WDL_PtrList<WDL_FastString>* parsedParents, WDL_FastString* newChunk, int updates)
+	{
+		++m_startElements;
+		return false;
+	}
+	int m_lineParserCalls, m_startElements;
+};
+
+/******************************************************************************
+* Random chunks                                                               *
+******************************************************************************/
+static unsigned int g_seed = 12345;
+static int Rand (int n)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return (int)((g_seed >> 8) % (unsigned int)n);
+}
+
+struct Keyword { string keyword, parent; int depth; };
+
+static const char* const g_lineKeywords[] = {"NAME", "VOLPAN", "BYPASS", "FXID", "PRESETNAME", "WAK", "POSITION", "MUTESOLO", "SEL"};
+static const char* const g_subChunks[]    = {"FXCHAIN", "VST", "ITEM", "SOURCE", "TRACK", "ENVELOPE"};
+static const int g_nbLineKeywords = sizeof(g_lineKeywords) / sizeof(g_lineKeywords[0]);
+static const int g_nbSubChunks    = sizeof(g_subChunks) / sizeof(g_subChunks[0]);
+
+static string RandomToken ()
+{
+	switch (Rand(8))
+	{
+		case 0:  return "0";
+		case 1:  return "1";
+		case 2:  return "-1";
+		case 3:  return "0.5";
+		case 4:  return "\"quoted token\"";
+		case 5:  return "{ABCD-1234}";
+		case 6:  return "x";
+		default: { char buf[16]; snprintf(buf, sizeof(buf), "%d", Rand(1000)); return buf; }
+	}
+}
+
+static string Indent (int depth)
+{
+	return Rand(10) ? "" : string(depth, ' ');
+}
+
+static void AddLine (string* chunk, vector<Keyword>* keywords, const string& keyword, const string& parent, int depth)
+{
+	*chunk += Indent(depth) + keyword;
+	for (int i = Rand(4); i > 0; --i)
+		*chunk += " " + RandomToken();
+	*chunk += "\n";
+	Keyword k = {keyword, parent, depth};
+	keywords->push_back(k);
+}
+
+static void AddSubChunk (string* chunk, vector<Keyword>* keywords, const string& name, int depth)
+{
+	const string kw = "<" + name;
+	if (name == "SOURCE")
+	{
+		*chunk += kw + (Rand(2) ? " MIDI\n" : " WAVE\n");
+		*chunk += "HASDATA 1 960 QN\n";
+		for (int i = Rand(4); i > 0; --i)
+			*chunk += (Rand(2) ? "E " : "Em ") + RandomToken() + " 90 3c 60\n";
+		*chunk += "GUID {1234}\n";
+		Keyword k = {kw, name, depth};
+		keywords->push_back(k);
+	}
+	else
+	{
+		AddLine(chunk, keywords, kw, name, depth);
+		if (name == "VST" && Rand(2))
+			*chunk += "AAAAbase64==\nBBBB==\n";
+	}
+
+	for (int i = Rand(5); i > 0; --i)
+	{
+		if (depth < 4 && !Rand(4))
+			AddSubChunk(chunk, keywords, g_subChunks[Rand(g_nbSubChunks)], depth + 1);
+		else
+			AddLine(chunk, keywords, g_lineKeywords[Rand(g_nbLineKeywords)], name, depth + 1);
+	}
+	*chunk += Indent(depth) + ">\n";
+}
+
+// _irregular: adds lines that ParsePatchCore() trims, zaps or drops when patching
+static string RandomChunk (vector<Keyword>* keywords, bool irregular)
+{
+	string chunk;
+	keywords->clear();
+	AddLine(&chunk, keywords, "<TRACK", "TRACK", 1);
+	for (int i = 2 + Rand(10); i > 0; --i)
+	{
+		if (!Rand(8))
+		{
+			chunk += "<FREEZE 1\nNAME frozen\n<VST frozen\nAAAA==\n>\n>\n";
+			if (!Rand(2)) chunk += "<FREEZE 2\nNAME frozen2\n>\n";
+		}
+		else if (Rand(3))
+			AddLine(&chunk, keywords, g_lineKeywords[Rand(g_nbLineKeywords)], "TRACK", 2);
+		else
+			AddSubChunk(&chunk, keywords, g_subChunks[Rand(g_nbSubChunks)], 2);
+
+		if (irregular && !Rand(4))
+		{
+			switch (Rand(7))
+			{
+				case 0: chunk += "\n"; break;
+				case 1: chunk += "   \t \n"; break;
+				case 2: chunk += "NAME " + string(SNM_MAX_CHUNK_LINE_LENGTH + Rand(100), 'a') + " 1\n"; break;
+				case 3: chunk += "NAME \"unbalanced 1\n"; break;
+				case 4: chunk += "VOLPAN 1 2\r\n"; break;
+				case 5: chunk += "# comment\n"; break;
+				case 6: chunk += "\"NAME\" 1\n"; break;
+			}
+		}
+	}
+	chunk += ">\n";
+	if (irregular && !Rand(3))
+		chunk += "TRAILING 1";
+	return chunk;
+}
+
+/******************************************************************************
+* Old vs new                                                                  *
+******************************************************************************/
+static const int g_modes[] = {
+	SNM_GET_CHUNK_CHAR, SNM_SET_CHUNK_CHAR, SNM_SETALL_CHUNK_CHAR_EXCEPT, SNM_GETALL_CHUNK_CHAR_EXCEPT,
+	SNM_TOGGLE_CHUNK_INT, SNM_TOGGLE_CHUNK_INT_EXCEPT, SNM_REPLACE_SUBCHUNK_OR_LINE,
+	SNM_GET_SUBCHUNK_OR_LINE, SNM_GET_SUBCHUNK_OR_LINE_EOL, SNM_COUNT_KEYWORD, SNM_D_ADD, SNM_D_MUL
+};
+
+static bool IsWriteMode (int mode)
+{
+	return mode == SNM_SET_CHUNK_CHAR || mode == SNM_SETALL_CHUNK_CHAR_EXCEPT || mode == SNM_TOGGLE_CHUNK_INT ||
+		mode == SNM_TOGGLE_CHUNK_INT_EXCEPT || mode == SNM_REPLACE_SUBCHUNK_OR_LINE || mode == SNM_D_ADD || mode == SNM_D_MUL;
+}
+
+static int g_queries = 0;
+
+static void CompareQueries (int chunkIdx, const vector<Keyword>& keywords, TestPatcher* oldP, TestPatcher* newP)
+{
+	static const char* const values[] = {"0", "1", "x", "-1", "a b", "\"q\"", "99"};
+	static const char* const replacements[] = {"", "NAME replaced\n", "<VST new\nBYPASS 1\n>\n", "VOLPAN 1 0\nSEL 1\n"};
+
+	for (int q = 0; q < 40; ++q, ++g_queries)
+	{
+		const int mode = g_modes[Rand(sizeof(g_modes) / sizeof(g_modes[0]))];
+
+		// search criteria, mostly taken from the chunk so that they match
+		Keyword k = {"NAME", "TRACK", 2};
+		if (!keywords.empty() && Rand(6))
+			k = keywords[Rand((int)keywords.size())];
+		// ParsePatchCore() can unbalance sub-chunks when patching their start
+		// lines (e.g. out of range tokens) and then crash on FREEZE sub-chunks
+		if (k.keyword[0] == '<' && IsWriteMode(mode) && mode != SNM_REPLACE_SUBCHUNK_OR_LINE)
+			k.keyword = k.keyword.substr(1);
+		int occurence = Rand(5) - 1;
+		if (mode == SNM_COUNT_KEYWORD) occurence = -1;
+		if (occurence < 0 && (mode == SNM_GET_CHUNK_CHAR || mode == SNM_GET_SUBCHUNK_OR_LINE || mode == SNM_GET_SUBCHUNK_OR_LINE_EOL) && Rand(2))
+			occurence = 0;
+		const int tokenPos = Rand(8) ? 1 + Rand(3) : 0;
+		const char* breakKeyword = Rand(4) ? NULL : g_lineKeywords[Rand(g_nbLineKeywords)];
+
+		const char* value = values[Rand(sizeof(values) / sizeof(values[0]))];
+		const char* valueExcept = Rand(3) ? values[Rand(sizeof(values) / sizeof(values[0]))] : NULL;
+		double d = 0.25 * (Rand(9) - 4);
+		char oldStr[SNM_MAX_CHUNK_LINE_LENGTH] = "", newStr[SNM_MAX_CHUNK_LINE_LENGTH] = "";
+		WDL_FastString oldSub, newSub;
+		void* oldValue = (void*)value;
+		void* newValue = (void*)value;
+		switch (mode)
+		{
+			case SNM_GET_CHUNK_CHAR:
+				oldValue = oldStr; newValue = newStr;
+				break;
+			case SNM_GET_SUBCHUNK_OR_LINE:
+			case SNM_GET_SUBCHUNK_OR_LINE_EOL:
+				oldValue = Rand(4) ? (void*)&oldSub : NULL;
+				newValue = oldValue ? (void*)&newSub : NULL;
+				break;
+			case SNM_REPLACE_SUBCHUNK_OR_LINE:
+				oldValue = newValue = (void*)replacements[Rand(sizeof(replacements) / sizeof(replacements[0]))];
+				break;
+			case SNM_D_ADD:
+			case SNM_D_MUL:
+				oldValue = newValue = &d;
+				break;
+		}
+
+		int oldRet, newRet;
+		if (IsWriteMode(mode))
+		{
+			oldRet = oldP->ParsePatch(mode, k.depth, k.parent.c_str(), k.keyword.c_str(), occurence, tokenPos, oldValue, (void*)valueExcept, breakKeyword);
+			newRet = newP->ParsePatch(mode, k.depth, k.parent.c_str(), k.keyword.c_str(), occurence, tokenPos, newValue, (void*)valueExcept, breakKeyword);
+		}
+		else
+		{
+			oldRet = oldP->Parse(mode, k.depth, k.parent.c_str(), k.keyword.c_str(), occurence, tokenPos, oldValue, (void*)valueExcept, breakKeyword);
+			newRet = newP->Parse(mode, k.depth, k.parent.c_str(), k.keyword.c_str(), occurence, tokenPos, newValue, (void*)valueExcept, breakKeyword);
+		}
+
+		Check(oldRet == newRet, "old vs new", chunkIdx, q, "return value");
+		Check(!strcmp(oldStr, newStr), "old vs new", chunkIdx, q, "token");
+		Check(oldSub.GetLength() == newSub.GetLength() && !strcmp(oldSub.Get(), newSub.Get()), "old vs new", chunkIdx, q, "sub-chunk");
+		Check(oldP->Length() == newP->Length() && !strcmp(oldP->Data(), newP->Data()), "old vs new", chunkIdx, q, "chunk");
+		Check(oldP->GetUpdates() == newP->GetUpdates(), "old vs new", chunkIdx, q, "updates");
+
+		// same length in-place edit behind the index's back
+		if (!Rand(10) && oldP->Length() == newP->Length() && oldP->Length())
+		{
+			const int pos = Rand(oldP->Length());
+			if (oldP->Data()[pos] >= '0' && oldP->Data()[pos] <= '8')
+			{
+				const char c = oldP->Data()[pos] + 1;
+				oldP->Poke(pos, c);
+				newP->Poke(pos, c);
+			}
+		}
+	}
+}
+
+static void TestOldVsNew ()
+{
+	int lineParserCalls = 0;
+	for (int i = 0; i < 400; ++i)
+	{
+		vector<Keyword> keywords;
+		WDL_FastString chunk(RandomChunk(&keywords, i % 4 == 3).c_str());
+		WDL_FastString oldChunk(chunk.Get()), newChunk(chunk.Get());
+
+		TestPatcher oldP(&oldChunk, 0), newP(&newChunk, 1);
+		CompareQueries(i, keywords, &oldP, &newP);
+		lineParserCalls += newP.m_lineParserCalls;
+	}
+
+	// make sure the index is actually tested
+	Check(lineParserCalls < g_queries / 2, "index usage", 0, 0, "too many calls served by the line parser");
+	printf("SnM_ChunkParserPatcher: %d/%d calls served by the index\n", g_queries - lineParserCalls, g_queries);
+}
+
+/******************************************************************************
+* Regressions                                                                 *
+******************************************************************************/
+static void TestLongToken ()
+{
+	// the line parser trims lines, tokens always fit SNM_MAX_CHUNK_LINE_LENGTH buffers
+	string s = "<TRACK\nNAME " + string(SNM_MAX_CHUNK_LINE_LENGTH * 2, 'a') + "\n>\n";
+	WDL_FastString chunk(s.c_str());
+	TestPatcher p(&chunk, 1);
+	char buf[SNM_MAX_CHUNK_LINE_LENGTH + 16];
+	memset(buf, 'z', sizeof(buf));
+	p.Parse(SNM_GET_CHUNK_CHAR, 1, "TRACK", "NAME", 0, 1, buf);
+	Check(strlen(buf) < SNM_MAX_CHUNK_LINE_LENGTH, "long token", 0, 0, "token not trimmed");
+}
+
+static void TestEmptyLines ()
+{
+	// empty lines are not recopied in sub-chunks
+	WDL_FastString chunk("<TRACK\n<FXCHAIN\n\nBYPASS 0\n   \n>\n>\n");
+	WDL_FastString oldSub, newSub;
+	WDL_FastString oldChunk(chunk.Get()), newChunk(chunk.Get());
+	TestPatcher oldP(&oldChunk, 0), newP(&newChunk, 1);
+	oldP.Parse(SNM_GET_SUBCHUNK_OR_LINE, 2, "FXCHAIN", "<FXCHAIN", 0, -1, &oldSub);
+	newP.Parse(SNM_GET_SUBCHUNK_OR_LINE, 2, "FXCHAIN", "<FXCHAIN", 0, -1, &newSub);
+	Check(!strcmp(oldSub.Get(), "<FXCHAIN\nBYPASS 0\n>\n"), "empty lines", 0, 0, "old sub-chunk");
+	Check(!strcmp(oldSub.Get(), newSub.Get()), "empty lines", 0, 0, "new sub-chunk");
+}
+
+static void TestInPlaceEdit ()
+{
+	WDL_FastString chunk("<TRACK\nNAME a\nSEL 0\n>\n");
+	TestPatcher p(&chunk, 1);
+	char buf[SNM_MAX_CHUNK_LINE_LENGTH] = "";
+	p.Parse(SNM_GET_CHUNK_CHAR, 1, "TRACK", "SEL", 0, 1, buf);
+	p.Poke(7, 'X'); p.Poke(8, 'X'); p.Poke(9, 'X'); p.Poke(10, 'X'); // "NAME" -> "XXXX"
+	Check(p.Parse(SNM_GET_CHUNK_CHAR, 1, "TRACK", "NAME", 0, 1, buf) == 0, "in-place edit", 0, 0, "stale index");
+	Check(p.Parse(SNM_COUNT_KEYWORD, 1, "TRACK", "XXXX") == 1, "in-place edit", 0, 1, "stale index");
+}
+
+static void TestNotifications ()
+{
+	// subclasses keep their callbacks unless they enable the index
+	WDL_FastString chunk("<TRACK\n<FXCHAIN\nBYPASS 0\n>\n>\n");
+	TestPatcher p(&chunk, -1);
+	p.Parse(SNM_COUNT_KEYWORD, 2, "FXCHAIN", "BYPASS");
+	Check(p.m_lineParserCalls == 1 && p.m_startElements == 2, "notifications", 0, 0, "callbacks not triggered");
+}
+
+int main ()
+{
+	TestOldVsNew();
+	TestLongToken();
+	TestEmptyLines();
+	TestInPlaceEdit();
+	TestNotifications();
+
+	printf("SnM_ChunkParserPatcher: %d checks, %d failures\n", g_checks, g_failures);
+	return g_failures ? 1 : 0;
+}
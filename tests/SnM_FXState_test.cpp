@@ -0,0 +1,255 @@
+/******************************************************************************
+/ tests/SnM_FXState_test.cpp
+/
+/ Track/take FX online/offline/bypass (SnM_FX.cpp): the native API path,
+/ which uses GetPatchedBoolToken(), checked against the chunk path it replaced
+/ (ParsePatch() on "BYPASS" lines) on random FX chains, then both timed on
+/ large FX chains. The native API is mocked, chunk get/set are plain copies:
+/ REAPER's own cost of the chunk path (serializing and reloading every plugin
+/ state) comes on top of the timings below.
+/
+******************************************************************************/
+#include "stdafx.h"
+#include <time.h>
+#include "wdl_standins.h"
+
+// REAPER/SWS stubs (only used when attached to a reaThing*)
+int g_disable_chunk_guid_filtering = 0;
+static const char* SWS_GetSetObjectState (void* obj, WDL_FastString* str, bool wantsMinState) { return NULL; }
+static void SWS_FreeHeapPtr (void* ptr) {}
+static int GetPlayStateEx (void* proj) { return 0; }
+static void* GetConfigVar (const char* name) { return NULL; }
+
+#include "../SnM/SnM_ChunkParserPatcher.h"
+
+static int g_checks   = 0;
+static int g_failures = 0;
+
+static void Check (bool ok, const char* test, int chain, const char* what)
+{
+	++g_checks;
+	if (!ok && ++g_failures <= 20)
+		printf("FAIL %s: chain %d: %s\n", test, chain, what);
+}
+
+static unsigned int g_seed = 4321;
+static int Rand (int n)
+{
+	g_seed = g_seed * 1103515245 + 12345;
+	return (int)((g_seed >> 16) & 0x7FFF) % n;
+}
+
+/******************************************************************************
+* Mock FX chains                                                              *
+******************************************************************************/
+struct MockFX { bool bypass, offline; };
+
+static void AppendFX (string* chunk, const MockFX& fx, int stateLines)
+{
+	char line[128];
+	snprintf(line, sizeof(line), "BYPASS %d %d 0\n", fx.bypass ? 1 : 0, fx.offline ? 1 : 0);
+	*chunk += line;
+	*chunk += "<VST \"VST: ReaEQ (Cockos)\" reaeq.dll 0 \"\" 1919247729<56535472656571726561657100000000> \"\"\n";
+	for (int i = 0; i < stateLines; i++) // base64 plugin state
+		*chunk += "cWVlcu9e7f4CAAAAAQAAAAAAAAACAAAAAAAAAAIAAAABAAAAAAAAAAIAAAAAAAAAXAEAAAEAAAAAABAA\n";
+	*chunk += ">\nFXID {E3F5E7B1-2E44-4E2B-8D55-6A1F0F8C0A11}\nWAK 0 0\n";
+}
+
+// FX of a track, or of all takes of an item (FX ids run through all takes like chunk occurrences do)
+static string ChainChunk (const vector<MockFX>& fxs, const vector<int>& takeFXCounts, int stateLines)
+{
+	string chunk;
+	if (takeFXCounts.empty())
+	{
+		chunk = "<TRACK\nNAME \"test\"\nVOLPAN 1 0 -1 -1 1\n<FXCHAIN\nSHOW 0\nDOCKED 0\n";
+		for (size_t i = 0; i < fxs.size(); i++)
+			AppendFX(&chunk, fxs[i], stateLines);
+		chunk += ">\n>\n";
+		return chunk;
+	}
+
+	chunk = "<ITEM\nPOSITION 0\nLENGTH 10\n";
+	int fxIdx = 0;
+	for (size_t t = 0; t < takeFXCounts.size(); t++)
+	{
+		chunk += (t ? "TAKE\nNAME \"take\"\n" : "NAME \"take\"\n");
+		chunk += "<SOURCE WAVE\nFILE \"a.wav\"\n>\n";
+		if (takeFXCounts[t])
+		{
+			chunk += "<TAKEFX\nSHOW 0\n";
+			for (int i = 0; i < takeFXCounts[t]; i++)
+				AppendFX(&chunk, fxs[fxIdx++], stateLines);
+			chunk += ">\n";
+		}
+	}
+	chunk += ">\n";
+	return chunk;
+}
+
+// token 1: bypass, token 2: offline
+static vector<bool> ReadChunkStates (const char* chunk, int token)
+{
+	vector<bool> states;
+	for (const char* p = strstr(chunk, "\nBYPASS "); p; p = strstr(p + 1, "\nBYPASS "))
+	{
+		int bypass = 0, offline = 0;
+		sscanf(p + 1, "BYPASS %d %d", &bypass, &offline);
+		states.push_back((token == 1 ? bypass : offline) != 0);
+	}
+	return states;
+}
+
+/******************************************************************************
+* Both paths, as in SnM_FX.cpp                                                *
+******************************************************************************/
+static int g_nativeCalls = 0;
+
+__attribute__((noinline)) static bool MockFX_GetState (const vector<MockFX>& fxs, int idx, int token)
+{
+	++g_nativeCalls;
+	return token == 1 ? fxs[idx].bypass : fxs[idx].offline;
+}
+
+__attribute__((noinline)) static void MockFX_SetState (vector<MockFX>* fxs, int idx, int token, bool state)
+{
+	++g_nativeCalls;
+	if (token == 1) (*fxs)[idx].bypass = state;
+	else            (*fxs)[idx].offline = state;
+}
+
+static bool NativePath (vector<MockFX>* fxs, int token, int mode, int fxId, const char* value, const char* valueExcept)
+{
+	bool updated = false;
+	for (int j = 0; j < (int)fxs->size(); j++)
+	{
+		bool state = MockFX_GetState(*fxs, j, token);
+		bool newState = GetPatchedBoolToken(state, mode, j, fxId, value, valueExcept);
+		if (newState != state)
+		{
+			MockFX_SetState(fxs, j, token, newState);
+			updated = true;
+		}
+	}
+	return updated;
+}
+
+// objectState: what GetSetObjectState() would get and set
+static bool ChunkPath (WDL_FastString* objectState, bool take, int token, int mode, int fxId, const char* value, const char* valueExcept)
+{
+	WDL_FastString chunk(objectState->Get()); // get
+	SNM_ChunkParserPatcher p(&chunk, false);
+	bool updated = p.ParsePatch(mode, 2, take ? "TAKEFX" : "FXCHAIN", "BYPASS", fxId, token, (void*)value, (void*)valueExcept) > 0;
+	if (updated && p.Commit())
+		objectState->Set(chunk.Get()); // set
+	return updated;
+}
+
+/******************************************************************************
+* Test                                                                        *
+******************************************************************************/
+struct Query { int mode; const char* value; const char* valueExcept; };
+
+// as used by the S&M actions: PatchSelTracksFXOnline() and PatchSelItemsFXState() callers
+static const Query g_queries[] = {
+	{SNM_TOGGLE_CHUNK_INT,         NULL, NULL},
+	{SNM_TOGGLE_CHUNK_INT_EXCEPT,  NULL, NULL},
+	{SNM_SET_CHUNK_CHAR,           "0",  NULL},
+	{SNM_SET_CHUNK_CHAR,           "1",  NULL},
+	{SNM_SETALL_CHUNK_CHAR_EXCEPT, "0",  "1"},
+	{SNM_SETALL_CHUNK_CHAR_EXCEPT, "1",  "0"},
+};
+static const int g_nbQueries = sizeof(g_queries) / sizeof(g_queries[0]);
+
+static void TestSameStates ()
+{
+	for (int chain = 0; chain < 400; chain++)
+	{
+		bool take = chain % 2 != 0;
+		vector<MockFX> fxs(1 + Rand(12));
+		for (size_t i = 0; i < fxs.size(); i++)
+		{
+			fxs[i].bypass  = Rand(2) != 0;
+			fxs[i].offline = Rand(2) != 0;
+		}
+
+		// take FX spread over a few takes, some of them without FX
+		vector<int> takeFXCounts;
+		for (int left = take ? (int)fxs.size() : 0; left > 0;)
+		{
+			int n = Rand(3) ? 1 + Rand(left) : 0;
+			takeFXCounts.push_back(n);
+			left -= n;
+		}
+
+		WDL_FastString objectState(ChainChunk(fxs, takeFXCounts, 2).c_str());
+		for (int q = 0; q < 30; q++)
+		{
+			const Query& query = g_queries[Rand(g_nbQueries)];
+			int token = take ? 1 + Rand(2) : 2; // tracks: offline only (bypass uses TrackFX_SetEnabled)
+			int fxId = Rand((int)fxs.size() + 1);   // includes an out of range one
+
+			NativePath(&fxs, token, query.mode, fxId, query.value, query.valueExcept);
+			ChunkPath(&objectState, take, token, query.mode, fxId, query.value, query.valueExcept);
+
+			for (int t = 1; t <= 2; t++)
+			{
+				vector<bool> chunkStates = ReadChunkStates(objectState.Get(), t);
+				bool same = chunkStates.size() == fxs.size();
+				for (size_t i = 0; same && i < fxs.size(); i++)
+					same = chunkStates[i] == (t == 1 ? fxs[i].bypass : fxs[i].offline);
+				Check(same, "native vs chunk states", chain, t == 1 ? "bypass" : "offline");
+			}
+		}
+	}
+}
+
+/******************************************************************************
+* Benchmark                                                                   *
+******************************************************************************/
+static void Benchmark (int nbFX, int stateLines)
+{
+	vector<MockFX> fxs(nbFX);
+	for (int i = 0; i < nbFX; i++)
+		fxs[i].bypass = fxs[i].offline = false;
+	WDL_FastString objectState(ChainChunk(fxs, vector<int>(), stateLines).c_str());
+
+	// Toggle one FX offline, then set all online but that one (the usual actions)
+	const int runs = 200;
+	clock_t start = clock();
+	for (int i = 0; i < runs; i++)
+	{
+		ChunkPath(&objectState, false, 2, SNM_TOGGLE_CHUNK_INT, i % nbFX, NULL, NULL);
+		ChunkPath(&objectState, false, 2, SNM_SETALL_CHUNK_CHAR_EXCEPT, i % nbFX, "0", "1");
+	}
+	double chunkUs = (double)(clock() - start) / CLOCKS_PER_SEC * 1e6 / (2 * runs);
+
+	g_nativeCalls = 0;
+	start = clock();
+	for (int i = 0; i < runs; i++)
+	{
+		NativePath(&fxs, 2, SNM_TOGGLE_CHUNK_INT, i % nbFX, NULL, NULL);
+		NativePath(&fxs, 2, SNM_SETALL_CHUNK_CHAR_EXCEPT, i % nbFX, "0", "1");
+	}
+	double nativeUs = (double)(clock() - start) / CLOCKS_PER_SEC * 1e6 / (2 * runs);
+
+	vector<bool> chunkStates = ReadChunkStates(objectState.Get(), 2);
+	bool same = chunkStates.size() == fxs.size();
+	for (size_t i = 0; same && i < fxs.size(); i++)
+		same = chunkStates[i] == fxs[i].offline;
+	Check(same, "benchmark states", nbFX, "offline");
+
+	printf("SnM_FXState %d FX, %d KB chunk (us/action): chunk path %.1f, native path %.2f (%d API calls)\n",
+		nbFX, objectState.GetLength() / 1024, chunkUs, nativeUs, g_nativeCalls / (2 * runs));
+}
+
+int main ()
+{
+	TestSameStates();
+	Benchmark(16, 50);
+	Benchmark(64, 50);
+	Benchmark(64, 400);
+	Benchmark(256, 100);
+
+	printf("SnM_FXState: %d checks, %d failures\n", g_checks, g_failures);
+	return (g_failures == 0) ? 0 : 1;
+}
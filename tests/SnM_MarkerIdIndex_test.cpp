@@ -0,0 +1,180 @@
+/******************************************************************************
+/ tests/SnM_MarkerIdIndex_test.cpp
+/
+/ Marker/region id index (FindMarkerRegionById()) compared with the linear
+/ search it replaced on random markers/regions (duplicate numbers included),
+/ checks when it gets rebuilt and times both on region playlist-like lookups.
+/
+******************************************************************************/
+#include "stdafx.h"
+#include <time.h>
+#include "../SnM/SnM_MarkerIdIndex.h"
+
+/******************************************************************************
+* Mock markers                                                                *
+******************************************************************************/
+static vector<int>  g_ids;              // in project order, see MakeMarkerRegionId()
+static int          g_stateCount = 0;
+static unsigned int g_seed       = 7;
+
+static unsigned int Rand ()          { g_seed = g_seed * 1103515245 + 12345; return (g_seed >> 16) & 0x7FFF; }
+static int          RandInt (int n)  { return (int)(Rand() % n); }
+
+static int MakeId (int num, bool isrgn) { return num | ((isrgn ? 1 : 0) << 30); }
+
+static void BuildRandomMarkers (int count)
+{
+	g_ids.resize(count);
+	for (int i = 0; i < count; ++i)
+		g_ids[i] = MakeId(RandInt(count), RandInt(2) != 0); // duplicates on purpose, num 0 too
+	++g_stateCount;
+}
+
+// Stands for EnumProjectMarkers3(), which is a lot more expensive in REAPER so timings below favor the linear search
+__attribute__((noinline)) static int MockEnum (int idx, int* idOut)
+{
+	if (idx < 0 || idx >= (int)g_ids.size())
+		return 0;
+	*idOut = g_ids[idx];
+	return idx + 1;
+}
+
+int SNM_MarkerRegionIdIndex::ReadStateChangeCount (ReaProject* _proj)     { return g_stateCount; }
+int SNM_MarkerRegionIdIndex::ReadCount (ReaProject* _proj)                { return (int)g_ids.size(); }
+int SNM_MarkerRegionIdIndex::ReadId (ReaProject* _proj, int _idx, int* _idOut) { return MockEnum(_idx, _idOut); }
+
+// As it was in FindMarkerRegionById()
+static int FindLinear (int id)
+{
+	int x = 0, lastx = 0, id2;
+	while ((x = MockEnum(x, &id2)))
+	{
+		if (id2 == id)
+			return lastx;
+		lastx = x;
+	}
+	return -1;
+}
+
+// As in FindMarkerRegionById() for the current project (entries are always fresh here)
+static int FindIndexed (ReaProject* proj, int id)
+{
+	SNM_MarkerRegionIdIndex* index = SNM_MarkerRegionIdIndex::Get();
+	if (!index->IsValid(proj))
+		index->Rebuild(proj);
+	return index->Find(id);
+}
+
+/******************************************************************************
+* Test                                                                        *
+******************************************************************************/
+static int g_checks   = 0;
+static int g_failures = 0;
+
+static void Check (const char* test, int id, int expected, int actual)
+{
+	++g_checks;
+	if (expected != actual && ++g_failures <= 20)
+		printf("FAIL %s: id %d: expected %d, got %d\n", test, id, expected, actual);
+}
+
+static void TestFind ()
+{
+	for (int run = 0; run < 200; ++run)
+	{
+		BuildRandomMarkers(RandInt(300));
+		for (int num = 0; num <= (int)g_ids.size() + 1; ++num)
+			for (int isrgn = 0; isrgn < 2; ++isrgn)
+			{
+				int id = MakeId(num, isrgn != 0);
+				Check("find", id, (id > 0) ? FindLinear(id) : -1, FindIndexed(NULL, id));
+			}
+	}
+}
+
+static void TestRebuilds ()
+{
+	ReaProject* proj1 = (ReaProject*)&g_ids;  // any distinct pointers
+	ReaProject* proj2 = (ReaProject*)&g_seed;
+	SNM_MarkerRegionIdIndex* index = SNM_MarkerRegionIdIndex::Get();
+
+	BuildRandomMarkers(100);
+	FindIndexed(proj1, g_ids[0]);
+	int rebuilds = SNM_MarkerRegionIdIndex::GetRebuildCount();
+
+	for (int i = 0; i < 100; ++i)
+		FindIndexed(proj1, g_ids[i]);
+	Check("no change rebuilds", 0, rebuilds, SNM_MarkerRegionIdIndex::GetRebuildCount());
+
+	++g_stateCount;
+	FindIndexed(proj1, g_ids[0]);
+	FindIndexed(proj1, g_ids[1]);
+	Check("state count rebuilds", 0, rebuilds + 1, SNM_MarkerRegionIdIndex::GetRebuildCount());
+
+	g_ids.push_back(MakeId(1000, true));
+	FindIndexed(proj1, MakeId(1000, true));
+	Check("marker count rebuilds", 0, rebuilds + 2, SNM_MarkerRegionIdIndex::GetRebuildCount());
+	Check("added marker", 0, (int)g_ids.size() - 1, FindIndexed(proj1, MakeId(1000, true)));
+
+	FindIndexed(proj2, g_ids[0]);
+	FindIndexed(proj1, g_ids[0]);
+	Check("project rebuilds", 0, rebuilds + 4, SNM_MarkerRegionIdIndex::GetRebuildCount());
+
+	// Synced from the marker/region cache (see SyncMarkerRegionIdIndex()): lookups don't rebuild it again
+	index->Clear(true);
+	for (int i = 0; i < (int)g_ids.size(); ++i)
+		index->Add(g_ids[i], i);
+	index->Stamp(proj1);
+	Check("from cache", 0, 1, index->IsFromCache(proj1));
+	Check("from cache (other project)", 0, 0, index->IsFromCache(proj2));
+	for (int i = 0; i < 100; ++i)
+		Check("find from cache", g_ids[i], FindLinear(g_ids[i]), FindIndexed(proj1, g_ids[i]));
+	Check("cache sync rebuilds", 0, rebuilds + 5, SNM_MarkerRegionIdIndex::GetRebuildCount());
+
+	index->Rebuild(proj1);
+	Check("from project", 0, 0, index->IsFromCache(proj1));
+}
+
+/******************************************************************************
+* Benchmark                                                                   *
+******************************************************************************/
+static void Benchmark (int markers, int items)
+{
+	BuildRandomMarkers(markers);
+	vector<int> playlist(items);
+	for (int i = 0; i < items; ++i)
+		playlist[i] = g_ids[RandInt(markers)];
+
+	// One poll: a few lookups per playlist item (IsInPlaylist, GetLength, IsInfinite...)
+	const int polls = 100;
+	int rebuilds = SNM_MarkerRegionIdIndex::GetRebuildCount();
+	long sum1 = 0, sum2 = 0;
+
+	clock_t start = clock();
+	for (int p = 0; p < polls; ++p)
+		for (int i = 0; i < items; ++i)
+			sum1 += FindLinear(playlist[i]);
+	double linear = (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / (polls * items);
+
+	start = clock();
+	for (int p = 0; p < polls; ++p)
+		for (int i = 0; i < items; ++i)
+			sum2 += FindIndexed(NULL, playlist[i]);
+	double indexed = (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 / (polls * items);
+
+	Check("benchmark results", markers, (int)sum1, (int)sum2);
+	Check("benchmark rebuilds", markers, rebuilds + 1, SNM_MarkerRegionIdIndex::GetRebuildCount());
+	printf("SnM_MarkerIdIndex %d markers/regions, %d playlist items (ns/lookup): linear %.0f, indexed %.0f\n", markers, items, linear, indexed);
+}
+
+int main ()
+{
+	TestFind();
+	TestRebuilds();
+	Benchmark(100, 50);
+	Benchmark(1000, 200);
+	Benchmark(5000, 500);
+
+	printf("SnM_MarkerIdIndex: %d checks, %d failures\n", g_checks, g_failures);
+	return (g_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+/******************************************************************************
+/ tests/SnM_RegionPlaylistTimeline_test.cpp
+/
+/ Region playlist engine (timeline, scheduler, offline simulation) checked
+/ against hand-computed seek times. Regions and ticks use binary fractions so
+/ that the simulated transport is exact.
+/
+******************************************************************************/
+#include "stdafx.h"
+#include "../SnM/SnM_RegionPlaylistTimeline.h"
+
+static int g_checks   = 0;
+static int g_failures = 0;
+
+static void Check (bool ok, const char* test, const char* what, int idx, double expected, double actual)
+{
+	++g_checks;
+	if (!ok)
+	{
+		++g_failures;
+		printf("FAIL %s: %s[%d] expected %g, got %g\n", test, what, idx, expected, actual);
+	}
+}
+
+static void CheckInt (const char* test, const char* what, int idx, int expected, int actual)
+{
+	Check(expected == actual, test, what, idx, expected, actual);
+}
+
+static void CheckTime (const char* test, const char* what, int idx, double expected, double actual)
+{
+	Check(fabs(expected - actual) < 1E-9, test, what, idx, expected, actual);
+}
+
+struct ExpectedSeek { double reqTime, time, from, to; bool end; };
+
+static void CheckSimulation (const char* test, const vector<RgnPlaylistTimelineItem>& items, bool repeat, int startItem, double maxTime, int segments, const ExpectedSeek* expected, int seekCount)
+{
+	RgnPlaylistTimeline tl;
+	tl.Build(items, repeat);
+	CheckInt(test, "segments", 0, segments, tl.GetSize());
+
+	vector<RgnPlaylistSimSeek> seeks;
+	CheckInt(test, "seeks", 0, seekCount, SimulateRegionPlaylist(&tl, tl.FindItem(startItem), 0.0625, 0.25, maxTime, &seeks));
+	for (int i = 0; i < seekCount && i < (int)seeks.size(); ++i)
+	{
+		CheckTime(test, "reqTime", i, expected[i].reqTime, seeks[i].m_reqTime);
+		CheckTime(test, "time",    i, expected[i].time,    seeks[i].m_time);
+		CheckTime(test, "from",    i, expected[i].from,    seeks[i].m_from);
+		if (!expected[i].end)
+			CheckTime(test, "to",  i, expected[i].to,      seeks[i].m_to);
+		CheckInt(test, "end",      i, expected[i].end,     seeks[i].m_end);
+		CheckInt(test, "late",     i, false,               seeks[i].m_late);
+	}
+}
+
+static vector<RgnPlaylistTimelineItem> Items (const RgnPlaylistTimelineItem* items, int count)
+{
+	return vector<RgnPlaylistTimelineItem>(items, items + count);
+}
+
+int main ()
+{
+	//                                 rgn, loops, pos,  end
+	const RgnPlaylistTimelineItem A   = {1,   2,     0.0,  4.0};
+	const RgnPlaylistTimelineItem B   = {2,   1,     4.0,  8.0};
+	const RgnPlaylistTimelineItem C   = {3,   1,     10.0, 12.5};
+	const RgnPlaylistTimelineItem Inf = {1,   -1,    0.0,  4.0};
+	const RgnPlaylistTimelineItem Bad = {-1,  0,     0.0,  0.0}; // removed region
+
+	// adjacent regions: A x2 then B, seeks happen at region ends
+	{
+		const RgnPlaylistTimelineItem items[] = {A, B};
+		const ExpectedSeek seeks[] = {
+			{0.0, 0.0,  0.0, 0.0, false},
+			{0.0, 4.0,  4.0, 0.0, false},
+			{4.0, 8.0,  4.0, 4.0, false},
+			{8.0, 12.0, 8.0, 0.0, true},
+		};
+		CheckSimulation("adjacent", Items(items, 2), false, 0, 100.0, 3, seeks, 4);
+	}
+
+	// invalid items are skipped, item ids are kept
+	{
+		const RgnPlaylistTimelineItem items[] = {C, Bad, A};
+		const ExpectedSeek seeks[] = {
+			{0.0, 0.0,  0.0,  10.0, false},
+			{0.0, 2.5,  12.5, 0.0,  false},
+			{2.5, 6.5,  4.0,  0.0,  false},
+			{6.5, 10.5, 4.0,  0.0,  true},
+		};
+		CheckSimulation("invalid item", Items(items, 3), false, 0, 100.0, 3, seeks, 4);
+
+		RgnPlaylistTimeline tl;
+		tl.Build(Items(items, 3), false);
+		CheckInt("invalid item", "FindItem(1)", 0, -1, tl.FindItem(1));
+		CheckInt("invalid item", "FindItem(2, 0)", 0, 1, tl.FindItem(2, 0));
+		CheckInt("invalid item", "FindItem(2, 1)", 0, 2, tl.FindItem(2, 1));
+		CheckInt("invalid item", "FindItem(2, 5)", 0, 2, tl.FindItem(2, 5)); // clamped to last loop
+		CheckInt("invalid item", "FindPos(11, 0)", 0, 0, tl.FindPos(11.0, 0));
+		CheckInt("invalid item", "FindPos(1, 0)", 0, 1, tl.FindPos(1.0, 0));
+		CheckInt("invalid item", "FindPos(9, 0)", 0, -1, tl.FindPos(9.0, 0));
+		CheckInt("invalid item", "GetNext(2)", 0, -1, tl.GetNext(2));
+	}
+
+	// repeat: playlist restarts until max time
+	{
+		const RgnPlaylistTimelineItem items[] = {C, B};
+		const ExpectedSeek seeks[] = {
+			{0.0,  0.0,  0.0,  10.0, false},
+			{0.0,  2.5,  12.5, 4.0,  false},
+			{2.5,  6.5,  8.0,  10.0, false},
+			{6.5,  9.0,  12.5, 4.0,  false},
+			{9.0,  13.0, 8.0,  10.0, false},
+			{13.0, 15.5, 12.5, 4.0,  false},
+			{15.5, 19.5, 8.0,  10.0, false},
+		};
+		CheckSimulation("repeat", Items(items, 2), true, 0, 20.0, 2, seeks, 7);
+
+		RgnPlaylistTimeline tl;
+		tl.Build(Items(items, 2), true);
+		CheckInt("repeat", "GetNext(1)", 0, 0, tl.GetNext(1));
+		CheckInt("repeat", "FindPos(5, 1)", 0, 1, tl.FindPos(5.0, 1));
+		CheckInt("repeat", "FindPos(11, 1)", 0, 0, tl.FindPos(11.0, 1)); // wraps around
+	}
+
+	// infinite loop: next items are never reached
+	{
+		const RgnPlaylistTimelineItem items[] = {C, Inf, B};
+		const ExpectedSeek seeks[] = {
+			{0.0,  0.0,  0.0,  10.0, false},
+			{0.0,  2.5,  12.5, 0.0,  false},
+			{2.5,  6.5,  4.0,  0.0,  false},
+			{6.5,  10.5, 4.0,  0.0,  false},
+			{10.5, 14.5, 4.0,  0.0,  false},
+		};
+		CheckSimulation("infinite loop", Items(items, 3), false, 0, 15.0, 3, seeks, 5);
+
+		RgnPlaylistTimeline tl;
+		tl.Build(Items(items, 3), false);
+		CheckInt("infinite loop", "GetNext(1)", 0, 1, tl.GetNext(1));
+
+		RgnPlaylistScheduler sched;
+		sched.Init(&tl, 0.0625);
+		sched.Seek(1, false);
+		sched.Process(0.0);
+		CheckInt("infinite loop", "GetLoopsLeft", 0, -1, sched.GetLoopsLeft());
+	}
+
+	// scheduler: lookahead, loops left and unsync
+	{
+		const RgnPlaylistTimelineItem items[] = {C, A};
+		RgnPlaylistTimeline tl;
+		tl.Build(Items(items, 2), false);
+
+		RgnPlaylistScheduler sched;
+		sched.Init(&tl, 0.0625);
+		CheckInt("scheduler", "Seek", 0, RGNPL_EVT_SEEK, sched.Seek(0, false));
+		CheckTime("scheduler", "GetSeekPos", 0, 10.0, sched.GetSeekPos());
+		CheckInt("scheduler", "Process(9.9375)", 0, RGNPL_EVT_NEXT|RGNPL_EVT_SEEK, sched.Process(9.9375)); // within lookahead
+		CheckInt("scheduler", "GetCur", 0, 0, sched.GetCur());
+		CheckTime("scheduler", "GetSeekPos", 1, 0.0, sched.GetSeekPos());
+		CheckInt("scheduler", "Process(12.5)", 0, 0, sched.Process(12.5));
+		CheckInt("scheduler", "Process(0)", 0, RGNPL_EVT_NEXT|RGNPL_EVT_SEEK, sched.Process(0.0));
+		CheckInt("scheduler", "GetLoopsLeft", 0, 1, sched.GetLoopsLeft());
+		CheckInt("scheduler", "Process(2)", 0, 0, sched.Process(2.0));
+		CheckInt("scheduler", "Process(3)", 0, 0, sched.Process(3.0)); // same region: waits for the play position to go back
+		CheckInt("scheduler", "Process(7)", 0, RGNPL_EVT_UNSYNC|RGNPL_EVT_SEEK, sched.Process(7.0));
+		CheckInt("scheduler", "IsUnsync", 0, true, sched.IsUnsync());
+		CheckInt("scheduler", "Process(1)", 0, RGNPL_EVT_NEXT|RGNPL_EVT_SEEK|RGNPL_EVT_END, sched.Process(1.0));
+		CheckInt("scheduler", "IsUnsync", 1, false, sched.IsUnsync());
+		CheckInt("scheduler", "GetLoopsLeft", 1, 0, sched.GetLoopsLeft());
+		CheckInt("scheduler", "Process(9)", 0, 0, sched.Process(9.0)); // stopping: no unsync
+	}
+
+	printf("SnM_RegionPlaylistTimeline: %d checks, %d failures\n", g_checks, g_failures);
+	return (g_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+/******************************************************************************
+/ tests/stdafx.h
+/
+/ Stand-in for the real stdafx.h when building REAPER-independent sources for
+/ unit tests (no WDL, no REAPER SDK)
+/
+******************************************************************************/
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <cmath>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+using namespace std;
+
+class ReaProject; // opaque REAPER types used in tested headers
@@ -0,0 +1,166 @@
+/******************************************************************************
+/ tests/wdl_standins.h
+/
+/ Minimal stand-ins for the few WDL classes used by header-only SWS tools
+/ (e.g. SnM_ChunkParserPatcher.h) so that they can be unit tested without WDL.
+/ Only the used subset of the WDL interfaces is provided, with the same
+/ semantics (LineParser: blank separated tokens, "quoted" 'tokens' `too`).
+/
+******************************************************************************/
+#pragma once
+
+#include <stdarg.h>
+#include <strings.h>
+#include <string>
+
+#ifndef _strnicmp
+#define _strnicmp strncasecmp
+#endif
+#ifndef _snprintf
+#define _snprintf snprintf
+#endif
+
+class WDL_FastString
+{
+public:
+	WDL_FastString (int hbgran) {}
+	WDL_FastString (const char* initial = NULL, int initial_len = 0) { if (initial) Set(initial, initial_len); }
+
+	const char* Get () const                       { return m_s.c_str(); }
+	int GetLength () const                         { return (int)m_s.size(); }
+
+	void Set (const char* str, int maxlen = 0)     { m_s.clear(); Append(str, maxlen); }
+	void Set (const WDL_FastString* str)           { m_s = str->m_s; }
+	void Append (const char* str, int maxlen = 0)  { m_s.append(str, Len(str, maxlen)); }
+	void Insert (const char* str, int position, int maxlen = 0)
+	{
+		if (position < 0) position = 0;
+		if (position > GetLength()) position = GetLength();
+		m_s.insert(position, str, Len(str, maxlen));
+	}
+	void DeleteSub (int position, int len)
+	{
+		if (position >= 0 && position < GetLength())
+			m_s.erase(position, len);
+	}
+	void SetFormatted (int maxlen, const char* fmt, ...)
+	{
+		va_list va; va_start(va, fmt);
+		m_s.clear(); AppendV(maxlen, fmt, va);
+		va_end(va);
+	}
+	void AppendFormatted (int maxlen, const char* fmt, ...)
+	{
+		va_list va; va_start(va, fmt);
+		AppendV(maxlen, fmt, va);
+		va_end(va);
+	}
+
+private:
+	static int Len (const char* str, int maxlen)
+	{
+		int l = 0;
+		while (str[l] && (maxlen <= 0 || l < maxlen)) ++l;
+		return l;
+	}
+	void AppendV (int maxlen, const char* fmt, va_list va)
+	{
+		vector<char> buf(maxlen > 0 ? maxlen + 1 : 1);
+		vsnprintf(&buf[0], buf.size(), fmt, va);
+		m_s.append(&buf[0]);
+	}
+	string m_s;
+};
+
+template <class T> class WDL_TypedBuf
+{
+public:
+	T* Get ()                          { return m_v.empty() ? NULL : &m_v[0]; }
+	int GetSize () const               { return (int)m_v.size(); }
+	T* Resize (int newsize, bool resizedown = true) { m_v.resize(newsize); return Get(); }
+	T* Add (const T& val)              { m_v.push_back(val); return &m_v.back(); }
+
+private:
+	vector<T> m_v;
+};
+
+template <class PTRTYPE> class WDL_PtrList
+{
+public:
+	virtual ~WDL_PtrList () {}
+
+	PTRTYPE* Get (int index) const     { return (index >= 0 && index < GetSize()) ? m_v[index] : NULL; }
+	int GetSize () const               { return (int)m_v.size(); }
+	PTRTYPE* Add (PTRTYPE* item)       { m_v.push_back(item); return item; }
+	void Delete (int index, bool wantDelete = false)
+	{
+		if (index < 0 || index >= GetSize()) return;
+		if (wantDelete) delete m_v[index];
+		m_v.erase(m_v.begin() + index);
+	}
+
+protected:
+	vector<PTRTYPE*> m_v;
+};
+
+template <class PTRTYPE> class WDL_PtrList_DeleteOnDestroy : public WDL_PtrList<PTRTYPE>
+{
+public:
+	~WDL_PtrList_DeleteOnDestroy ()
+	{
+		for (int i = 0; i < this->GetSize(); ++i)
+			delete this->m_v[i];
+	}
+};
+
+class LineParser
+{
+public:
+	LineParser (bool bCommentBlock = false) {}
+
+	// returns 0 on success, -2 on unterminated quotes
+	int parse (const char* line)
+	{
+		m_tokens.clear();
+		const char* p = line;
+		for (;;)
+		{
+			while (*p == ' ' || *p == '\t') ++p;
+			if (!*p)
+				return 0;
+			if (*p == '"' || *p == '\'' || *p == '`')
+			{
+				const char* end = strchr(p + 1, *p);
+				if (!end)
+				{
+					m_tokens.clear();
+					return -2;
+				}
+				m_tokens.push_back(string(p + 1, end - p - 1));
+				p = end + 1;
+			}
+			else
+			{
+				const char* end = p;
+				while (*end && *end != ' ' && *end != '\t') ++end;
+				m_tokens.push_back(string(p, end - p));
+				p = end;
+			}
+		}
+	}
+
+	int getnumtokens () const          { return (int)m_tokens.size(); }
+	const char* gettoken_str (int token) const { return (token >= 0 && token < getnumtokens()) ? m_tokens[token].c_str() : ""; }
+	int gettoken_int (int token) const { return atoi(gettoken_str(token)); }
+	double gettoken_float (int token, int* success = NULL) const
+	{
+		const char* t = gettoken_str(token);
+		char* end = NULL;
+		double d = strtod(t, &end);
+		if (success) *success = (*t && end && !*end);
+		return d;
+	}
+
+private:
+	vector<string> m_tokens;
+};